@@ -311,6 +311,9 @@ typedef enum spv_text_to_binary_options_t {
   // Non-numeric IDs are allocated by filling in the gaps, starting with 1
   // and going up.
   SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS = SPV_BIT(1),
+  // Function bodies are encoded on multiple threads.  The binary is the same
+  // as without this option.
+  SPV_TEXT_TO_BINARY_OPTION_PARALLEL = SPV_BIT(2),
   SPV_FORCE_32_BIT_ENUM(spv_text_to_binary_options_t)
 } spv_text_to_binary_options_t;
 
@@ -328,9 +331,36 @@ typedef enum spv_binary_to_text_options_t {
   SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES = SPV_BIT(6),
   // Add some comments to the generated assembly
   SPV_BINARY_TO_TEXT_OPTION_COMMENT = SPV_BIT(7),
+  // Function bodies are disassembled on multiple threads.  The text is the
+  // same as without this option.
+  SPV_BINARY_TO_TEXT_OPTION_PARALLEL = SPV_BIT(8),
   SPV_FORCE_32_BIT_ENUM(spv_binary_to_text_options_t)
 } spv_binary_to_text_options_t;
 
+// The logical layout sections of a module, in the order in which they must
+// appear.  See Section 2.4 of the SPIR-V specification.
+typedef enum spv_binary_section_t {
+  SPV_BINARY_SECTION_CAPABILITIES = 0,
+  SPV_BINARY_SECTION_EXTENSIONS,
+  SPV_BINARY_SECTION_EXT_INST_IMPORTS,
+  SPV_BINARY_SECTION_MEMORY_MODEL,
+  SPV_BINARY_SECTION_ENTRY_POINTS,
+  SPV_BINARY_SECTION_EXECUTION_MODES,
+  // OpString, OpSourceExtension, OpSource and OpSourceContinued.
+  SPV_BINARY_SECTION_DEBUG_SOURCES,
+  // OpName and OpMemberName.
+  SPV_BINARY_SECTION_DEBUG_NAMES,
+  SPV_BINARY_SECTION_DEBUG_MODULE_PROCESSED,
+  SPV_BINARY_SECTION_ANNOTATIONS,
+  // Types, constants and global variables.
+  SPV_BINARY_SECTION_TYPES,
+  // Functions without a body.
+  SPV_BINARY_SECTION_FUNCTION_DECLARATIONS,
+  SPV_BINARY_SECTION_FUNCTION_DEFINITIONS,
+  SPV_BINARY_SECTION_COUNT,  // The number of sections.
+  SPV_FORCE_32_BIT_ENUM(spv_binary_section_t)
+} spv_binary_section_t;
+
 // Constants
 
 // The default id bound is to the minimum value for the id limit
@@ -403,18 +433,92 @@ typedef struct spv_diagnostic_t {
   bool isTextSource;
 } spv_diagnostic_t;
 
+// Where a logical layout section lies in a module.  Word offsets count from
+// the start of the module, including its header.  A section that is absent
+// from the module has no words.
+typedef struct spv_binary_section_index_t {
+  size_t word_offset;
+  size_t num_words;
+} spv_binary_section_index_t;
+
+// Where a function lies in a module, from its OpFunction through its
+// OpFunctionEnd.
+typedef struct spv_binary_function_index_t {
+  // The result id of the OpFunction.
+  uint32_t id;
+  size_t word_offset;
+  size_t num_words;
+  // The function's OpLabel instructions, as a range of the index's labels.
+  size_t first_label;
+  size_t num_labels;
+} spv_binary_function_index_t;
+
+// Where an OpLabel lies in a module.
+typedef struct spv_binary_label_index_t {
+  // The result id of the OpLabel.
+  uint32_t id;
+  size_t word_offset;
+} spv_binary_label_index_t;
+
+// An index of the sections, functions and basic blocks of a module, so that
+// they can be found without parsing the module again.  Functions and labels
+// are in module order.
+typedef struct spv_binary_index_t {
+  spv_binary_section_index_t sections[SPV_BINARY_SECTION_COUNT];
+  spv_binary_function_index_t* functions;
+  size_t num_functions;
+  spv_binary_label_index_t* labels;
+  size_t num_labels;
+} spv_binary_index_t;
+
+// An entry point declared by a module.
+typedef struct spv_entry_point_summary_t {
+  uint32_t execution_model;  // An SpvExecutionModel value.
+  uint32_t id;               // The id of the entry point's function.
+  const char* name;
+} spv_entry_point_summary_t;
+
+// What a module declares ahead of its debug instructions, annotations,
+// types and functions: enough to decide how to handle it without parsing
+// the rest of it.
+typedef struct spv_module_summary_t {
+  // From the module header.
+  uint32_t version;
+  uint32_t generator;
+  uint32_t id_bound;
+  // SpvCapability values, in module order.
+  uint32_t* capabilities;
+  size_t num_capabilities;
+  // Extension names, in module order.
+  char** extensions;
+  size_t num_extensions;
+  // The operands of OpMemoryModel, if has_memory_model is true.
+  bool has_memory_model;
+  uint32_t addressing_model;  // An SpvAddressingModel value.
+  uint32_t memory_model;      // An SpvMemoryModel value.
+  // The module's entry points, in module order.
+  spv_entry_point_summary_t* entry_points;
+  size_t num_entry_points;
+} spv_module_summary_t;
+
 // Opaque struct containing the context used to operate on a SPIR-V module.
 // Its object is used by various translation API functions.
 typedef struct spv_context_t spv_context_t;
 
 typedef struct spv_validator_options_t spv_validator_options_t;
 
+// Opaque struct holding the outcomes of earlier validations.
+typedef struct spv_validator_cache_t spv_validator_cache_t;
+
 typedef struct spv_optimizer_options_t spv_optimizer_options_t;
 
 typedef struct spv_reducer_options_t spv_reducer_options_t;
 
 typedef struct spv_fuzzer_options_t spv_fuzzer_options_t;
 
+// Opaque struct for a binary parser that is fed a module in pieces.
+typedef struct spv_binary_parser_t spv_binary_parser_t;
+
 // Type Definitions
 
 typedef spv_const_binary_t* spv_const_binary;
@@ -426,12 +530,16 @@ typedef const spv_context_t* spv_const_context;
 typedef spv_context_t* spv_context;
 typedef spv_validator_options_t* spv_validator_options;
 typedef const spv_validator_options_t* spv_const_validator_options;
+typedef spv_validator_cache_t* spv_validator_cache;
 typedef spv_optimizer_options_t* spv_optimizer_options;
 typedef const spv_optimizer_options_t* spv_const_optimizer_options;
 typedef spv_reducer_options_t* spv_reducer_options;
 typedef const spv_reducer_options_t* spv_const_reducer_options;
 typedef spv_fuzzer_options_t* spv_fuzzer_options;
 typedef const spv_fuzzer_options_t* spv_const_fuzzer_options;
+typedef spv_binary_parser_t* spv_binary_parser;
+typedef spv_binary_index_t* spv_binary_index;
+typedef spv_module_summary_t* spv_module_summary;
 
 // Platform API
 
@@ -625,6 +733,49 @@ SPIRV_TOOLS_EXPORT void spvValidatorOptionsSetScalarBlockLayout(
 SPIRV_TOOLS_EXPORT void spvValidatorOptionsSetSkipBlockLayout(
     spv_validator_options options, bool val);
 
+// Records the number of threads that the validator may use to check the
+// functions of a module.  Zero means one thread per hardware thread.  The
+// default is one.  The outcome, including which issue is reported, is the
+// same for any number of threads.
+SPIRV_TOOLS_EXPORT void spvValidatorOptionsSetNumThreads(
+    spv_validator_options options, uint32_t num_threads);
+
+// Records whether or not the validator should keep its representation of the
+// module smaller, for very large modules, at some cost in speed.  The words of
+// the module are then referred to rather than copied, so they must outlive
+// the validation.  A successful validation then also sends an info message to
+// the context's message consumer, with a partial estimate of the memory of
+// its representation of the module.  The estimate leaves out some of the
+// validator's bookkeeping, so it is less than the memory actually used.  The
+// message is never written into a diagnostic.  The default is false.
+SPIRV_TOOLS_EXPORT void spvValidatorOptionsSetLowMemory(
+    spv_validator_options options, bool val);
+
+// Creates a cache of validation outcomes.  A validation that uses the cache
+// first looks for an outcome recorded for the same binary, target environment
+// and options.  If one is found, its messages are sent to the message consumer
+// again, or its issue is written into the diagnostic, and its result is
+// returned without validating.  Otherwise the outcome of validating is
+// recorded.  Outcomes are found by a 64-bit hash, so there is a very small
+// chance that two different inputs share one.
+//
+// Up to |capacity| of the most recently used outcomes are kept in memory.  If
+// |directory| is not null, it names an existing directory in which every
+// outcome is also kept as a file, so that it is found by caches in other
+// processes, or on other machines sharing the directory, too.  The cache may be
+// used by several validations at once.  It remains valid until it is passed
+// into spvValidatorCacheDestroy.
+SPIRV_TOOLS_EXPORT spv_validator_cache
+spvValidatorCacheCreate(size_t capacity, const char* directory);
+
+// Destroys the given validation cache.
+SPIRV_TOOLS_EXPORT void spvValidatorCacheDestroy(spv_validator_cache cache);
+
+// Records the cache that validations with the given options use, or null for
+// none, which is the default.  The cache must outlive its use by the options.
+SPIRV_TOOLS_EXPORT void spvValidatorOptionsSetCache(
+    spv_validator_options options, spv_validator_cache cache);
+
 // Creates an optimizer options object with default options. Returns a valid
 // options object. The object remains valid until it is passed into
 // |spvOptimizerOptionsDestroy|.
@@ -797,6 +948,25 @@ SPIRV_TOOLS_EXPORT spv_result_t
 spvValidateBinary(const spv_const_context context, const uint32_t* words,
                   const size_t num_words, spv_diagnostic* diagnostic);
 
+// Validates num_binaries SPIR-V binaries for correctness, as
+// spvValidateWithOptions does, spreading the modules over up to num_threads
+// worker threads.  If num_threads is 0, one thread per hardware thread is
+// used.  If options is null, default validator options are used.
+//
+// The result code for binaries[i] is written to results[i].  If diagnostics
+// is non-null, the issue found in binaries[i], if any, is written into
+// diagnostics[i].  Otherwise the context's message consumer is used; it may
+// then be invoked from any worker thread, though never by two threads at the
+// same time.
+//
+// Returns SPV_SUCCESS if all binaries are valid, otherwise the result code of
+// the first invalid binary.  It is safe to call this concurrently with other
+// calls using the same context and options, since they are only read.
+SPIRV_TOOLS_EXPORT spv_result_t spvValidateBinaries(
+    const spv_const_context context, const spv_const_validator_options options,
+    const spv_const_binary_t* binaries, size_t num_binaries,
+    size_t num_threads, spv_result_t* results, spv_diagnostic* diagnostics);
+
 // Creates a diagnostic object. The position parameter specifies the location in
 // the text/binary stream. The message parameter, copied into the diagnostic
 // object, contains the error message to display.
@@ -851,6 +1021,70 @@ SPIRV_TOOLS_EXPORT spv_result_t spvBinaryParse(
     const size_t num_words, spv_parsed_header_fn_t parse_header,
     spv_parsed_instruction_fn_t parse_instruction, spv_diagnostic* diagnostic);
 
+// Creates a binary parser that accepts a SPIR-V module in pieces of any size,
+// for example as they are read from a pipe or decompressed.  Callbacks are
+// issued as described for spvBinaryParse, as soon as the words of each
+// instruction have all been received.  Only the words of an incomplete
+// instruction are kept between pieces.  Returns a null pointer if context is
+// null.  The context must outlive the parser.
+SPIRV_TOOLS_EXPORT spv_binary_parser spvBinaryParserCreate(
+    const spv_const_context context, void* user_data,
+    spv_parsed_header_fn_t parse_header,
+    spv_parsed_instruction_fn_t parse_instruction);
+
+// Destroys the given binary parser.
+SPIRV_TOOLS_EXPORT void spvBinaryParserDestroy(spv_binary_parser parser);
+
+// Appends num_bytes bytes of the module to the parser, and parses every
+// instruction they complete.  Returns SPV_SUCCESS if the module parsed so far
+// is valid and the callbacks returned SPV_SUCCESS.  Otherwise returns a status
+// code as spvBinaryParse does, and if diagnostic is non-null also emits a
+// diagnostic.  After a failure, later pieces of the same module are ignored
+// and the same status code and diagnostic are returned again.
+SPIRV_TOOLS_EXPORT spv_result_t spvBinaryParserFeed(spv_binary_parser parser,
+                                                    const void* data,
+                                                    size_t num_bytes,
+                                                    spv_diagnostic* diagnostic);
+
+// Signals the end of the module fed to the parser, and parses any words that
+// remain.  Returns the final status of the parse, as spvBinaryParse would,
+// emitting a diagnostic on failure.  Afterward, the parser is ready to accept
+// a new module.
+SPIRV_TOOLS_EXPORT spv_result_t spvBinaryParserFinish(
+    spv_binary_parser parser, spv_diagnostic* diagnostic);
+
+// Parses a SPIR-V binary as spvBinaryParse does, and also builds an index of
+// where its logical layout sections, functions and OpLabel instructions lie.
+// Instructions that may appear in several sections, such as OpLine, belong
+// to the section of the instruction before them.  On success, *index is set
+// to the new index, which must be released with spvBinaryIndexDestroy.
+// Otherwise *index is set to a null pointer.
+SPIRV_TOOLS_EXPORT spv_result_t spvBinaryParseWithIndex(
+    const spv_const_context context, void* user_data, const uint32_t* words,
+    const size_t num_words, spv_parsed_header_fn_t parse_header,
+    spv_parsed_instruction_fn_t parse_instruction, spv_binary_index* index,
+    spv_diagnostic* diagnostic);
+
+// Destroys the given binary index.
+SPIRV_TOOLS_EXPORT void spvBinaryIndexDestroy(spv_binary_index index);
+
+// Summarizes the header, capabilities, extensions, memory model and entry
+// points of a SPIR-V binary.  Only the header and the instructions before
+// the first instruction of any other kind, such as OpExecutionMode or a type
+// declaration, are parsed; the rest of the module is not read.  On success,
+// *summary is set to the new summary, which must be released with
+// spvModuleSummaryDestroy.  Otherwise returns a status code as
+// spvBinaryParse does, sets *summary to a null pointer, and if diagnostic is
+// non-null also emits a diagnostic.
+SPIRV_TOOLS_EXPORT spv_result_t spvBinaryProbe(const spv_const_context context,
+                                               const uint32_t* words,
+                                               const size_t num_words,
+                                               spv_module_summary* summary,
+                                               spv_diagnostic* diagnostic);
+
+// Destroys the given module summary.
+SPIRV_TOOLS_EXPORT void spvModuleSummaryDestroy(spv_module_summary summary);
+
 #ifdef __cplusplus
 }
 #endif
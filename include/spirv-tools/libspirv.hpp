@@ -67,6 +67,22 @@ class Context {
   spv_context context_;
 };
 
+// A RAII wrapper around a cache of validation outcomes.  See
+// spvValidatorCacheCreate.
+class ValidatorCache {
+ public:
+  explicit ValidatorCache(size_t capacity, const char* directory = nullptr)
+      : cache_(spvValidatorCacheCreate(capacity, directory)) {}
+  ~ValidatorCache() { spvValidatorCacheDestroy(cache_); }
+  ValidatorCache(const ValidatorCache&) = delete;
+  ValidatorCache& operator=(const ValidatorCache&) = delete;
+  // Allow implicit conversion to the underlying object.
+  operator spv_validator_cache() const { return cache_; }
+
+ private:
+  spv_validator_cache cache_;
+};
+
 // A RAII wrapper around a validator options object.
 class ValidatorOptions {
  public:
@@ -109,6 +125,27 @@ class ValidatorOptions {
     spvValidatorOptionsSetSkipBlockLayout(options_, val);
   }
 
+  // Sets the number of threads the validator may use to check the functions
+  // of a module.  Zero means one thread per hardware thread.  The outcome is
+  // the same for any number of threads.
+  void SetNumThreads(uint32_t num_threads) {
+    spvValidatorOptionsSetNumThreads(options_, num_threads);
+  }
+
+  // Records whether or not the validator should keep its representation of
+  // the module smaller, at some cost in speed.  A successful validation then
+  // sends a partial estimate of the memory of that representation to the
+  // message consumer, as an info message.
+  void SetLowMemory(bool val) {
+    spvValidatorOptionsSetLowMemory(options_, val);
+  }
+
+  // Sets the cache of earlier validation outcomes to reuse, or null for none.
+  // The cache must outlive its use by these options.
+  void SetCache(spv_validator_cache cache) {
+    spvValidatorOptionsSetCache(options_, cache);
+  }
+
   // Records whether or not the validator should relax the rules on pointer
   // usage in logical addressing mode.
   //
@@ -254,6 +291,14 @@ class FuzzerOptions {
   spv_fuzzer_options options_;
 };
 
+// The index of the sections, functions and basic blocks of a module.  See
+// spv_binary_index_t for the meaning of each member.
+struct BinaryIndex {
+  spv_binary_section_index_t sections[SPV_BINARY_SECTION_COUNT];
+  std::vector<spv_binary_function_index_t> functions;
+  std::vector<spv_binary_label_index_t> labels;
+};
+
 // C++ interface for SPIRV-Tools functionalities. It wraps the context
 // (including target environment and the corresponding SPIR-V grammar) and
 // provides methods for assembling, disassembling, and validating.
@@ -317,6 +362,15 @@ class SpirvTools {
                    std::string* text,
                    uint32_t options = kDefaultDisassembleOption) const;
 
+  // Parses the given SPIR-V |binary| and writes the index of where its
+  // sections, functions and basic blocks lie to |index|.  Returns true on
+  // successful parsing.  |index| will be kept untouched if parsing is
+  // unsuccessful.
+  bool Index(const std::vector<uint32_t>& binary, BinaryIndex* index) const;
+  // |binary_size| specifies the number of words in |binary|.
+  bool Index(const uint32_t* binary, size_t binary_size,
+             BinaryIndex* index) const;
+
   // Validates the given SPIR-V |binary|. Returns true if no issues are found.
   // Otherwise, returns false and communicates issues via the message consumer
   // registered.
@@ -342,6 +396,17 @@ class SpirvTools {
   // binary itself, or in the validator options.
   bool Validate(const uint32_t* binary, size_t binary_size,
                 spv_validator_options options) const;
+  // Validates each of the given |binaries| as the previous overload does,
+  // spreading the work over up to |num_threads| threads.  Zero means one
+  // thread per hardware thread.  Returns true if all binaries are valid.
+  // Issues are communicated via the registered message consumer, from the
+  // calling thread and in the order of |binaries|.  If |messages| is
+  // non-null, it is resized to the number of binaries, and its i-th element
+  // is set to the issue found in the i-th binary, or is empty if that binary
+  // is valid.
+  bool Validate(const std::vector<std::vector<uint32_t>>& binaries,
+                spv_validator_options options, size_t num_threads,
+                std::vector<std::string>* messages = nullptr) const;
 
   // Was this object successfully constructed.
   bool IsValid() const;
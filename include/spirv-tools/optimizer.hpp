@@ -226,7 +226,9 @@ class Optimizer {
   // |out| output stream.
   Optimizer& SetTimeReport(std::ostream* out);
 
-  // Sets the option to validate the module after each pass.
+  // Sets the option to validate the module after each pass.  The module is
+  // not validated again after a pass that leaves it byte-identical to the
+  // last module that was validated.
   Optimizer& SetValidateAfterAll(bool validate);
 
  private:
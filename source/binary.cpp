@@ -19,7 +19,6 @@
 #include <algorithm>
 #include <cassert>
 #include <cstring>
-#include <iterator>
 #include <limits>
 #include <string>
 #include <unordered_map>
@@ -64,6 +63,142 @@ spv_result_t spvBinaryHeaderGet(const spv_const_binary binary,
 
 namespace {
 
+// Builds a spv_binary_index_t from the instructions of a module, in order.
+class IndexBuilder {
+ public:
+  IndexBuilder() : sections_(), current_section_(), in_function_(false) {}
+
+  // Records the given instruction, which starts word_offset words into the
+  // module.
+  void addInstruction(const spv_parsed_instruction_t& inst,
+                      size_t word_offset);
+
+  // Returns a new index for a module of num_words words, all of whose
+  // instructions have been recorded.
+  spv_binary_index release(size_t num_words);
+
+ private:
+  // Returns the section that the given opcode belongs to, when it appears
+  // outside a function.
+  spv_binary_section_t sectionOf(SpvOp opcode) const;
+
+  // Extends the given section to cover the given words.
+  void extend(spv_binary_section_t section, size_t word_offset,
+              size_t num_words);
+
+  // Closes the current function, which ends at the given word offset.
+  void endFunction(size_t end_offset);
+
+  spv_binary_section_index_t sections_[SPV_BINARY_SECTION_COUNT];
+  spv_binary_section_t current_section_;
+  bool in_function_;  // Is the last function still open?
+  std::vector<spv_binary_function_index_t> functions_;
+  std::vector<spv_binary_label_index_t> labels_;
+};
+
+void IndexBuilder::addInstruction(const spv_parsed_instruction_t& inst,
+                                  size_t word_offset) {
+  const SpvOp opcode = static_cast<SpvOp>(inst.opcode);
+  if (in_function_) {
+    if (opcode == SpvOpLabel) {
+      labels_.push_back({inst.result_id, word_offset});
+      functions_.back().num_labels++;
+    } else if (opcode == SpvOpFunctionEnd) {
+      endFunction(word_offset + inst.num_words);
+    }
+    return;
+  }
+  if (opcode == SpvOpFunction) {
+    functions_.push_back({inst.result_id, word_offset, 0, labels_.size(), 0});
+    in_function_ = true;
+    return;
+  }
+  current_section_ = sectionOf(opcode);
+  extend(current_section_, word_offset, inst.num_words);
+}
+
+spv_binary_section_t IndexBuilder::sectionOf(SpvOp opcode) const {
+  // See Section 2.4
+  if (spvOpcodeGeneratesType(opcode) || spvOpcodeIsConstant(opcode))
+    return SPV_BINARY_SECTION_TYPES;
+
+  switch (opcode) {
+    case SpvOpCapability:
+      return SPV_BINARY_SECTION_CAPABILITIES;
+    case SpvOpExtension:
+      return SPV_BINARY_SECTION_EXTENSIONS;
+    case SpvOpExtInstImport:
+      return SPV_BINARY_SECTION_EXT_INST_IMPORTS;
+    case SpvOpMemoryModel:
+      return SPV_BINARY_SECTION_MEMORY_MODEL;
+    case SpvOpEntryPoint:
+      return SPV_BINARY_SECTION_ENTRY_POINTS;
+    case SpvOpExecutionMode:
+    case SpvOpExecutionModeId:
+      return SPV_BINARY_SECTION_EXECUTION_MODES;
+    case SpvOpSourceContinued:
+    case SpvOpSource:
+    case SpvOpSourceExtension:
+    case SpvOpString:
+      return SPV_BINARY_SECTION_DEBUG_SOURCES;
+    case SpvOpName:
+    case SpvOpMemberName:
+      return SPV_BINARY_SECTION_DEBUG_NAMES;
+    case SpvOpModuleProcessed:
+      return SPV_BINARY_SECTION_DEBUG_MODULE_PROCESSED;
+    case SpvOpDecorate:
+    case SpvOpMemberDecorate:
+    case SpvOpGroupDecorate:
+    case SpvOpGroupMemberDecorate:
+    case SpvOpDecorationGroup:
+    case SpvOpDecorateId:
+    case SpvOpDecorateStringGOOGLE:
+    case SpvOpMemberDecorateStringGOOGLE:
+      return SPV_BINARY_SECTION_ANNOTATIONS;
+    case SpvOpTypeForwardPointer:
+    case SpvOpVariable:
+    case SpvOpUndef:
+      return SPV_BINARY_SECTION_TYPES;
+    default:
+      break;
+  }
+  // Instructions such as OpLine and OpExtInst may appear in several
+  // sections.  They stay in the current one.
+  return current_section_;
+}
+
+void IndexBuilder::extend(spv_binary_section_t section, size_t word_offset,
+                          size_t num_words) {
+  spv_binary_section_index_t& index = sections_[section];
+  if (index.num_words == 0) index.word_offset = word_offset;
+  index.num_words = word_offset + num_words - index.word_offset;
+}
+
+void IndexBuilder::endFunction(size_t end_offset) {
+  spv_binary_function_index_t& function = functions_.back();
+  function.num_words = end_offset - function.word_offset;
+  current_section_ = function.num_labels
+                         ? SPV_BINARY_SECTION_FUNCTION_DEFINITIONS
+                         : SPV_BINARY_SECTION_FUNCTION_DECLARATIONS;
+  extend(current_section_, function.word_offset, function.num_words);
+  in_function_ = false;
+}
+
+spv_binary_index IndexBuilder::release(size_t num_words) {
+  // A function missing its OpFunctionEnd runs to the end of the module.
+  if (in_function_) endFunction(num_words);
+
+  spv_binary_index index = new spv_binary_index_t();
+  std::copy(sections_, sections_ + SPV_BINARY_SECTION_COUNT, index->sections);
+  index->num_functions = functions_.size();
+  index->functions = new spv_binary_function_index_t[functions_.size()];
+  std::copy(functions_.begin(), functions_.end(), index->functions);
+  index->num_labels = labels_.size();
+  index->labels = new spv_binary_label_index_t[labels_.size()];
+  std::copy(labels_.begin(), labels_.end(), index->labels);
+  return index;
+}
+
 // A SPIR-V binary parser.  A parser instance communicates detailed parse
 // results via callbacks.
 class Parser {
@@ -76,7 +211,14 @@ class Parser {
         consumer_(context->consumer),
         user_data_(user_data),
         parsed_header_fn_(parsed_header_fn),
-        parsed_instruction_fn_(parsed_instruction_fn) {}
+        parsed_instruction_fn_(parsed_instruction_fn),
+        index_builder_(nullptr) {}
+
+  // Records every instruction parsed from now on in the given index builder,
+  // or in none if it is null.
+  void setIndexBuilder(IndexBuilder* index_builder) {
+    index_builder_ = index_builder;
+  }
 
   // Parses the specified binary SPIR-V module, issuing callbacks on a parsed
   // header and for each parsed instruction.  Returns SPV_SUCCESS on success.
@@ -84,12 +226,45 @@ class Parser {
   spv_result_t parse(const uint32_t* words, size_t num_words,
                      spv_diagnostic* diagnostic);
 
+  // The following methods parse a module that is provided in pieces.  Call
+  // beginModule, then parseHeaderWords once, then parseInstructionWords any
+  // number of times.  Each piece need only remain valid for the duration of
+  // the call it is passed to.
+
+  // Starts parsing a new module, releasing the state of any previous one.
+  void beginModule(spv_diagnostic* diagnostic) {
+    _ = State(nullptr, 0, diagnostic);
+  }
+
+  // Parses the module header from the start of the given words, issuing the
+  // parsed-header callback.  Fewer than SPV_INDEX_INSTRUCTION words are only
+  // expected when there is no more input, and produce an error.
+  spv_result_t parseHeaderWords(const uint32_t* words, size_t num_words);
+
+  // Parses the instructions in the given words, which start word_offset words
+  // into the module, issuing the parsed-instruction callbacks.  The words
+  // must end at an instruction boundary, unless they are the end of the
+  // input.
+  spv_result_t parseInstructionWords(const uint32_t* words, size_t num_words,
+                                     size_t word_offset);
+
+  // Returns the endianness of the current module.  Only valid once its header
+  // has been parsed.
+  spv_endianness_t endian() const { return _.endian; }
+
  private:
   // All remaining methods work on the current module parse state.
 
   // Like the parse method, but works on the current module parse state.
   spv_result_t parseModule();
 
+  // Parses the header at the start of the current words.
+  spv_result_t parseHeader();
+
+  // Parses instructions from the current position to the end of the current
+  // words.
+  spv_result_t parseInstructions();
+
   // Parses an instruction at the current position of the binary.  Assumes
   // the header has been parsed, the endian has been set, and the word index is
   // still in range.  Advances the parsing position past the instruction, and
@@ -99,18 +274,14 @@ class Parser {
   spv_result_t parseInstruction();
 
   // Parses an instruction operand with the given type, for an instruction
-  // starting at inst_offset words into the SPIR-V binary.
-  // If the SPIR-V binary is the same endianness as the host, then the
-  // endian_converted_inst_words parameter is ignored.  Otherwise, this method
-  // appends the words for this operand, converted to host native endianness,
-  // to the end of endian_converted_inst_words.  This method also updates the
-  // expected_operands parameter, and the scalar members of the inst parameter.
+  // starting at inst_offset words into the SPIR-V binary.  This method also
+  // updates the expected_operands parameter, and the scalar members of the
+  // inst parameter.
   // On success, returns SPV_SUCCESS, advances past the operand, and pushes a
   // new entry on to the operands vector.  Otherwise returns an error code and
   // issues a diagnostic.
   spv_result_t parseOperand(size_t inst_offset, spv_parsed_instruction_t* inst,
                             const spv_operand_type_t type,
-                            std::vector<uint32_t>* endian_converted_inst_words,
                             std::vector<spv_parsed_operand_t>* operands,
                             spv_operand_pattern_t* expected_operands);
 
@@ -128,6 +299,16 @@ class Parser {
   void recordNumberType(size_t inst_offset,
                         const spv_parsed_instruction_t* inst);
 
+  struct IdInfo;
+
+  // Returns the information recorded for the given id, adding an empty entry
+  // for it if there is none.
+  IdInfo& idInfo(uint32_t id);
+
+  // Returns the information recorded for the given id, or nullptr if the id
+  // has not been defined.
+  const IdInfo* findIdInfo(uint32_t id) const;
+
   // Returns a diagnostic stream object initialized with current position in
   // the input stream, and for the given error code. Any data written to the
   // returned object will be propagated to the current parse's diagnostic
@@ -150,20 +331,21 @@ class Parser {
                                         spv_operand_type_t type) {
     return diagnostic() << "End of input reached while decoding Op"
                         << spvOpcodeString(opcode) << " starting at word "
-                        << inst_offset
+                        << _.word_offset + inst_offset
                         << ((_.word_index < _.num_words) ? ": truncated "
                                                          : ": missing ")
                         << spvOperandTypeStr(type) << " operand at word offset "
                         << _.word_index - inst_offset << ".";
   }
 
-  // Returns the endian-corrected word at the current position.
+  // Returns the word at the current position.
   uint32_t peek() const { return peekAt(_.word_index); }
 
-  // Returns the endian-corrected word at the given position.
+  // Returns the word at the given position.  The words being parsed are
+  // always in host native endianness; see parseModule.
   uint32_t peekAt(size_t index) const {
     assert(index < _.num_words);
-    return spvFixWord(_.words[index], _.endian);
+    return _.words[index];
   }
 
   // Data members
@@ -174,6 +356,7 @@ class Parser {
   const spv_parsed_header_fn_t parsed_header_fn_;  // Parsed header callback
   const spv_parsed_instruction_fn_t
       parsed_instruction_fn_;  // Parsed instruction callback
+  IndexBuilder* index_builder_;  // Where to record instructions, if anywhere
 
   // Describes the format of a typed literal number.
   struct NumberType {
@@ -181,27 +364,50 @@ class Parser {
     uint32_t bit_width;
   };
 
+  // What is known about an id.  All zero for an id not defined yet.
+  struct IdInfo {
+    // The id's type id.  By convention:
+    //  - a result ID that is a type definition maps to itself.
+    //  - a result ID without a type maps to 0.  (E.g. for OpLabel)
+    uint32_t type_id;
+    // For a type id, its number type description.
+    NumberType number_type;
+    // For an ExtInstImport id, the extended instruction type.
+    spv_ext_inst_type_t ext_inst_type;
+    bool defined;
+    // Is this a type id?
+    bool is_type;
+  };
+
   // The state used to parse a single SPIR-V binary module.
   struct State {
     State(const uint32_t* words_arg, size_t num_words_arg,
           spv_diagnostic* diagnostic_arg)
         : words(words_arg),
+          original_words(words_arg),
           num_words(num_words_arg),
           diagnostic(diagnostic_arg),
+          word_offset(0),
           word_index(0),
           instruction_count(0),
           endian(),
-          requires_endian_conversion(false) {
+          requires_endian_conversion(false),
+          id_bound(0) {
       // Temporary storage for parser state within a single instruction.
       // Most instructions require fewer than 25 words or operands.
       operands.reserve(25);
-      endian_converted_words.reserve(25);
       expected_operands.reserve(25);
     }
     State() : State(0, 0, nullptr) {}
-    const uint32_t* words;       // Words in the binary SPIR-V module.
+    // Words in the binary SPIR-V module, in host native endianness.
+    const uint32_t* words;
+    // Words in the binary SPIR-V module, as provided by the caller.
+    const uint32_t* original_words;
     size_t num_words;            // Number of words in the module.
     spv_diagnostic* diagnostic;  // Where diagnostics go.
+    // The number of module words preceding words[0].  Non-zero only when the
+    // module is parsed in pieces.
+    size_t word_offset;
     size_t word_index;           // The current position in words.
     size_t instruction_count;    // The count of processed instructions
     spv_endianness_t endian;     // The endianness of the binary.
@@ -209,19 +415,21 @@ class Parser {
     // endianness?
     bool requires_endian_conversion;
 
-    // Maps a result ID to its type ID.  By convention:
-    //  - a result ID that is a type definition maps to itself.
-    //  - a result ID without a type maps to 0.  (E.g. for OpLabel)
-    std::unordered_map<uint32_t, uint32_t> id_to_type_id;
-    // Maps a type ID to its number type description.
-    std::unordered_map<uint32_t, NumberType> type_id_to_number_type_info;
-    // Maps an ExtInstImport id to the extended instruction type.
-    std::unordered_map<uint32_t, spv_ext_inst_type_t>
-        import_id_to_ext_inst_type;
+    // The id bound from the module's header.
+    uint32_t id_bound;
+    // What is known about each id, indexed by id.  It only covers ids below
+    // both the id bound and the number of words seen so far, so that a bogus
+    // id bound can't make it huge.  Any other ids are in overflow_ids.
+    std::vector<IdInfo> ids;
+    std::unordered_map<uint32_t, IdInfo> overflow_ids;
+
+    // If the module is not in host native endianness, then this holds a copy
+    // of the whole module converted to host native endianness, and words
+    // points into it.  Otherwise it is empty.
+    std::vector<uint32_t> endian_converted_words;
 
     // Used by parseOperand
     std::vector<spv_parsed_operand_t> operands;
-    std::vector<uint32_t> endian_converted_words;
     spv_operand_pattern_t expected_operands;
   } _;
 };
@@ -238,7 +446,31 @@ spv_result_t Parser::parse(const uint32_t* words, size_t num_words,
   return result;
 }
 
+spv_result_t Parser::parseHeaderWords(const uint32_t* words,
+                                      size_t num_words) {
+  _.words = _.original_words = words;
+  _.num_words = num_words;
+  return parseHeader();
+}
+
+spv_result_t Parser::parseInstructionWords(const uint32_t* words,
+                                           size_t num_words,
+                                           size_t word_offset) {
+  _.words = _.original_words = words;
+  _.num_words = num_words;
+  _.word_offset = word_offset;
+  _.word_index = 0;
+  return parseInstructions();
+}
+
 spv_result_t Parser::parseModule() {
+  if (auto error = parseHeader()) return error;
+
+  _.word_index = SPV_INDEX_INSTRUCTION;
+  return parseInstructions();
+}
+
+spv_result_t Parser::parseHeader() {
   if (!_.words) return diagnostic() << "Missing module.";
 
   if (_.num_words < SPV_INDEX_INSTRUCTION)
@@ -261,6 +493,11 @@ spv_result_t Parser::parseModule() {
     return diagnostic(SPV_ERROR_INTERNAL)
            << "Internal error: unhandled header parse failure";
   }
+  // Ids are usually numbered densely from 1, so make room for them all at
+  // once, if the module looks big enough to hold them.
+  _.id_bound = header.bound;
+  _.ids.resize(std::min<size_t>(_.id_bound, _.num_words));
+
   if (parsed_header_fn_) {
     if (auto error = parsed_header_fn_(user_data_, _.endian, header.magic,
                                        header.version, header.generator,
@@ -269,8 +506,20 @@ spv_result_t Parser::parseModule() {
     }
   }
 
+  return SPV_SUCCESS;
+}
+
+spv_result_t Parser::parseInstructions() {
+  // Convert a foreign-endian module to host endianness in one bulk pass, so
+  // that reading a word while parsing never needs to check or swap.
+  if (_.requires_endian_conversion) {
+    _.endian_converted_words.resize(_.num_words);
+    spvFixWords(_.original_words, _.num_words, _.endian,
+                _.endian_converted_words.data());
+    _.words = _.endian_converted_words.data();
+  }
+
   // Process the instructions.
-  _.word_index = SPV_INDEX_INSTRUCTION;
   while (_.word_index < _.num_words)
     if (auto error = parseInstruction()) return error;
 
@@ -289,14 +538,9 @@ spv_result_t Parser::parseInstruction() {
 
   const uint32_t first_word = peek();
 
-  // If the module's endianness is different from the host native endianness,
-  // then converted_words contains the the endian-translated words in the
-  // instruction.
-  _.endian_converted_words.clear();
-  _.endian_converted_words.push_back(first_word);
-
   // After a successful parse of the instruction, the inst.operands member
-  // will point to this vector's storage.
+  // will point to this vector's storage.  Its capacity is retained across
+  // instructions, so steady-state parsing does not allocate.
   _.operands.clear();
 
   assert(_.word_index < _.num_words);
@@ -332,7 +576,8 @@ spv_result_t Parser::parseInstruction() {
     const uint16_t inst_word_index = uint16_t(_.word_index - inst_offset);
     if (_.expected_operands.empty()) {
       return diagnostic() << "Invalid instruction Op" << opcode_desc->name
-                          << " starting at word " << inst_offset
+                          << " starting at word "
+                          << _.word_offset + inst_offset
                           << ": expected no more operands after "
                           << inst_word_index
                           << " words, but stated word count is "
@@ -342,9 +587,8 @@ spv_result_t Parser::parseInstruction() {
     spv_operand_type_t type =
         spvTakeFirstMatchableOperand(&_.expected_operands);
 
-    if (auto error =
-            parseOperand(inst_offset, &inst, type, &_.endian_converted_words,
-                         &_.operands, &_.expected_operands)) {
+    if (auto error = parseOperand(inst_offset, &inst, type, &_.operands,
+                                  &_.expected_operands)) {
       return error;
     }
   }
@@ -353,39 +597,24 @@ spv_result_t Parser::parseInstruction() {
       !spvOperandIsOptional(_.expected_operands.back())) {
     return diagnostic() << "End of input reached while decoding Op"
                         << opcode_desc->name << " starting at word "
-                        << inst_offset << ": expected more operands after "
+                        << _.word_offset + inst_offset
+                        << ": expected more operands after "
                         << inst_word_count << " words.";
   }
 
   if ((inst_offset + inst_word_count) != _.word_index) {
     return diagnostic() << "Invalid word count: Op" << opcode_desc->name
-                        << " starting at word " << inst_offset
+                        << " starting at word " << _.word_offset + inst_offset
                         << " says it has " << inst_word_count
                         << " words, but found " << _.word_index - inst_offset
                         << " words instead.";
   }
 
-  // Check the computed length of the endian-converted words vector against
-  // the declared number of words in the instruction.  If endian conversion
-  // is required, then they should match.  If no endian conversion was
-  // performed, then the vector only contains the initial opcode/word-count
-  // word.
-  assert(!_.requires_endian_conversion ||
-         (inst_word_count == _.endian_converted_words.size()));
-  assert(_.requires_endian_conversion ||
-         (_.endian_converted_words.size() == 1));
-
   recordNumberType(inst_offset, &inst);
 
-  if (_.requires_endian_conversion) {
-    // We must wait until here to set this pointer, because the vector might
-    // have been be resized while we accumulated its elements.
-    inst.words = _.endian_converted_words.data();
-  } else {
-    // If no conversion is required, then just point to the underlying binary.
-    // This saves time and space.
-    inst.words = _.words + inst_offset;
-  }
+  // Point to the underlying binary, or to its host-endian copy.  Either way
+  // no per-instruction copy is made.
+  inst.words = _.words + inst_offset;
   inst.num_words = inst_word_count;
 
   // We must wait until here to set this pointer, because the vector might
@@ -393,6 +622,9 @@ spv_result_t Parser::parseInstruction() {
   inst.operands = _.operands.data();
   inst.num_operands = uint16_t(_.operands.size());
 
+  if (index_builder_)
+    index_builder_->addInstruction(inst, _.word_offset + inst_offset);
+
   // Issue the callback.  The callee should know that all the storage in inst
   // is transient, and will disappear immediately afterward.
   if (parsed_instruction_fn_) {
@@ -405,7 +637,6 @@ spv_result_t Parser::parseInstruction() {
 spv_result_t Parser::parseOperand(size_t inst_offset,
                                   spv_parsed_instruction_t* inst,
                                   const spv_operand_type_t type,
-                                  std::vector<uint32_t>* words,
                                   std::vector<spv_parsed_operand_t>* operands,
                                   spv_operand_pattern_t* expected_operands) {
   const SpvOp opcode = static_cast<SpvOp>(inst->opcode);
@@ -430,10 +661,6 @@ spv_result_t Parser::parseOperand(size_t inst_offset,
 
   const uint32_t word = peek();
 
-  // Do the words in this operand have to be converted to native endianness?
-  // True for all but literal strings.
-  bool convert_operand_endianness = true;
-
   switch (type) {
     case SPV_OPERAND_TYPE_TYPE_ID:
       if (!word)
@@ -447,15 +674,19 @@ spv_result_t Parser::parseOperand(size_t inst_offset,
       inst->result_id = word;
       // Save the result ID to type ID mapping.
       // In the grammar, type ID always appears before result ID.
-      if (_.id_to_type_id.find(inst->result_id) != _.id_to_type_id.end())
-        return diagnostic(SPV_ERROR_INVALID_ID)
-               << "Id " << inst->result_id << " is defined more than once";
-      // Record it.
-      // A regular value maps to its type.  Some instructions (e.g. OpLabel)
-      // have no type Id, and will map to 0.  The result Id for a
-      // type-generating instruction (e.g. OpTypeInt) maps to itself.
-      _.id_to_type_id[inst->result_id] =
-          spvOpcodeGeneratesType(opcode) ? inst->result_id : inst->type_id;
+      {
+        IdInfo& info = idInfo(inst->result_id);
+        if (info.defined)
+          return diagnostic(SPV_ERROR_INVALID_ID)
+                 << "Id " << inst->result_id << " is defined more than once";
+        // Record it.
+        // A regular value maps to its type.  Some instructions (e.g. OpLabel)
+        // have no type Id, and will map to 0.  The result Id for a
+        // type-generating instruction (e.g. OpTypeInt) maps to itself.
+        info.defined = true;
+        info.type_id =
+            spvOpcodeGeneratesType(opcode) ? inst->result_id : inst->type_id;
+      }
       break;
 
     case SPV_OPERAND_TYPE_ID:
@@ -466,13 +697,13 @@ spv_result_t Parser::parseOperand(size_t inst_offset,
       if (opcode == SpvOpExtInst && parsed_operand.offset == 3) {
         // The current word is the extended instruction set Id.
         // Set the extended instruction set type for the current instruction.
-        auto ext_inst_type_iter = _.import_id_to_ext_inst_type.find(word);
-        if (ext_inst_type_iter == _.import_id_to_ext_inst_type.end()) {
+        const IdInfo* info = findIdInfo(word);
+        if (!info || info->ext_inst_type == SPV_EXT_INST_TYPE_NONE) {
           return diagnostic(SPV_ERROR_INVALID_ID)
                  << "OpExtInst set Id " << word
                  << " does not reference an OpExtInstImport result Id";
         }
-        inst->ext_inst_type = ext_inst_type_iter->second;
+        inst->ext_inst_type = info->ext_inst_type;
       }
       break;
 
@@ -542,13 +773,12 @@ spv_result_t Parser::parseOperand(size_t inst_offset,
         // The literal operands have the same type as the value
         // referenced by the selector Id.
         const uint32_t selector_id = peekAt(inst_offset + 1);
-        const auto type_id_iter = _.id_to_type_id.find(selector_id);
-        if (type_id_iter == _.id_to_type_id.end() ||
-            type_id_iter->second == 0) {
+        const IdInfo* info = findIdInfo(selector_id);
+        if (!info || info->type_id == 0) {
           return diagnostic() << "Invalid OpSwitch: selector id " << selector_id
                               << " has no type";
         }
-        uint32_t type_id = type_id_iter->second;
+        uint32_t type_id = info->type_id;
 
         if (selector_id == type_id) {
           // Recall that by convention, a result ID that is a type definition
@@ -576,9 +806,10 @@ spv_result_t Parser::parseOperand(size_t inst_offset,
 
     case SPV_OPERAND_TYPE_LITERAL_STRING:
     case SPV_OPERAND_TYPE_OPTIONAL_LITERAL_STRING: {
-      convert_operand_endianness = false;
+      // Literal strings are not endian-converted, so read them from the
+      // caller's words.
       const char* string =
-          reinterpret_cast<const char*>(_.words + _.word_index);
+          reinterpret_cast<const char*>(_.original_words + _.word_index);
       // Compute the length of the string, but make sure we don't run off the
       // end of the input.
       const size_t remaining_input_bytes =
@@ -605,6 +836,13 @@ spv_result_t Parser::parseOperand(size_t inst_offset,
       parsed_operand.num_words = uint16_t(string_num_words);
       parsed_operand.type = SPV_OPERAND_TYPE_LITERAL_STRING;
 
+      if (_.requires_endian_conversion) {
+        // Undo the bulk conversion for the words of the string.
+        std::copy(_.original_words + _.word_index,
+                  _.original_words + _.word_index + string_num_words,
+                  _.endian_converted_words.begin() + _.word_index);
+      }
+
       if (SpvOpExtInstImport == opcode) {
         // Record the extended instruction type for the ID for this import.
         // There is only one string literal argument to OpExtInstImport,
@@ -618,7 +856,7 @@ spv_result_t Parser::parseOperand(size_t inst_offset,
         // We must have parsed a valid result ID.  It's a condition
         // of the grammar, and we only accept non-zero result Ids.
         assert(inst->result_id);
-        _.import_id_to_ext_inst_type[inst->result_id] = ext_inst_type;
+        idInfo(inst->result_id).ext_inst_type = ext_inst_type;
       }
     } break;
 
@@ -735,21 +973,6 @@ spv_result_t Parser::parseOperand(size_t inst_offset,
   if (_.num_words < index_after_operand)
     return exhaustedInputDiagnostic(inst_offset, opcode, type);
 
-  if (_.requires_endian_conversion) {
-    // Copy instruction words.  Translate to native endianness as needed.
-    if (convert_operand_endianness) {
-      const spv_endianness_t endianness = _.endian;
-      std::transform(_.words + _.word_index, _.words + index_after_operand,
-                     std::back_inserter(*words),
-                     [endianness](const uint32_t raw_word) {
-                       return spvFixWord(raw_word, endianness);
-                     });
-    } else {
-      words->insert(words->end(), _.words + _.word_index,
-                    _.words + index_after_operand);
-    }
-  }
-
   // Advance past the operand.
   _.word_index = index_after_operand;
 
@@ -759,11 +982,11 @@ spv_result_t Parser::parseOperand(size_t inst_offset,
 spv_result_t Parser::setNumericTypeInfoForType(
     spv_parsed_operand_t* parsed_operand, uint32_t type_id) {
   assert(type_id != 0);
-  auto type_info_iter = _.type_id_to_number_type_info.find(type_id);
-  if (type_info_iter == _.type_id_to_number_type_info.end()) {
+  const IdInfo* id_info = findIdInfo(type_id);
+  if (!id_info || !id_info->is_type) {
     return diagnostic() << "Type Id " << type_id << " is not a type";
   }
-  const NumberType& info = type_info_iter->second;
+  const NumberType& info = id_info->number_type;
   if (info.type == SPV_NUMBER_NONE) {
     // This is a valid type, but for something other than a scalar number.
     return diagnostic() << "Type Id " << type_id
@@ -791,8 +1014,42 @@ void Parser::recordNumberType(size_t inst_offset,
       info.bit_width = peekAt(inst_offset + 2);
     }
     // The *result* Id of a type generating instruction is the type Id.
-    _.type_id_to_number_type_info[inst->result_id] = info;
+    IdInfo& id_info = idInfo(inst->result_id);
+    id_info.is_type = true;
+    id_info.number_type = info;
+  }
+}
+
+Parser::IdInfo& Parser::idInfo(uint32_t id) {
+  if (id < _.ids.size()) return _.ids[id];
+
+  // When the module is parsed in pieces, more of it may have been seen since
+  // the table was last sized, so grow it if the id is now in range.
+  const size_t limit =
+      std::min<size_t>(_.id_bound, _.word_offset + _.num_words);
+  if (id >= limit) return _.overflow_ids[id];
+  _.ids.resize(std::min(limit, std::max<size_t>(id + 1, 2 * _.ids.size())));
+  // Move any ids the table now covers into it.
+  for (auto iter = _.overflow_ids.begin(); iter != _.overflow_ids.end();) {
+    if (iter->first < _.ids.size()) {
+      _.ids[iter->first] = iter->second;
+      iter = _.overflow_ids.erase(iter);
+    } else {
+      ++iter;
+    }
   }
+  return _.ids[id];
+}
+
+const Parser::IdInfo* Parser::findIdInfo(uint32_t id) const {
+  const IdInfo* info = nullptr;
+  if (id < _.ids.size()) {
+    info = &_.ids[id];
+  } else {
+    const auto iter = _.overflow_ids.find(id);
+    if (iter != _.overflow_ids.end()) info = &iter->second;
+  }
+  return info && info->defined ? info : nullptr;
 }
 
 }  // anonymous namespace
@@ -811,6 +1068,392 @@ spv_result_t spvBinaryParse(const spv_const_context context, void* user_data,
   return parser.parse(code, num_words, diagnostic);
 }
 
+spv_result_t spvBinaryParseWithIndex(
+    const spv_const_context context, void* user_data, const uint32_t* code,
+    const size_t num_words, spv_parsed_header_fn_t parsed_header,
+    spv_parsed_instruction_fn_t parsed_instruction, spv_binary_index* index,
+    spv_diagnostic* diagnostic) {
+  if (!index) return SPV_ERROR_INVALID_POINTER;
+  *index = nullptr;
+  spv_context_t hijack_context = *context;
+  if (diagnostic) {
+    *diagnostic = nullptr;
+    spvtools::UseDiagnosticAsMessageConsumer(&hijack_context, diagnostic);
+  }
+  IndexBuilder index_builder;
+  Parser parser(&hijack_context, user_data, parsed_header, parsed_instruction);
+  parser.setIndexBuilder(&index_builder);
+  if (auto error = parser.parse(code, num_words, diagnostic)) return error;
+  *index = index_builder.release(num_words);
+  return SPV_SUCCESS;
+}
+
+void spvBinaryIndexDestroy(spv_binary_index index) {
+  if (index) {
+    delete[] index->functions;
+    delete[] index->labels;
+    delete index;
+  }
+}
+
+// A binary parser that is fed a module in arbitrarily sized pieces.  Complete
+// instructions are parsed as soon as they have been received; only the words
+// of the current partial instruction are retained between pieces.
+struct spv_binary_parser_t {
+  spv_binary_parser_t(const spv_const_context context, void* user_data,
+                      spv_parsed_header_fn_t parsed_header,
+                      spv_parsed_instruction_fn_t parsed_instruction)
+      : context_(*context),
+        parser_(&context_, user_data, parsed_header, parsed_instruction) {
+    // Route messages to the diagnostic of the current call, if there is one.
+    const spvtools::MessageConsumer consumer = context->consumer;
+    spvtools::SetContextMessageConsumer(
+        &context_, [this, consumer](spv_message_level_t level,
+                                    const char* source,
+                                    const spv_position_t& position,
+                                    const char* message) {
+          // Remember the message, to repeat it if the failure is returned
+          // again.
+          error_position_ = position;
+          error_message_ = message ? message : "";
+          if (diagnostic_) {
+            auto p = position;
+            spvDiagnosticDestroy(*diagnostic_);  // Avoid memory leak.
+            *diagnostic_ = spvDiagnosticCreate(&p, message);
+          } else if (consumer) {
+            consumer(level, source, position, message);
+          }
+        });
+    reset();
+  }
+
+  // Appends the given bytes to the module, and parses any instructions they
+  // complete.
+  spv_result_t feed(const void* data, size_t num_bytes,
+                    spv_diagnostic* diagnostic);
+
+  // Parses whatever remains of the module, and prepares to accept a new one.
+  spv_result_t finish(spv_diagnostic* diagnostic);
+
+ private:
+  // Forgets the current module.
+  void reset() {
+    parser_.beginModule(nullptr);
+    result_ = SPV_SUCCESS;
+    header_parsed_ = false;
+    num_consumed_words_ = 0;
+    words_.clear();
+    num_partial_bytes_ = 0;
+    error_message_.clear();
+  }
+
+  // Emits the diagnostic of the failure that ended the current module again,
+  // if there was one.
+  void repeatError() {
+    if (error_message_.empty()) return;
+    const std::string message = error_message_;
+    context_.consumer(SPV_MSG_ERROR, "", error_position_, message.c_str());
+  }
+
+  // Parses the header, if it has not been parsed yet, and then all complete
+  // instructions in words_.  If at_end is true, then there is no more input
+  // and all of words_ is parsed.
+  spv_result_t parseWords(bool at_end);
+
+  // Sets where diagnostics for the current call go.
+  void setDiagnostic(spv_diagnostic* diagnostic) {
+    diagnostic_ = diagnostic;
+    if (diagnostic_) *diagnostic_ = nullptr;
+  }
+
+  spv_context_t context_;  // Copy of the context, with our message consumer.
+  spv_diagnostic* diagnostic_ = nullptr;  // Diagnostic of the current call.
+  Parser parser_;
+  spv_result_t result_;  // First failure in the current module, if any.
+  bool header_parsed_;   // Has the module header been parsed?
+  // Number of module words parsed and removed from the front of words_.
+  size_t num_consumed_words_;
+  // Received words that have not been parsed yet.
+  std::vector<uint32_t> words_;
+  // Bytes of a received but incomplete word.
+  unsigned char partial_word_[sizeof(uint32_t)];
+  size_t num_partial_bytes_;
+  // The last message emitted for the current module, and where it was.
+  spv_position_t error_position_ = {0, 0, 0};
+  std::string error_message_;
+};
+
+spv_result_t spv_binary_parser_t::feed(const void* data, size_t num_bytes,
+                                       spv_diagnostic* diagnostic) {
+  setDiagnostic(diagnostic);
+  if (result_ != SPV_SUCCESS) {
+    repeatError();
+  } else {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    // Complete a word left over from the previous piece.
+    while (num_bytes && num_partial_bytes_) {
+      partial_word_[num_partial_bytes_++] = *bytes++;
+      num_bytes--;
+      if (num_partial_bytes_ == sizeof(uint32_t)) {
+        uint32_t word;
+        memcpy(&word, partial_word_, sizeof(word));
+        words_.push_back(word);
+        num_partial_bytes_ = 0;
+      }
+    }
+    const size_t num_words = num_bytes / sizeof(uint32_t);
+    const size_t old_size = words_.size();
+    words_.resize(old_size + num_words);
+    if (num_words) {
+      memcpy(words_.data() + old_size, bytes, num_words * sizeof(uint32_t));
+    }
+    bytes += num_words * sizeof(uint32_t);
+    num_bytes -= num_words * sizeof(uint32_t);
+    // Keep the bytes of a trailing partial word for the next piece.
+    if (num_bytes) {
+      memcpy(partial_word_, bytes, num_bytes);
+      num_partial_bytes_ = num_bytes;
+    }
+
+    result_ = parseWords(false);
+  }
+  setDiagnostic(nullptr);
+  return result_;
+}
+
+spv_result_t spv_binary_parser_t::finish(spv_diagnostic* diagnostic) {
+  setDiagnostic(diagnostic);
+  if (result_ != SPV_SUCCESS) {
+    repeatError();
+  } else if (num_partial_bytes_) {
+    result_ = spvtools::DiagnosticStream({0, 0, 0}, context_.consumer, "",
+                                         SPV_ERROR_INVALID_BINARY)
+              << "Module size is not a multiple of 4 bytes: "
+              << num_partial_bytes_ << " trailing bytes after word "
+              << num_consumed_words_ + words_.size();
+  } else {
+    result_ = parseWords(true);
+  }
+  const spv_result_t result = result_;
+  setDiagnostic(nullptr);
+  reset();
+  return result;
+}
+
+spv_result_t spv_binary_parser_t::parseWords(bool at_end) {
+  size_t begin = 0;
+  if (!header_parsed_) {
+    if (words_.size() < SPV_INDEX_INSTRUCTION && !at_end) return SPV_SUCCESS;
+    if (auto error = parser_.parseHeaderWords(words_.data(), words_.size()))
+      return error;
+    header_parsed_ = true;
+    begin = SPV_INDEX_INSTRUCTION;
+  }
+
+  // Find the end of the last complete instruction.  An invalid word count
+  // ends the search, and is reported by the parser.
+  size_t end = begin;
+  while (end < words_.size()) {
+    uint16_t word_count = 0;
+    spvOpcodeSplit(spvFixWord(words_[end], parser_.endian()), &word_count,
+                   nullptr);
+    if (word_count == 0) {
+      end++;
+      break;
+    }
+    if (words_.size() - end < word_count) break;
+    end += word_count;
+  }
+  if (at_end) end = words_.size();
+
+  if (end > begin) {
+    if (auto error = parser_.parseInstructionWords(
+            words_.data() + begin, end - begin, num_consumed_words_ + begin)) {
+      return error;
+    }
+  }
+  words_.erase(words_.begin(), words_.begin() + end);
+  num_consumed_words_ += end;
+  return SPV_SUCCESS;
+}
+
+spv_binary_parser spvBinaryParserCreate(
+    const spv_const_context context, void* user_data,
+    spv_parsed_header_fn_t parsed_header,
+    spv_parsed_instruction_fn_t parsed_instruction) {
+  if (!context) return nullptr;
+  return new spv_binary_parser_t(context, user_data, parsed_header,
+                                 parsed_instruction);
+}
+
+void spvBinaryParserDestroy(spv_binary_parser parser) { delete parser; }
+
+spv_result_t spvBinaryParserFeed(spv_binary_parser parser, const void* data,
+                                 size_t num_bytes,
+                                 spv_diagnostic* diagnostic) {
+  if (!parser || (!data && num_bytes)) return SPV_ERROR_INVALID_POINTER;
+  return parser->feed(data, num_bytes, diagnostic);
+}
+
+spv_result_t spvBinaryParserFinish(spv_binary_parser parser,
+                                   spv_diagnostic* diagnostic) {
+  if (!parser) return SPV_ERROR_INVALID_POINTER;
+  return parser->finish(diagnostic);
+}
+
+namespace {
+
+// Returns true if the given opcode belongs to the leading sections of a
+// module that a module summary describes.
+bool IsSummarizedOpcode(uint16_t opcode) {
+  switch (opcode) {
+    case SpvOpCapability:
+    case SpvOpExtension:
+    case SpvOpExtInstImport:
+    case SpvOpMemoryModel:
+    case SpvOpEntryPoint:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns the number of words in the given module before the first
+// instruction that a module summary does not need, found by stepping over
+// instruction word counts without parsing any operands.
+size_t SummarizedWordCount(const uint32_t* words, size_t num_words) {
+  spv_const_binary_t binary{words, num_words};
+  spv_endianness_t endian;
+  // The parser diagnoses a missing or bad header.
+  if (!words || num_words < SPV_INDEX_INSTRUCTION ||
+      spvBinaryEndianness(&binary, &endian)) {
+    return num_words;
+  }
+  size_t word_index = SPV_INDEX_INSTRUCTION;
+  while (word_index < num_words) {
+    uint16_t word_count = 0;
+    uint16_t opcode = 0;
+    spvOpcodeSplit(spvFixWord(words[word_index], endian), &word_count,
+                   &opcode);
+    if (!IsSummarizedOpcode(opcode)) break;
+    // The parser diagnoses a zero word count.
+    word_index += std::max<uint16_t>(word_count, 1);
+  }
+  return std::min(word_index, num_words);
+}
+
+// Collects a module summary from the parsed leading sections of a module.
+struct SummaryBuilder {
+  struct EntryPoint {
+    uint32_t execution_model;
+    uint32_t id;
+    std::string name;
+  };
+
+  // Returns a new summary of what has been collected.
+  spv_module_summary release() const;
+
+  spv_module_summary_t header = {};
+  std::vector<uint32_t> capabilities;
+  std::vector<std::string> extensions;
+  std::vector<EntryPoint> entry_points;
+};
+
+// Returns a new null-terminated copy of the given string.
+char* CopyString(const std::string& str) {
+  char* copy = new char[str.size() + 1];
+  std::memcpy(copy, str.c_str(), str.size() + 1);
+  return copy;
+}
+
+spv_module_summary SummaryBuilder::release() const {
+  spv_module_summary summary = new spv_module_summary_t(header);
+  summary->num_capabilities = capabilities.size();
+  summary->capabilities = new uint32_t[capabilities.size()];
+  std::copy(capabilities.begin(), capabilities.end(), summary->capabilities);
+  summary->num_extensions = extensions.size();
+  summary->extensions = new char*[extensions.size()];
+  for (size_t i = 0; i < extensions.size(); ++i)
+    summary->extensions[i] = CopyString(extensions[i]);
+  summary->num_entry_points = entry_points.size();
+  summary->entry_points = new spv_entry_point_summary_t[entry_points.size()];
+  for (size_t i = 0; i < entry_points.size(); ++i) {
+    const EntryPoint& entry_point = entry_points[i];
+    summary->entry_points[i] = {entry_point.execution_model, entry_point.id,
+                                CopyString(entry_point.name)};
+  }
+  return summary;
+}
+
+spv_result_t SummarizeHeader(void* user_data, spv_endianness_t, uint32_t,
+                             uint32_t version, uint32_t generator,
+                             uint32_t id_bound, uint32_t) {
+  spv_module_summary_t& header =
+      reinterpret_cast<SummaryBuilder*>(user_data)->header;
+  header.version = version;
+  header.generator = generator;
+  header.id_bound = id_bound;
+  return SPV_SUCCESS;
+}
+
+spv_result_t SummarizeInstruction(void* user_data,
+                                  const spv_parsed_instruction_t* inst) {
+  SummaryBuilder& builder = *reinterpret_cast<SummaryBuilder*>(user_data);
+  const uint32_t* words = inst->words;
+  switch (inst->opcode) {
+    case SpvOpCapability:
+      builder.capabilities.push_back(words[1]);
+      break;
+    case SpvOpExtension:
+      builder.extensions.emplace_back(
+          reinterpret_cast<const char*>(words + 1));
+      break;
+    case SpvOpMemoryModel:
+      builder.header.has_memory_model = true;
+      builder.header.addressing_model = words[1];
+      builder.header.memory_model = words[2];
+      break;
+    case SpvOpEntryPoint:
+      builder.entry_points.push_back(
+          {words[1], words[2], reinterpret_cast<const char*>(words + 3)});
+      break;
+    default:
+      break;
+  }
+  return SPV_SUCCESS;
+}
+
+}  // anonymous namespace
+
+spv_result_t spvBinaryProbe(const spv_const_context context,
+                            const uint32_t* words, const size_t num_words,
+                            spv_module_summary* summary,
+                            spv_diagnostic* diagnostic) {
+  if (!summary) return SPV_ERROR_INVALID_POINTER;
+  *summary = nullptr;
+  SummaryBuilder builder;
+  if (auto error = spvBinaryParse(
+          context, &builder, words, SummarizedWordCount(words, num_words),
+          SummarizeHeader, SummarizeInstruction, diagnostic)) {
+    return error;
+  }
+  *summary = builder.release();
+  return SPV_SUCCESS;
+}
+
+void spvModuleSummaryDestroy(spv_module_summary summary) {
+  if (summary) {
+    for (size_t i = 0; i < summary->num_extensions; ++i)
+      delete[] summary->extensions[i];
+    for (size_t i = 0; i < summary->num_entry_points; ++i)
+      delete[] summary->entry_points[i].name;
+    delete[] summary->capabilities;
+    delete[] summary->extensions;
+    delete[] summary->entry_points;
+    delete summary;
+  }
+}
+
 // TODO(dneto): This probably belongs in text.cpp since that's the only place
 // that a spv_binary_t value is created.
 void spvBinaryDestroy(spv_binary binary) {
@@ -81,14 +81,15 @@ class CFA {
   /// @brief Calculates dominator edges for a set of blocks
   ///
   /// Computes dominators using the algorithm of Cooper, Harvey, and Kennedy
-  /// "A Simple, Fast Dominance Algorithm", 2001.
+  /// "A Simple, Fast Dominance Algorithm", 2001, for graphs with fewer than
+  /// kMinBlocksForSemiNCA blocks, and with the Semi-NCA algorithm otherwise.
+  /// Both give the same result.
   ///
   /// The algorithm assumes there is a unique root node (a node without
   /// predecessors), and it is therefore at the end of the postorder vector.
   ///
   /// This function calculates the dominator edges for a set of blocks in the
   /// CFG.
-  /// Uses the dominator algorithm by Cooper et al.
   ///
   /// @param[in] postorder        A vector of blocks in post order traversal
   /// order
@@ -106,6 +107,30 @@ class CFA {
   static std::vector<std::pair<BB*, BB*>> CalculateDominators(
       const std::vector<cbb_ptr>& postorder, get_blocks_func predecessor_func);
 
+  /// The number of blocks from which CalculateDominators uses Semi-NCA.  On
+  /// smaller graphs, setting up Semi-NCA costs more than the iterations it
+  /// saves.
+  static const size_t kMinBlocksForSemiNCA = 8;
+
+  /// @brief Calculates dominator edges like CalculateDominators, always with
+  /// the iterative algorithm of Cooper, Harvey, and Kennedy.
+  ///
+  /// Each pass over the blocks is linear, but graphs with irreducible or
+  /// deeply nested loops can need many passes.
+  static std::vector<std::pair<BB*, BB*>> CalculateDominatorsIteratively(
+      const std::vector<cbb_ptr>& postorder, get_blocks_func predecessor_func);
+
+  /// @brief Calculates dominator edges like CalculateDominators, always with
+  /// the Semi-NCA algorithm.
+  ///
+  /// Computes semidominators as in Lengauer and Tarjan "A Fast Algorithm for
+  /// Finding Dominators in a Flowgraph", 1979, and then immediate dominators
+  /// as nearest common ancestors of the spanning tree as in Georgiadis
+  /// "Linear-Time Algorithms for Dominators and Related Problems", 2005.
+  /// Needs a single pass over the edges, whatever the shape of the graph.
+  static std::vector<std::pair<BB*, BB*>> CalculateDominatorsSemiNCA(
+      const std::vector<cbb_ptr>& postorder, get_blocks_func predecessor_func);
+
   // Computes a minimal set of root nodes required to traverse, in the forward
   // direction, the CFG represented by the given vector of blocks, and successor
   // and predecessor functions.  When considering adding two nodes, each having
@@ -124,6 +149,9 @@ class CFA {
       get_blocks_func succ_func, get_blocks_func pred_func);
 };
 
+template <class BB>
+const size_t CFA<BB>::kMinBlocksForSemiNCA;
+
 template <class BB>
 bool CFA<BB>::FindInWorkList(const std::vector<block_info>& work_list,
                              uint32_t id) {
@@ -174,6 +202,15 @@ void CFA<BB>::DepthFirstTraversal(
 template <class BB>
 std::vector<std::pair<BB*, BB*>> CFA<BB>::CalculateDominators(
     const std::vector<cbb_ptr>& postorder, get_blocks_func predecessor_func) {
+  if (postorder.size() < kMinBlocksForSemiNCA) {
+    return CalculateDominatorsIteratively(postorder, predecessor_func);
+  }
+  return CalculateDominatorsSemiNCA(postorder, predecessor_func);
+}
+
+template <class BB>
+std::vector<std::pair<BB*, BB*>> CFA<BB>::CalculateDominatorsIteratively(
+    const std::vector<cbb_ptr>& postorder, get_blocks_func predecessor_func) {
   struct block_detail {
     size_t dominator;  ///< The index of blocks's dominator in post order array
     size_t postorder_index;  ///< The index of the block in the post order array
@@ -256,6 +293,132 @@ std::vector<std::pair<BB*, BB*>> CFA<BB>::CalculateDominators(
   return out;
 }
 
+template <class BB>
+std::vector<std::pair<BB*, BB*>> CFA<BB>::CalculateDominatorsSemiNCA(
+    const std::vector<cbb_ptr>& postorder, get_blocks_func predecessor_func) {
+  const uint32_t num_blocks = static_cast<uint32_t>(postorder.size());
+  const uint32_t none = num_blocks;
+  if (num_blocks == 0) return {};
+
+  std::unordered_map<cbb_ptr, uint32_t> postorder_index;
+  postorder_index.reserve(num_blocks);
+  for (uint32_t i = 0; i < num_blocks; ++i) {
+    postorder_index.emplace(postorder[i], i);
+  }
+
+  // Gather the edges between the blocks, by postorder index, ignoring
+  // predecessors that are not in the graph.  Successors are found by
+  // reversing the predecessor edges.
+  std::vector<uint32_t> pred_begin(num_blocks + 1, 0);
+  std::vector<uint32_t> preds;
+  std::vector<uint32_t> succ_begin(num_blocks + 1, 0);
+  for (uint32_t i = 0; i < num_blocks; ++i) {
+    pred_begin[i] = static_cast<uint32_t>(preds.size());
+    for (const BB* pred : *predecessor_func(postorder[i])) {
+      auto found = postorder_index.find(pred);
+      if (found == postorder_index.end()) continue;
+      preds.push_back(found->second);
+      ++succ_begin[found->second + 1];
+    }
+  }
+  pred_begin[num_blocks] = static_cast<uint32_t>(preds.size());
+  for (uint32_t i = 0; i < num_blocks; ++i) {
+    succ_begin[i + 1] += succ_begin[i];
+  }
+  std::vector<uint32_t> succs(preds.size());
+  std::vector<uint32_t> next_succ(succ_begin.begin(), succ_begin.end() - 1);
+  for (uint32_t i = 0; i < num_blocks; ++i) {
+    for (uint32_t e = pred_begin[i]; e < pred_begin[i + 1]; ++e) {
+      succs[next_succ[preds[e]]++] = i;
+    }
+  }
+
+  // Number the blocks in preorder of a depth first spanning tree from the
+  // root.  From here on blocks are named by their preorder numbers.
+  std::vector<uint32_t> preorder(num_blocks, none);
+  std::vector<uint32_t> block(num_blocks);
+  std::vector<uint32_t> parent(num_blocks, none);
+  uint32_t num_visited = 0;
+  {
+    std::vector<uint32_t> stack;
+    const uint32_t root = num_blocks - 1;
+    next_succ.assign(succ_begin.begin(), succ_begin.end() - 1);
+    preorder[root] = num_visited;
+    block[num_visited++] = root;
+    stack.push_back(root);
+    while (!stack.empty()) {
+      const uint32_t b = stack.back();
+      if (next_succ[b] == succ_begin[b + 1]) {
+        stack.pop_back();
+        continue;
+      }
+      const uint32_t succ = succs[next_succ[b]++];
+      if (preorder[succ] != none) continue;
+      preorder[succ] = num_visited;
+      parent[num_visited] = preorder[b];
+      block[num_visited++] = succ;
+      stack.push_back(succ);
+    }
+  }
+  // The predecessors do not lead back to every block from the root, so they
+  // do not match the order.  Leave such graphs to the iterative algorithm,
+  // which tolerates them.
+  if (num_visited != num_blocks) {
+    return CalculateDominatorsIteratively(postorder, predecessor_func);
+  }
+
+  // Compute semidominators from the last block in preorder to the first.
+  // Processed blocks are linked into a forest under their spanning tree
+  // parents.  Evaluating a block compresses its path in the forest, leaving
+  // in |label| the block of least semidominator on the path.
+  std::vector<uint32_t> semi(num_blocks);
+  std::vector<uint32_t> label(num_blocks);
+  std::vector<uint32_t> ancestor(num_blocks, none);
+  for (uint32_t v = 0; v < num_blocks; ++v) semi[v] = label[v] = v;
+  std::vector<uint32_t> path;
+  auto eval = [&semi, &label, &ancestor, &path, none](uint32_t v) {
+    if (ancestor[v] == none) return v;
+    path.clear();
+    for (uint32_t u = v; ancestor[ancestor[u]] != none; u = ancestor[u]) {
+      path.push_back(u);
+    }
+    for (auto u = path.rbegin(); u != path.rend(); ++u) {
+      const uint32_t a = ancestor[*u];
+      if (semi[label[a]] < semi[label[*u]]) label[*u] = label[a];
+      ancestor[*u] = ancestor[a];
+    }
+    return label[v];
+  };
+  for (uint32_t w = num_blocks - 1; w > 0; --w) {
+    const uint32_t b = block[w];
+    for (uint32_t e = pred_begin[b]; e < pred_begin[b + 1]; ++e) {
+      semi[w] = std::min(semi[w], semi[eval(preorder[preds[e]])]);
+    }
+    ancestor[w] = parent[w];
+  }
+
+  // The immediate dominator of a block is the nearest common ancestor of its
+  // semidominator and its parent, which is the nearest of the dominators of
+  // its parent that is not after its semidominator.
+  std::vector<uint32_t> idom(num_blocks);
+  idom[0] = 0;
+  for (uint32_t w = 1; w < num_blocks; ++w) {
+    uint32_t d = parent[w];
+    while (d > semi[w]) d = idom[d];
+    idom[w] = d;
+  }
+
+  // List the edges by postorder index of the block, as the iterative
+  // algorithm does.
+  std::vector<std::pair<bb_ptr, bb_ptr>> out;
+  out.reserve(num_blocks);
+  for (uint32_t i = 0; i < num_blocks; ++i) {
+    out.push_back({const_cast<BB*>(postorder[i]),
+                   const_cast<BB*>(postorder[block[idom[preorder[i]]]])});
+  }
+  return out;
+}
+
 template <class BB>
 std::vector<BB*> CFA<BB>::TraversalRoots(const std::vector<BB*>& blocks,
                                          get_blocks_func succ_func,
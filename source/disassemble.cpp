@@ -18,12 +18,17 @@
 // to text.
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstring>
-#include <iomanip>
+#include <iostream>
 #include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "source/assembly_grammar.h"
 #include "source/binary.h"
@@ -44,10 +49,16 @@ namespace {
 
 // A Disassembler instance converts a SPIR-V binary to its assembly
 // representation.
+//
+// The text is accumulated in a character buffer, which is reused across
+// instructions when printing, rather than written through a std::ostream.
+// Numbers other than floating point ones are formatted directly, and id names
+// are looked up once and then copied from a cache, so that disassembling an
+// instruction does not usually allocate.
 class Disassembler {
  public:
   Disassembler(const spvtools::AssemblyGrammar& grammar, uint32_t options,
-               spvtools::NameMapper name_mapper)
+               spvtools::NameMapper name_mapper, size_t num_words)
       : grammar_(grammar),
         print_(spvIsInBitfield(SPV_BINARY_TO_TEXT_OPTION_PRINT, options)),
         color_(spvIsInBitfield(SPV_BINARY_TO_TEXT_OPTION_COLOR, options)),
@@ -56,13 +67,12 @@ class Disassembler {
                     : 0),
         comment_(spvIsInBitfield(SPV_BINARY_TO_TEXT_OPTION_COMMENT, options)),
         text_(),
-        out_(print_ ? out_stream() : out_stream(text_)),
-        stream_(out_.get()),
         header_(!spvIsInBitfield(SPV_BINARY_TO_TEXT_OPTION_NO_HEADER, options)),
         show_byte_offset_(spvIsInBitfield(
             SPV_BINARY_TO_TEXT_OPTION_SHOW_BYTE_OFFSET, options)),
         byte_offset_(0),
-        name_mapper_(std::move(name_mapper)) {}
+        name_mapper_(std::move(name_mapper)),
+        num_words_(num_words) {}
 
   // Emits the assembly header for the module, and sets up internal state
   // so subsequent callbacks can handle the cases where the entire module
@@ -77,10 +87,48 @@ class Disassembler {
   // Returns SPV_SUCCESS on success.
   spv_result_t SaveTextResult(spv_text* text_result) const;
 
+  // How far disassembly has got through a module: what another Disassembler
+  // needs to know to carry on from there.
+  struct Progress {
+    size_t byte_offset;  // The byte offset of the next instruction.
+    bool inserted_decoration_space;
+    bool inserted_debug_space;
+    bool inserted_type_space;
+
+    // Moves past the given instruction, without emitting it.
+    void Skip(const spv_parsed_instruction_t& inst);
+  };
+
+  Progress progress() const {
+    return {byte_offset_, inserted_decoration_space_, inserted_debug_space_,
+            inserted_type_space_};
+  }
+
+  // Prepares to carry on from |progress| through the module whose header
+  // |other| has handled.
+  void Resume(const Disassembler& other, const Progress& progress);
+
+  // Moves the accumulated text into |text|.
+  void TakeText(std::string* text) {
+    text->swap(text_);
+    text_.clear();
+  }
+
+  // Appends text emitted by another Disassembler.
+  void EmitText(const std::string& text) {
+    Emit(text.data(), text.size());
+    Flush();
+  }
+
  private:
   enum { kStandardIndent = 15 };
 
-  using out_stream = spvtools::out_stream;
+  // The location of a cached id name in id_names_text_.
+  struct IdName {
+    size_t offset;
+    uint32_t length;
+    bool cached;  // False until the name has been looked up.
+  };
 
   // Emits an operand for the given instruction, where the instruction
   // is at offset words from the start of the binary.
@@ -90,29 +138,82 @@ class Disassembler {
   // Emits a mask expression for the given mask word of the specified type.
   void EmitMaskOperand(const spv_operand_type_t type, const uint32_t word);
 
+  // Emits the given numeric literal operand of the given instruction.
+  void EmitNumericLiteral(const spv_parsed_instruction_t& inst,
+                          const spv_parsed_operand_t& operand);
+
+  // Appends text to the output.
+  void Emit(const char* str, size_t length) { text_.append(str, length); }
+  void Emit(const char* str) { text_.append(str); }
+  void Emit(char c) { text_.push_back(c); }
+
+  // Appends the given number of spaces to the output.
+  void EmitSpaces(int count) {
+    if (count > 0) text_.append(size_t(count), ' ');
+  }
+
+  // Appends the given number to the output, in decimal.
+  void EmitUnsigned(uint64_t value);
+  void EmitSigned(int64_t value);
+
+  // Appends the given number to the output in hexadecimal, padded with zeros
+  // to at least the given number of digits.
+  void EmitHex(uint64_t value, int min_digits);
+
+  // Appends the '%' and the name of the given id to the output.
+  void EmitId(uint32_t id) {
+    const char* name;
+    size_t length;
+    GetIdName(id, &name, &length);
+    Emit('%');
+    Emit(name, length);
+  }
+
+  // Sets *name and *length to the name of the given id.  The name stays
+  // valid until the next call.
+  void GetIdName(uint32_t id, const char** name, size_t* length);
+
+  // When printing, writes the accumulated text to the standard output, and
+  // clears it.
+  void Flush() {
+    if (print_ && !text_.empty()) {
+      std::cout.write(text_.data(), text_.size());
+      text_.clear();
+    }
+  }
+
+  // Appends the escape sequence for the given color.  On some platforms,
+  // getting the escape sequence sets the console color instead, so the text
+  // before it is printed first.
+  template <typename Color>
+  void EmitColor(Color color) {
+    Flush();
+    Emit(static_cast<const char*>(color));
+  }
+
   // Resets the output color, if color is turned on.
   void ResetColor() {
-    if (color_) out_.get() << spvtools::clr::reset{print_};
+    if (color_) EmitColor(spvtools::clr::reset{print_});
   }
   // Sets the output to grey, if color is turned on.
   void SetGrey() {
-    if (color_) out_.get() << spvtools::clr::grey{print_};
+    if (color_) EmitColor(spvtools::clr::grey{print_});
   }
   // Sets the output to blue, if color is turned on.
   void SetBlue() {
-    if (color_) out_.get() << spvtools::clr::blue{print_};
+    if (color_) EmitColor(spvtools::clr::blue{print_});
   }
   // Sets the output to yellow, if color is turned on.
   void SetYellow() {
-    if (color_) out_.get() << spvtools::clr::yellow{print_};
+    if (color_) EmitColor(spvtools::clr::yellow{print_});
   }
   // Sets the output to red, if color is turned on.
   void SetRed() {
-    if (color_) out_.get() << spvtools::clr::red{print_};
+    if (color_) EmitColor(spvtools::clr::red{print_});
   }
   // Sets the output to green, if color is turned on.
   void SetGreen() {
-    if (color_) out_.get() << spvtools::clr::green{print_};
+    if (color_) EmitColor(spvtools::clr::green{print_});
   }
 
   const spvtools::AssemblyGrammar& grammar_;
@@ -121,13 +222,24 @@ class Disassembler {
   const int indent_;  // How much to indent. 0 means don't indent
   const int comment_;        // Should we comment the source
   spv_endianness_t endian_;  // The detected endianness of the binary.
-  std::stringstream text_;   // Captures the text, if not printing.
-  out_stream out_;  // The Output stream.  Either to text_ or standard output.
-  std::ostream& stream_;  // The output std::stream.
-  const bool header_;     // Should we output header as the leading comment?
+  // The text not yet printed, or all of it if not printing.
+  std::string text_;
+  // Formats floating point numbers, which are rare enough to not be worth
+  // formatting directly.
+  std::stringstream float_text_;
+  const bool header_;  // Should we output header as the leading comment?
   const bool show_byte_offset_;  // Should we print byte offset, in hex?
   size_t byte_offset_;           // The number of bytes processed so far.
   spvtools::NameMapper name_mapper_;
+  // The number of words in the binary, which limits the size of id_names_.
+  const size_t num_words_;
+  // The cached names of ids, indexed by id.  Ids beyond its size, which are
+  // only found in invalid modules, are looked up every time.
+  std::vector<IdName> id_names_;
+  // The text of the cached names.
+  std::string id_names_text_;
+  // The name of the last id looked up without caching it.
+  std::string uncached_id_name_;
   bool inserted_decoration_space_ = false;
   bool inserted_debug_space_ = false;
   bool inserted_type_space_ = false;
@@ -141,96 +253,135 @@ spv_result_t Disassembler::HandleHeader(spv_endianness_t endian,
   if (header_) {
     const char* generator_tool =
         spvGeneratorStr(SPV_GENERATOR_TOOL_PART(generator));
-    stream_ << "; SPIR-V\n"
-            << "; Version: " << SPV_SPIRV_VERSION_MAJOR_PART(version) << "."
-            << SPV_SPIRV_VERSION_MINOR_PART(version) << "\n"
-            << "; Generator: " << generator_tool;
+    Emit("; SPIR-V\n; Version: ");
+    EmitUnsigned(SPV_SPIRV_VERSION_MAJOR_PART(version));
+    Emit('.');
+    EmitUnsigned(SPV_SPIRV_VERSION_MINOR_PART(version));
+    Emit("\n; Generator: ");
+    Emit(generator_tool);
     // For unknown tools, print the numeric tool value.
     if (0 == strcmp("Unknown", generator_tool)) {
-      stream_ << "(" << SPV_GENERATOR_TOOL_PART(generator) << ")";
+      Emit('(');
+      EmitUnsigned(SPV_GENERATOR_TOOL_PART(generator));
+      Emit(')');
     }
     // Print the miscellaneous part of the generator word on the same
     // line as the tool name.
-    stream_ << "; " << SPV_GENERATOR_MISC_PART(generator) << "\n"
-            << "; Bound: " << id_bound << "\n"
-            << "; Schema: " << schema << "\n";
+    Emit("; ");
+    EmitUnsigned(SPV_GENERATOR_MISC_PART(generator));
+    Emit("\n; Bound: ");
+    EmitUnsigned(id_bound);
+    Emit("\n; Schema: ");
+    EmitUnsigned(schema);
+    Emit('\n');
+    Flush();
   }
 
   byte_offset_ = SPV_INDEX_INSTRUCTION * sizeof(uint32_t);
+  // Every id defined in a valid module takes at least two words, so this
+  // bounds the memory spent on a bogus id bound.
+  id_names_.assign(std::min<size_t>(id_bound, num_words_),
+                   IdName{0, 0, false});
 
   return SPV_SUCCESS;
 }
 
+void Disassembler::Progress::Skip(const spv_parsed_instruction_t& inst) {
+  const auto opcode = static_cast<SpvOp>(inst.opcode);
+  inserted_decoration_space |= spvOpcodeIsDecoration(opcode);
+  inserted_debug_space |= spvOpcodeIsDebug(opcode);
+  inserted_type_space |= spvOpcodeGeneratesType(opcode);
+  byte_offset += inst.num_words * sizeof(uint32_t);
+}
+
+void Disassembler::Resume(const Disassembler& other,
+                          const Progress& progress) {
+  endian_ = other.endian_;
+  if (id_names_.size() != other.id_names_.size())
+    id_names_.assign(other.id_names_.size(), IdName{0, 0, false});
+  byte_offset_ = progress.byte_offset;
+  inserted_decoration_space_ = progress.inserted_decoration_space;
+  inserted_debug_space_ = progress.inserted_debug_space;
+  inserted_type_space_ = progress.inserted_type_space;
+}
+
 spv_result_t Disassembler::HandleInstruction(
     const spv_parsed_instruction_t& inst) {
   auto opcode = static_cast<SpvOp>(inst.opcode);
   if (comment_ && opcode == SpvOpFunction) {
-    stream_ << std::endl;
-    stream_ << std::string(indent_, ' ');
-    stream_ << "; Function " << name_mapper_(inst.result_id) << std::endl;
+    Emit('\n');
+    EmitSpaces(indent_);
+    Emit("; Function ");
+    const char* name;
+    size_t length;
+    GetIdName(inst.result_id, &name, &length);
+    Emit(name, length);
+    Emit('\n');
   }
   if (comment_ && !inserted_decoration_space_ &&
       spvOpcodeIsDecoration(opcode)) {
     inserted_decoration_space_ = true;
-    stream_ << std::endl;
-    stream_ << std::string(indent_, ' ');
-    stream_ << "; Annotations" << std::endl;
+    Emit('\n');
+    EmitSpaces(indent_);
+    Emit("; Annotations\n");
   }
   if (comment_ && !inserted_debug_space_ && spvOpcodeIsDebug(opcode)) {
     inserted_debug_space_ = true;
-    stream_ << std::endl;
-    stream_ << std::string(indent_, ' ');
-    stream_ << "; Debug Information" << std::endl;
+    Emit('\n');
+    EmitSpaces(indent_);
+    Emit("; Debug Information\n");
   }
   if (comment_ && !inserted_type_space_ && spvOpcodeGeneratesType(opcode)) {
     inserted_type_space_ = true;
-    stream_ << std::endl;
-    stream_ << std::string(indent_, ' ');
-    stream_ << "; Types, variables and constants" << std::endl;
+    Emit('\n');
+    EmitSpaces(indent_);
+    Emit("; Types, variables and constants\n");
   }
 
   if (inst.result_id) {
     SetBlue();
-    const std::string id_name = name_mapper_(inst.result_id);
-    if (indent_)
-      stream_ << std::setw(std::max(0, indent_ - 3 - int(id_name.size())));
-    stream_ << "%" << id_name;
+    const char* name;
+    size_t length;
+    GetIdName(inst.result_id, &name, &length);
+    // Right-align the result id, so that the opcodes line up.
+    if (indent_) EmitSpaces(indent_ - 4 - int(length));
+    Emit('%');
+    Emit(name, length);
     ResetColor();
-    stream_ << " = ";
+    Emit(" = ");
   } else {
-    stream_ << std::string(indent_, ' ');
+    EmitSpaces(indent_);
   }
 
-  stream_ << "Op" << spvOpcodeString(opcode);
+  Emit("Op");
+  Emit(spvOpcodeString(opcode));
 
   for (uint16_t i = 0; i < inst.num_operands; i++) {
     const spv_operand_type_t type = inst.operands[i].type;
     assert(type != SPV_OPERAND_TYPE_NONE);
     if (type == SPV_OPERAND_TYPE_RESULT_ID) continue;
-    stream_ << " ";
+    Emit(' ');
     EmitOperand(inst, i);
   }
 
   if (comment_ && opcode == SpvOpName) {
     const spv_parsed_operand_t& operand = inst.operands[0];
     const uint32_t word = inst.words[operand.offset];
-    stream_ << "  ; id %" << word;
+    Emit("  ; id %");
+    EmitUnsigned(word);
   }
 
   if (show_byte_offset_) {
     SetGrey();
-    auto saved_flags = stream_.flags();
-    auto saved_fill = stream_.fill();
-    stream_ << " ; 0x" << std::setw(8) << std::hex << std::setfill('0')
-            << byte_offset_;
-    stream_.flags(saved_flags);
-    stream_.fill(saved_fill);
+    Emit(" ; 0x");
+    EmitHex(byte_offset_, 8);
     ResetColor();
   }
 
   byte_offset_ += inst.num_words * sizeof(uint32_t);
 
-  stream_ << "\n";
+  Emit('\n');
+  Flush();
   return SPV_SUCCESS;
 }
 
@@ -243,27 +394,27 @@ void Disassembler::EmitOperand(const spv_parsed_instruction_t& inst,
     case SPV_OPERAND_TYPE_RESULT_ID:
       assert(false && "<result-id> is not supposed to be handled here");
       SetBlue();
-      stream_ << "%" << name_mapper_(word);
+      EmitId(word);
       break;
     case SPV_OPERAND_TYPE_ID:
     case SPV_OPERAND_TYPE_TYPE_ID:
     case SPV_OPERAND_TYPE_SCOPE_ID:
     case SPV_OPERAND_TYPE_MEMORY_SEMANTICS_ID:
       SetYellow();
-      stream_ << "%" << name_mapper_(word);
+      EmitId(word);
       break;
     case SPV_OPERAND_TYPE_EXTENSION_INSTRUCTION_NUMBER: {
       spv_ext_inst_desc ext_inst;
       SetRed();
       if (grammar_.lookupExtInst(inst.ext_inst_type, word, &ext_inst) ==
           SPV_SUCCESS) {
-        stream_ << ext_inst->name;
+        Emit(ext_inst->name);
       } else {
         if (!spvExtInstIsNonSemantic(inst.ext_inst_type)) {
           assert(false && "should have caught this earlier");
         } else {
           // for non-semantic instruction sets we can just print the number
-          stream_ << word;
+          EmitUnsigned(word);
         }
       }
     } break;
@@ -272,27 +423,27 @@ void Disassembler::EmitOperand(const spv_parsed_instruction_t& inst,
       if (grammar_.lookupOpcode(SpvOp(word), &opcode_desc))
         assert(false && "should have caught this earlier");
       SetRed();
-      stream_ << opcode_desc->name;
+      Emit(opcode_desc->name);
     } break;
     case SPV_OPERAND_TYPE_LITERAL_INTEGER:
     case SPV_OPERAND_TYPE_TYPED_LITERAL_NUMBER: {
       SetRed();
-      spvtools::EmitNumericLiteral(&stream_, inst, operand);
+      EmitNumericLiteral(inst, operand);
       ResetColor();
     } break;
     case SPV_OPERAND_TYPE_LITERAL_STRING: {
-      stream_ << "\"";
+      Emit('"');
       SetGreen();
       // Strings are always little-endian, and null-terminated.
       // Write out the characters, escaping as needed, and without copying
       // the entire string.
       auto c_str = reinterpret_cast<const char*>(inst.words + operand.offset);
       for (auto p = c_str; *p; ++p) {
-        if (*p == '"' || *p == '\\') stream_ << '\\';
-        stream_ << *p;
+        if (*p == '"' || *p == '\\') Emit('\\');
+        Emit(*p);
       }
       ResetColor();
-      stream_ << '"';
+      Emit('"');
     } break;
     case SPV_OPERAND_TYPE_CAPABILITY:
     case SPV_OPERAND_TYPE_SOURCE_LANGUAGE:
@@ -330,7 +481,7 @@ void Disassembler::EmitOperand(const spv_parsed_instruction_t& inst,
       spv_operand_desc entry;
       if (grammar_.lookupOperand(operand.type, word, &entry))
         assert(false && "should have caught this earlier");
-      stream_ << entry->name;
+      Emit(entry->name);
     } break;
     case SPV_OPERAND_TYPE_FP_FAST_MATH_MODE:
     case SPV_OPERAND_TYPE_FUNCTION_CONTROL:
@@ -361,8 +512,8 @@ void Disassembler::EmitMaskOperand(const spv_operand_type_t type,
       spv_operand_desc entry;
       if (grammar_.lookupOperand(type, mask, &entry))
         assert(false && "should have caught this earlier");
-      if (num_emitted) stream_ << "|";
-      stream_ << entry->name;
+      if (num_emitted) Emit('|');
+      Emit(entry->name);
       num_emitted++;
     }
   }
@@ -371,16 +522,94 @@ void Disassembler::EmitMaskOperand(const spv_operand_type_t type,
     // of the 0 value. In many cases, that's "None".
     spv_operand_desc entry;
     if (SPV_SUCCESS == grammar_.lookupOperand(type, 0, &entry))
-      stream_ << entry->name;
+      Emit(entry->name);
+  }
+}
+
+void Disassembler::EmitNumericLiteral(const spv_parsed_instruction_t& inst,
+                                      const spv_parsed_operand_t& operand) {
+  if (operand.number_kind == SPV_NUMBER_FLOATING) {
+    float_text_.str(std::string());
+    spvtools::EmitNumericLiteral(&float_text_, inst, operand);
+    text_.append(float_text_.str());
+    return;
+  }
+  // TODO(dneto): Support more than 64-bits at a time.
+  if (operand.num_words < 1 || operand.num_words > 2) return;
+
+  // Multi-word numbers are presented with lower order words first.
+  uint64_t bits = inst.words[operand.offset];
+  if (operand.num_words == 2)
+    bits |= uint64_t(inst.words[operand.offset + 1]) << 32;
+  switch (operand.number_kind) {
+    case SPV_NUMBER_SIGNED_INT:
+      EmitSigned(operand.num_words == 1 ? int32_t(bits) : int64_t(bits));
+      break;
+    case SPV_NUMBER_UNSIGNED_INT:
+      EmitUnsigned(bits);
+      break;
+    default:
+      break;
   }
 }
 
+void Disassembler::EmitUnsigned(uint64_t value) {
+  char digits[20];
+  char* end = digits + sizeof(digits);
+  char* p = end;
+  do {
+    *--p = char('0' + value % 10);
+    value /= 10;
+  } while (value);
+  Emit(p, size_t(end - p));
+}
+
+void Disassembler::EmitSigned(int64_t value) {
+  if (value < 0) {
+    Emit('-');
+    // Negate after converting, so that the most negative value works too.
+    EmitUnsigned(0 - uint64_t(value));
+  } else {
+    EmitUnsigned(uint64_t(value));
+  }
+}
+
+void Disassembler::EmitHex(uint64_t value, int min_digits) {
+  char digits[16];
+  char* end = digits + sizeof(digits);
+  char* p = end;
+  do {
+    *--p = "0123456789abcdef"[value & 0xf];
+    value >>= 4;
+  } while (value);
+  for (int n = int(end - p); n < min_digits; ++n) Emit('0');
+  Emit(p, size_t(end - p));
+}
+
+void Disassembler::GetIdName(uint32_t id, const char** name,
+                             size_t* length) {
+  if (id >= id_names_.size()) {
+    uncached_id_name_ = name_mapper_(id);
+    *name = uncached_id_name_.data();
+    *length = uncached_id_name_.size();
+    return;
+  }
+  IdName& id_name = id_names_[id];
+  if (!id_name.cached) {
+    const std::string mapped = name_mapper_(id);
+    id_name = {id_names_text_.size(), uint32_t(mapped.size()), true};
+    id_names_text_.append(mapped);
+  }
+  *name = id_names_text_.data() + id_name.offset;
+  *length = id_name.length;
+}
+
 spv_result_t Disassembler::SaveTextResult(spv_text* text_result) const {
   if (!print_) {
-    size_t length = text_.str().size();
+    size_t length = text_.size();
     char* str = new char[length + 1];
     if (!str) return SPV_ERROR_OUT_OF_MEMORY;
-    strncpy(str, text_.str().c_str(), length + 1);
+    memcpy(str, text_.c_str(), length + 1);
     spv_text text = new spv_text_t();
     if (!text) {
       delete[] str;
@@ -410,6 +639,154 @@ spv_result_t DisassembleInstruction(
   return disassembler->HandleInstruction(*parsed_instruction);
 }
 
+// The minimum number of words of function bodies worth disassembling on
+// another thread.
+const size_t kMinParallelChunkWords = 16 * 1024;
+
+// Disassembles a module on several threads.  The instructions before the
+// first OpFunction are handed to the main Disassembler as they are parsed.
+// The rest are recorded, and then disassembled in chunks of whole functions,
+// each chunk into its own buffer, and the buffers are appended in module
+// order.  Parsing stays serial, since it tracks the types of ids and the
+// extended instruction sets imported.
+class ParallelDisassembler {
+ public:
+  explicit ParallelDisassembler(Disassembler* disassembler)
+      : disassembler_(disassembler) {}
+
+  spv_result_t HandleHeader(spv_endianness_t endian, uint32_t version,
+                            uint32_t generator, uint32_t id_bound,
+                            uint32_t schema) {
+    return disassembler_->HandleHeader(endian, version, generator, id_bound,
+                                       schema);
+  }
+
+  // Disassembles the instruction now if it comes before the first function,
+  // or records it for later.
+  spv_result_t HandleInstruction(const spv_parsed_instruction_t& inst);
+
+  // Disassembles the recorded instructions on up to |num_threads| threads,
+  // with each thread's Disassembler made with the given arguments, and
+  // appends their text to the main Disassembler's.
+  void DisassembleFunctions(const spvtools::AssemblyGrammar& grammar,
+                            uint32_t options,
+                            const spvtools::NameMapper& name_mapper,
+                            size_t num_words, size_t num_threads);
+
+ private:
+  // A recorded instruction.  Its words and operands pointers are not set;
+  // they are at the given offsets in words_ and operands_ instead.
+  struct RecordedInstruction {
+    spv_parsed_instruction_t inst;
+    size_t words_offset;
+    size_t operands_offset;
+  };
+
+  // The start of a chunk of instructions to disassemble on one thread.
+  struct Chunk {
+    size_t first_instruction;  // The index into instructions_.
+    Disassembler::Progress progress;
+  };
+
+  Disassembler* disassembler_;
+  std::vector<RecordedInstruction> instructions_;
+  std::vector<uint32_t> words_;
+  std::vector<spv_parsed_operand_t> operands_;
+};
+
+spv_result_t ParallelDisassembler::HandleInstruction(
+    const spv_parsed_instruction_t& inst) {
+  if (instructions_.empty() && inst.opcode != SpvOpFunction)
+    return disassembler_->HandleInstruction(inst);
+
+  // The parser reuses the storage inst points to, so copy it.
+  instructions_.push_back({inst, words_.size(), operands_.size()});
+  instructions_.back().inst.words = nullptr;
+  instructions_.back().inst.operands = nullptr;
+  words_.insert(words_.end(), inst.words, inst.words + inst.num_words);
+  operands_.insert(operands_.end(), inst.operands,
+                   inst.operands + inst.num_operands);
+  return SPV_SUCCESS;
+}
+
+void ParallelDisassembler::DisassembleFunctions(
+    const spvtools::AssemblyGrammar& grammar, uint32_t options,
+    const spvtools::NameMapper& name_mapper, size_t num_words,
+    size_t num_threads) {
+  if (instructions_.empty()) return;
+
+  // Split the function bodies into a few chunks per thread, for balance,
+  // and work out where each chunk's disassembly starts from.
+  const size_t chunk_size =
+      std::max(kMinParallelChunkWords, words_.size() / (4 * num_threads));
+  std::vector<Chunk> chunks;
+  Disassembler::Progress progress = disassembler_->progress();
+  for (size_t i = 0; i < instructions_.size(); ++i) {
+    const RecordedInstruction& recorded = instructions_[i];
+    if (recorded.inst.opcode == SpvOpFunction &&
+        (chunks.empty() ||
+         recorded.words_offset -
+                 instructions_[chunks.back().first_instruction].words_offset >=
+             chunk_size)) {
+      chunks.push_back({i, progress});
+    }
+    progress.Skip(recorded.inst);
+  }
+
+  // Each worker claims the next chunk until none are left.  The workers only
+  // buffer their text, which the main Disassembler prints if need be.
+  std::vector<std::string> chunk_text(chunks.size());
+  std::atomic<size_t> next_chunk(0);
+  const uint32_t worker_options =
+      options & ~uint32_t(SPV_BINARY_TO_TEXT_OPTION_PRINT);
+  auto worker = [&]() {
+    Disassembler disassembler(grammar, worker_options, name_mapper,
+                              num_words);
+    for (size_t i = next_chunk++; i < chunks.size(); i = next_chunk++) {
+      disassembler.Resume(*disassembler_, chunks[i].progress);
+      const size_t end = i + 1 < chunks.size()
+                             ? chunks[i + 1].first_instruction
+                             : instructions_.size();
+      for (size_t j = chunks[i].first_instruction; j < end; ++j) {
+        spv_parsed_instruction_t inst = instructions_[j].inst;
+        inst.words = words_.data() + instructions_[j].words_offset;
+        inst.operands = operands_.data() + instructions_[j].operands_offset;
+        disassembler.HandleInstruction(inst);
+      }
+      disassembler.TakeText(&chunk_text[i]);
+    }
+  };
+  // The calling thread is one of the workers.
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < std::min(num_threads, chunks.size()); ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (auto& thread : threads) thread.join();
+
+  for (auto& text : chunk_text) {
+    disassembler_->EmitText(text);
+    std::string().swap(text);
+  }
+}
+
+spv_result_t DisassembleParallelHeader(void* user_data,
+                                       spv_endianness_t endian,
+                                       uint32_t /* magic */, uint32_t version,
+                                       uint32_t generator, uint32_t id_bound,
+                                       uint32_t schema) {
+  assert(user_data);
+  auto disassembler = static_cast<ParallelDisassembler*>(user_data);
+  return disassembler->HandleHeader(endian, version, generator, id_bound,
+                                    schema);
+}
+
+spv_result_t DisassembleParallelInstruction(
+    void* user_data, const spv_parsed_instruction_t* parsed_instruction) {
+  assert(user_data);
+  auto disassembler = static_cast<ParallelDisassembler*>(user_data);
+  return disassembler->HandleInstruction(*parsed_instruction);
+}
+
 // Simple wrapper class to provide extra data necessary for targeted
 // instruction disassembly.
 class WrappedDisassembler {
@@ -481,7 +858,29 @@ spv_result_t spvBinaryToText(const spv_const_context context,
   }
 
   // Now disassemble!
-  Disassembler disassembler(grammar, options, name_mapper);
+  Disassembler disassembler(grammar, options, name_mapper, wordCount);
+
+  // Printing in color may set the console's color as the text is printed, so
+  // that is done serially.  On a single hardware thread, the chunks are
+  // disassembled on the calling thread.
+  if ((options & SPV_BINARY_TO_TEXT_OPTION_PARALLEL) &&
+      !((options & SPV_BINARY_TO_TEXT_OPTION_PRINT) &&
+        (options & SPV_BINARY_TO_TEXT_OPTION_COLOR))) {
+    const size_t num_threads =
+        std::max<size_t>(1, std::thread::hardware_concurrency());
+    ParallelDisassembler parallel(&disassembler);
+    const spv_result_t error = spvBinaryParse(
+        &hijack_context, &parallel, code, wordCount, DisassembleParallelHeader,
+        DisassembleParallelInstruction, pDiagnostic);
+    // Like the serial path, print the instructions parsed before an error.
+    if (error == SPV_SUCCESS || (options & SPV_BINARY_TO_TEXT_OPTION_PRINT)) {
+      parallel.DisassembleFunctions(grammar, options, name_mapper, wordCount,
+                                    num_threads);
+    }
+    if (error) return error;
+    return disassembler.SaveTextResult(pText);
+  }
+
   if (auto error = spvBinaryParse(&hijack_context, &disassembler, code,
                                   wordCount, DisassembleHeader,
                                   DisassembleInstruction, pDiagnostic)) {
@@ -514,7 +913,7 @@ std::string spvtools::spvInstructionBinaryToText(const spv_target_env env,
   }
 
   // Now disassemble!
-  Disassembler disassembler(grammar, options, name_mapper);
+  Disassembler disassembler(grammar, options, name_mapper, wordCount);
   WrappedDisassembler wrapped(&disassembler, instCode, instWordCount);
   spvBinaryParse(context, &wrapped, code, wordCount, DisassembleTargetHeader,
                  DisassembleTargetInstruction, nullptr);
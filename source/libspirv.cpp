@@ -14,12 +14,14 @@
 
 #include "spirv-tools/libspirv.hpp"
 
+#include <algorithm>
 #include <iostream>
 
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "source/spirv_validator_options.h"
 #include "source/table.h"
 
 namespace spvtools {
@@ -104,6 +106,29 @@ bool SpirvTools::Disassemble(const uint32_t* binary, const size_t binary_size,
   return status == SPV_SUCCESS;
 }
 
+bool SpirvTools::Index(const std::vector<uint32_t>& binary,
+                       BinaryIndex* index) const {
+  return Index(binary.data(), binary.size(), index);
+}
+
+bool SpirvTools::Index(const uint32_t* binary, const size_t binary_size,
+                       BinaryIndex* index) const {
+  spv_binary_index spvindex = nullptr;
+  spv_result_t status =
+      spvBinaryParseWithIndex(impl_->context, nullptr, binary, binary_size,
+                              nullptr, nullptr, &spvindex, nullptr);
+  if (status == SPV_SUCCESS) {
+    std::copy(spvindex->sections, spvindex->sections + SPV_BINARY_SECTION_COUNT,
+              index->sections);
+    index->functions.assign(spvindex->functions,
+                            spvindex->functions + spvindex->num_functions);
+    index->labels.assign(spvindex->labels,
+                         spvindex->labels + spvindex->num_labels);
+  }
+  spvBinaryIndexDestroy(spvindex);
+  return status == SPV_SUCCESS;
+}
+
 bool SpirvTools::Validate(const std::vector<uint32_t>& binary) const {
   return Validate(binary.data(), binary.size());
 }
@@ -128,6 +153,38 @@ bool SpirvTools::Validate(const uint32_t* binary, const size_t binary_size,
   return valid;
 }
 
+bool SpirvTools::Validate(const std::vector<std::vector<uint32_t>>& binaries,
+                          spv_validator_options options, size_t num_threads,
+                          std::vector<std::string>* messages) const {
+  std::vector<spv_const_binary_t> the_binaries;
+  the_binaries.reserve(binaries.size());
+  for (const auto& binary : binaries) {
+    the_binaries.push_back({binary.data(), binary.size()});
+  }
+  std::vector<spv_result_t> results(binaries.size());
+  std::vector<spv_diagnostic> diagnostics(binaries.size(), nullptr);
+  bool valid =
+      spvValidateBinaries(impl_->context, options, the_binaries.data(),
+                          the_binaries.size(), num_threads, results.data(),
+                          diagnostics.data()) == SPV_SUCCESS;
+  if (messages) messages->assign(binaries.size(), std::string());
+  for (size_t i = 0; i < diagnostics.size(); ++i) {
+    spv_diagnostic diagnostic = diagnostics[i];
+    if (!diagnostic) continue;
+    // As for a single binary, only the issues of invalid binaries are
+    // reported.
+    if (results[i] != SPV_SUCCESS) {
+      if (messages) (*messages)[i] = diagnostic->error;
+      if (impl_->context->consumer) {
+        impl_->context->consumer.operator()(
+            SPV_MSG_ERROR, nullptr, diagnostic->position, diagnostic->error);
+      }
+    }
+    spvDiagnosticDestroy(diagnostic);
+  }
+  return valid;
+}
+
 bool SpirvTools::IsValid() const { return impl_->context != nullptr; }
 
 }  // namespace spvtools
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <iterator>
 #include <sstream>
 #include <string>
@@ -26,6 +27,7 @@
 
 #include "source/latest_version_spirv_header.h"
 #include "source/parsed_operand.h"
+#include "source/util/make_unique.h"
 
 namespace spvtools {
 namespace {
@@ -46,15 +48,45 @@ NameMapper GetTrivialNameMapper() { return to_string; }
 FriendlyNameMapper::FriendlyNameMapper(const spv_const_context context,
                                        const uint32_t* code,
                                        const size_t wordCount)
-    : grammar_(AssemblyGrammar(context)) {
+    : num_words_(wordCount),
+      names_made_(MakeUnique<std::once_flag>()),
+      grammar_(AssemblyGrammar(context)) {
   spv_diagnostic diag = nullptr;
   // We don't care if the parse fails.
-  spvBinaryParse(context, this, code, wordCount, nullptr,
-                 ParseInstructionForwarder, &diag);
+  spvBinaryParse(context, this, code, wordCount, RecordHeaderForwarder,
+                 RecordInstructionForwarder, &diag);
   spvDiagnosticDestroy(diag);
+  if (needs_all_ids_) {
+    // Name every defined id as the module is parsed instead.
+    recorded_.clear();
+    recorded_words_.clear();
+    recorded_operands_.clear();
+    diag = nullptr;
+    spvBinaryParse(context, this, code, wordCount, nullptr,
+                   ParseInstructionForwarder, &diag);
+    spvDiagnosticDestroy(diag);
+  }
+  std::vector<bool>().swap(defined_ids_);
 }
 
 std::string FriendlyNameMapper::NameForId(uint32_t id) {
+  std::call_once(*names_made_, [this]() { MakeNames(); });
+  return SavedNameForId(id);
+}
+
+void FriendlyNameMapper::MakeNames() {
+  for (const auto& recorded : recorded_) {
+    spv_parsed_instruction_t inst = recorded.inst;
+    inst.words = recorded_words_.data() + recorded.words_offset;
+    inst.operands = recorded_operands_.data() + recorded.operands_offset;
+    ParseInstruction(inst);
+  }
+  std::vector<RecordedInstruction>().swap(recorded_);
+  std::vector<uint32_t>().swap(recorded_words_);
+  std::vector<spv_parsed_operand_t>().swap(recorded_operands_);
+}
+
+std::string FriendlyNameMapper::SavedNameForId(uint32_t id) {
   auto iter = name_for_id_.find(id);
   if (iter == name_for_id_.end()) {
     // It must have been an invalid module, so just return a trivial mapping.
@@ -235,25 +267,26 @@ spv_result_t FriendlyNameMapper::ParseInstruction(
     } break;
     case SpvOpTypeVector:
       SaveName(result_id, std::string("v") + to_string(inst.words[3]) +
-                              NameForId(inst.words[2]));
+                              SavedNameForId(inst.words[2]));
       break;
     case SpvOpTypeMatrix:
       SaveName(result_id, std::string("mat") + to_string(inst.words[3]) +
-                              NameForId(inst.words[2]));
+                              SavedNameForId(inst.words[2]));
       break;
     case SpvOpTypeArray:
-      SaveName(result_id, std::string("_arr_") + NameForId(inst.words[2]) +
-                              "_" + NameForId(inst.words[3]));
+      SaveName(result_id, std::string("_arr_") +
+                              SavedNameForId(inst.words[2]) + "_" +
+                              SavedNameForId(inst.words[3]));
       break;
     case SpvOpTypeRuntimeArray:
       SaveName(result_id,
-               std::string("_runtimearr_") + NameForId(inst.words[2]));
+               std::string("_runtimearr_") + SavedNameForId(inst.words[2]));
       break;
     case SpvOpTypePointer:
       SaveName(result_id, std::string("_ptr_") +
                               NameForEnumOperand(SPV_OPERAND_TYPE_STORAGE_CLASS,
                                                  inst.words[2]) +
-                              "_" + NameForId(inst.words[3]));
+                              "_" + SavedNameForId(inst.words[3]));
       break;
     case SpvOpTypePipe:
       SaveName(result_id,
@@ -303,7 +336,7 @@ spv_result_t FriendlyNameMapper::ParseInstruction(
       // to underscore.
       for (auto& c : value_str)
         if (c == '-') c = 'n';
-      SaveName(result_id, NameForId(inst.type_id) + "_" + value_str);
+      SaveName(result_id, SavedNameForId(inst.type_id) + "_" + value_str);
     } break;
     default:
       // If this instruction otherwise defines an Id, then save a mapping for
@@ -318,6 +351,86 @@ spv_result_t FriendlyNameMapper::ParseInstruction(
   return SPV_SUCCESS;
 }
 
+spv_result_t FriendlyNameMapper::RecordHeaderForwarder(
+    void* user_data, spv_endianness_t, uint32_t, uint32_t, uint32_t,
+    uint32_t id_bound, uint32_t) {
+  auto mapper = reinterpret_cast<FriendlyNameMapper*>(user_data);
+  // Every id defined in a valid module takes at least two words, so this
+  // bounds the memory spent on a bogus id bound.
+  mapper->defined_ids_.assign(std::min<size_t>(id_bound, mapper->num_words_),
+                              false);
+  return SPV_SUCCESS;
+}
+
+spv_result_t FriendlyNameMapper::RecordInstruction(
+    const spv_parsed_instruction_t& inst) {
+  // Ids without a friendly name are named by their number, which can't be
+  // taken by a friendly name, so they need not be named in order with the
+  // others.  That is not so for an id defined more than once, which keeps
+  // the name from its first definition, or defined beyond the bound, which
+  // can't be tracked.
+  const auto result_id = inst.result_id;
+  if (result_id) {
+    if (result_id >= defined_ids_.size() || defined_ids_[result_id]) {
+      needs_all_ids_ = true;
+      return SPV_REQUESTED_TERMINATION;
+    }
+    defined_ids_[result_id] = true;
+  }
+
+  // Keep this in sync with the cases in ParseInstruction.
+  switch (inst.opcode) {
+    case SpvOpName: {
+      // A debug name made of digits could be the number of another id.
+      const char* name = reinterpret_cast<const char*>(inst.words + 2);
+      if (*name && std::all_of(name, name + strlen(name), [](const char c) {
+            return c >= '0' && c <= '9';
+          })) {
+        needs_all_ids_ = true;
+        return SPV_REQUESTED_TERMINATION;
+      }
+    } break;
+    case SpvOpDecorate:
+      if (inst.words[2] != SpvDecorationBuiltIn) return SPV_SUCCESS;
+      break;
+    case SpvOpTypeVoid:
+    case SpvOpTypeBool:
+    case SpvOpTypeInt:
+    case SpvOpTypeFloat:
+    case SpvOpTypeVector:
+    case SpvOpTypeMatrix:
+    case SpvOpTypeArray:
+    case SpvOpTypeRuntimeArray:
+    case SpvOpTypePointer:
+    case SpvOpTypePipe:
+    case SpvOpTypeEvent:
+    case SpvOpTypeDeviceEvent:
+    case SpvOpTypeReserveId:
+    case SpvOpTypeQueue:
+    case SpvOpTypeOpaque:
+    case SpvOpTypePipeStorage:
+    case SpvOpTypeNamedBarrier:
+    case SpvOpTypeStruct:
+    case SpvOpConstantTrue:
+    case SpvOpConstantFalse:
+    case SpvOpConstant:
+      break;
+    default:
+      return SPV_SUCCESS;
+  }
+
+  // The parser reuses the storage inst points to, so copy it.
+  recorded_.push_back(
+      {inst, recorded_words_.size(), recorded_operands_.size()});
+  recorded_.back().inst.words = nullptr;
+  recorded_.back().inst.operands = nullptr;
+  recorded_words_.insert(recorded_words_.end(), inst.words,
+                         inst.words + inst.num_words);
+  recorded_operands_.insert(recorded_operands_.end(), inst.operands,
+                            inst.operands + inst.num_operands);
+  return SPV_SUCCESS;
+}
+
 std::string FriendlyNameMapper::NameForEnumOperand(spv_operand_type_t type,
                                                    uint32_t word) {
   spv_operand_desc desc = nullptr;
@@ -16,9 +16,12 @@
 #define SOURCE_NAME_MAPPER_H_
 
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "source/assembly_grammar.h"
 #include "spirv-tools/libspirv.h"
@@ -59,11 +62,16 @@ NameMapper GetTrivialNameMapper();
 //    pretty simplistic, but workable.
 //  - A built-in variable maps to its GLSL variable name.
 //  - Numeric literals in OpConstant map to a human-friendly name.
+//
+// The names are made on the first call to NameForId, from a copy of the few
+// instructions that give friendly names, taken during construction.  Most
+// Ids in a large module are only named by their number, so no name is stored
+// for them at all.
 class FriendlyNameMapper {
  public:
-  // Construct a friendly name mapper, and determine friendly names for each
-  // defined Id in the specified module.  The module is specified by the code
-  // wordCount, and should be parseable in the specified context.
+  // Construct a friendly name mapper for the specified module.  The module is
+  // specified by the code wordCount, and should be parseable in the specified
+  // context.  The code is not used after construction.
   FriendlyNameMapper(const spv_const_context context, const uint32_t* code,
                      const size_t wordCount);
 
@@ -75,10 +83,26 @@ class FriendlyNameMapper {
 
   // Returns the friendly name for the given id.  If the module parsed during
   // construction is valid, then the mapping satisfies the rules for a
-  // NameMapper.
+  // NameMapper.  This may be called on several threads at once.
   std::string NameForId(uint32_t id);
 
  private:
+  // An instruction recorded during construction, to make names from later.
+  // Its words and operands pointers are not set; they are at the given
+  // offsets in recorded_words_ and recorded_operands_ instead.
+  struct RecordedInstruction {
+    spv_parsed_instruction_t inst;
+    size_t words_offset;
+    size_t operands_offset;
+  };
+
+  // Returns the name saved for the given id so far, or its number if there
+  // is none.
+  std::string SavedNameForId(uint32_t id);
+
+  // Makes the names of the ids from the recorded instructions.
+  void MakeNames();
+
   // Transforms the given string so that it is acceptable as an Id name in
   // assembly language.  Two distinct inputs can map to the same output.
   std::string Sanitize(const std::string& suggested_name);
@@ -97,6 +121,12 @@ class FriendlyNameMapper {
   // name_for_id_.  Returns SPV_SUCCESS;
   spv_result_t ParseInstruction(const spv_parsed_instruction_t& inst);
 
+  // Records the given parsed instruction if it gives an id a friendly name.
+  // Returns SPV_REQUESTED_TERMINATION, and sets needs_all_ids_, if names
+  // can't be made from the recorded instructions alone.  Otherwise returns
+  // SPV_SUCCESS.
+  spv_result_t RecordInstruction(const spv_parsed_instruction_t& inst);
+
   // Forwards a parsed-instruction callback from the binary parser into the
   // FriendlyNameMapper hidden inside the user_data parameter.
   static spv_result_t ParseInstructionForwarder(
@@ -105,11 +135,39 @@ class FriendlyNameMapper {
         *parsed_instruction);
   }
 
+  // Forwards the parser's callbacks to RecordInstruction, and the id bound in
+  // the module's header to defined_ids_.
+  static spv_result_t RecordHeaderForwarder(void* user_data, spv_endianness_t,
+                                            uint32_t, uint32_t, uint32_t,
+                                            uint32_t id_bound, uint32_t);
+  static spv_result_t RecordInstructionForwarder(
+      void* user_data, const spv_parsed_instruction_t* parsed_instruction) {
+    return reinterpret_cast<FriendlyNameMapper*>(user_data)->RecordInstruction(
+        *parsed_instruction);
+  }
+
   // Returns the friendly name for an enumerant.
   std::string NameForEnumOperand(spv_operand_type_t type, uint32_t word);
 
-  // Maps an id to its friendly name.  This will have an entry for each Id
-  // defined in the module.
+  // The number of words in the module, which limits the size of
+  // defined_ids_.
+  size_t num_words_;
+  // Whether each id has been defined so far while recording, indexed by id.
+  std::vector<bool> defined_ids_;
+  // Set if an id might be named differently unless every defined id is
+  // named in order, in which case the module is parsed again to do that.
+  bool needs_all_ids_ = false;
+  // The instructions that give friendly names, in module order.
+  std::vector<RecordedInstruction> recorded_;
+  std::vector<uint32_t> recorded_words_;
+  std::vector<spv_parsed_operand_t> recorded_operands_;
+  // Makes sure that the names are made only once.  Held by pointer so that
+  // the mapper can be moved.
+  std::unique_ptr<std::once_flag> names_made_;
+
+  // Maps an id to its friendly name.  Once the names are made, this has an
+  // entry for each Id defined in the module, other than those named by their
+  // number.
   std::unordered_map<uint32_t, std::string> name_for_id_;
   // The set of names that have a mapping in name_for_id_;
   std::unordered_set<std::string> used_names_;
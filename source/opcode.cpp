@@ -38,7 +38,8 @@ struct OpcodeDescPtrLen {
 #include "core.insts-unified1.inc"
 
 static const spv_opcode_table_t kOpcodeTable = {ARRAY_SIZE(kOpcodeTableEntries),
-                                                kOpcodeTableEntries};
+                                                kOpcodeTableEntries,
+                                                kOpcodeTableNameIndex};
 
 // Represents a vendor tool entry in the SPIR-V XML Regsitry.
 struct VendorTool {
@@ -95,13 +96,18 @@ spv_result_t spvOpcodeTableNameLookup(spv_target_env env,
   if (!name || !pEntry) return SPV_ERROR_INVALID_POINTER;
   if (!table) return SPV_ERROR_INVALID_TABLE;
 
-  // TODO: This lookup of the Opcode table is suboptimal! Binary sort would be
-  // preferable but the table requires sorting on the Opcode name, but it's
-  // static const initialized and matches the order of the spec.
-  const size_t nameLength = strlen(name);
+  // The table is ordered by opcode, so search its name index instead.  Entries
+  // sharing a name are visited in table order.
   const auto version = spvVersionForTargetEnv(env);
-  for (uint64_t opcodeIndex = 0; opcodeIndex < table->count; ++opcodeIndex) {
-    const spv_opcode_desc_t& entry = table->entries[opcodeIndex];
+  const uint16_t* const indexEnd = table->name_index + table->count;
+  const uint16_t* indexIter = std::lower_bound(
+      table->name_index, indexEnd, name,
+      [table](uint16_t opcodeIndex, const char* searchName) {
+        return strcmp(table->entries[opcodeIndex].name, searchName) < 0;
+      });
+  for (; indexIter != indexEnd; ++indexIter) {
+    const spv_opcode_desc_t& entry = table->entries[*indexIter];
+    if (strcmp(name, entry.name)) break;
     // We considers the current opcode as available as long as
     // 1. The target environment satisfies the minimal requirement of the
     //    opcode; or
@@ -110,10 +116,8 @@ spv_result_t spvOpcodeTableNameLookup(spv_target_env env,
     // Note that the second rule assumes the extension enabling this instruction
     // is indeed requested in the SPIR-V code; checking that should be
     // validator's work.
-    if (((version >= entry.minVersion && version <= entry.lastVersion) ||
-         entry.numExtensions > 0u || entry.numCapabilities > 0u) &&
-        nameLength == strlen(entry.name) &&
-        !strncmp(name, entry.name, nameLength)) {
+    if ((version >= entry.minVersion && version <= entry.lastVersion) ||
+        entry.numExtensions > 0u || entry.numCapabilities > 0u) {
       // NOTE: Found out Opcode!
       *pEntry = &entry;
       return SPV_SUCCESS;
@@ -47,6 +47,16 @@ spv_result_t spvOperandTableGet(spv_operand_table* pOperandTable,
   return SPV_SUCCESS;
 }
 
+// Compares the first nameLength characters of name with the null-terminated
+// entryName, with the same result sign as strcmp(entryName, name) would have
+// if name were null-terminated after nameLength characters.
+static int spvOperandNameCompare(const char* entryName, const char* name,
+                                 size_t nameLength) {
+  const int result = strncmp(entryName, name, nameLength);
+  if (result) return result;
+  return entryName[nameLength] == '\0' ? 0 : 1;
+}
+
 spv_result_t spvOperandTableNameLookup(spv_target_env env,
                                        const spv_operand_table table,
                                        const spv_operand_type_t type,
@@ -60,8 +70,18 @@ spv_result_t spvOperandTableNameLookup(spv_target_env env,
   for (uint64_t typeIndex = 0; typeIndex < table->count; ++typeIndex) {
     const auto& group = table->types[typeIndex];
     if (type != group.type) continue;
-    for (uint64_t index = 0; index < group.count; ++index) {
-      const auto& entry = group.entries[index];
+    // Search the name index.  Entries sharing a name are visited in the order
+    // they appear in the group.
+    const uint16_t* const indexEnd = group.name_index + group.count;
+    const uint16_t* indexIter = std::lower_bound(
+        group.name_index, indexEnd, name,
+        [&group, nameLength](uint16_t index, const char* searchName) {
+          return spvOperandNameCompare(group.entries[index].name, searchName,
+                                       nameLength) < 0;
+        });
+    for (; indexIter != indexEnd; ++indexIter) {
+      const auto& entry = group.entries[*indexIter];
+      if (spvOperandNameCompare(entry.name, name, nameLength)) break;
       // We consider the current operand as available as long as
       // 1. The target environment satisfies the minimal requirement of the
       //    operand; or
@@ -71,10 +91,8 @@ spv_result_t spvOperandTableNameLookup(spv_target_env env,
       // Note that the second rule assumes the extension enabling this operand
       // is indeed requested in the SPIR-V code; checking that should be
       // validator's work.
-      if (((version >= entry.minVersion && version <= entry.lastVersion) ||
-           entry.numExtensions > 0u || entry.numCapabilities > 0u) &&
-          nameLength == strlen(entry.name) &&
-          !strncmp(entry.name, name, nameLength)) {
+      if ((version >= entry.minVersion && version <= entry.lastVersion) ||
+          entry.numExtensions > 0u || entry.numCapabilities > 0u) {
         *pEntry = &entry;
         return SPV_SUCCESS;
       }
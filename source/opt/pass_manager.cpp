@@ -16,6 +16,7 @@
 
 #include <iostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "source/opt/ir_context.h"
@@ -43,6 +44,11 @@ Pass::Status PassManager::Run(IRContext* context) {
     }
   };
 
+  // The last module that was validated, so that a module that the passes
+  // leave byte-identical is not validated again.  The pass status is not
+  // trusted for this, since a pass may change the module without saying so.
+  std::vector<uint32_t> validated_binary;
+
   SPIRV_TIMER_DESCRIPTION(time_report_stream_, /* measure_mem_usage = */ true);
   for (auto& pass : passes_) {
     print_disassembly("; IR before pass ", pass.get());
@@ -52,16 +58,19 @@ Pass::Status PassManager::Run(IRContext* context) {
     if (one_status == Pass::Status::SuccessWithChange) status = one_status;
 
     if (validate_after_all_) {
-      spvtools::SpirvTools tools(target_env_);
-      tools.SetMessageConsumer(consumer());
       std::vector<uint32_t> binary;
       context->module()->ToBinary(&binary, true);
-      if (!tools.Validate(binary.data(), binary.size(), val_options_)) {
-        std::string msg = "Validation failed after pass ";
-        msg += pass->name();
-        spv_position_t null_pos{0, 0, 0};
-        consumer()(SPV_MSG_INTERNAL_ERROR, "", null_pos, msg.c_str());
-        return Pass::Status::Failure;
+      if (binary != validated_binary) {
+        spvtools::SpirvTools tools(target_env_);
+        tools.SetMessageConsumer(consumer());
+        if (!tools.Validate(binary.data(), binary.size(), val_options_)) {
+          std::string msg = "Validation failed after pass ";
+          msg += pass->name();
+          spv_position_t null_pos{0, 0, 0};
+          consumer()(SPV_MSG_INTERNAL_ERROR, "", null_pos, msg.c_str());
+          return Pass::Status::Failure;
+        }
+        validated_binary = std::move(binary);
       }
     }
 
@@ -104,7 +104,9 @@ class PassManager {
     return *this;
   }
 
-  // Sets the option to validate after each pass.
+  // Sets the option to validate after each pass.  The module is not validated
+  // again after a pass that leaves it byte-identical to the last module that
+  // was validated.
   PassManager& SetValidateAfterAll(bool validate) {
     validate_after_all_ = validate;
     return *this;
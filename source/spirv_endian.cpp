@@ -31,9 +31,16 @@ static const union {
 
 #define I32_ENDIAN_HOST (o32_host_order.value)
 
+// Returns true if words in the given endianness must be byte-swapped to be
+// read on the host.
+static bool spvEndianRequiresSwap(const spv_endianness_t endian) {
+  return (SPV_ENDIANNESS_LITTLE == endian &&
+          I32_ENDIAN_HOST == I32_ENDIAN_BIG) ||
+         (SPV_ENDIANNESS_BIG == endian && I32_ENDIAN_HOST == I32_ENDIAN_LITTLE);
+}
+
 uint32_t spvFixWord(const uint32_t word, const spv_endianness_t endian) {
-  if ((SPV_ENDIANNESS_LITTLE == endian && I32_ENDIAN_HOST == I32_ENDIAN_BIG) ||
-      (SPV_ENDIANNESS_BIG == endian && I32_ENDIAN_HOST == I32_ENDIAN_LITTLE)) {
+  if (spvEndianRequiresSwap(endian)) {
     return (word & 0x000000ff) << 24 | (word & 0x0000ff00) << 8 |
            (word & 0x00ff0000) >> 8 | (word & 0xff000000) >> 24;
   }
@@ -41,6 +48,21 @@ uint32_t spvFixWord(const uint32_t word, const spv_endianness_t endian) {
   return word;
 }
 
+void spvFixWords(const uint32_t* words, size_t num_words,
+                 const spv_endianness_t endian, uint32_t* out) {
+  if (!spvEndianRequiresSwap(endian)) {
+    if (out != words) memcpy(out, words, num_words * sizeof(uint32_t));
+    return;
+  }
+  // Keep this loop free of calls and branches so that compilers can turn it
+  // into vector byte shuffles on targets that have them.
+  for (size_t i = 0; i < num_words; ++i) {
+    const uint32_t word = words[i];
+    out[i] = (word & 0x000000ff) << 24 | (word & 0x0000ff00) << 8 |
+             (word & 0x00ff0000) >> 8 | (word & 0xff000000) >> 24;
+  }
+}
+
 uint64_t spvFixDoubleWord(const uint32_t low, const uint32_t high,
                           const spv_endianness_t endian) {
   return (uint64_t(spvFixWord(high, endian)) << 32) | spvFixWord(low, endian);
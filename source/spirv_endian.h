@@ -20,6 +20,14 @@
 // Converts a word in the specified endianness to the host native endianness.
 uint32_t spvFixWord(const uint32_t word, const spv_endianness_t endianness);
 
+// Converts num_words words in the specified endianness to the host native
+// endianness, writing the results to out.  The input and output ranges may be
+// identical, but must not otherwise overlap.  This is equivalent to calling
+// spvFixWord on each word, but decides once whether a swap is needed so the
+// loop body is branch-free.
+void spvFixWords(const uint32_t* words, size_t num_words,
+                 const spv_endianness_t endianness, uint32_t* out);
+
 // Converts a pair of words in the specified endianness to the host native
 // endianness.
 uint64_t spvFixDoubleWord(const uint32_t low, const uint32_t high,
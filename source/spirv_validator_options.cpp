@@ -115,3 +115,17 @@ void spvValidatorOptionsSetSkipBlockLayout(spv_validator_options options,
                                            bool val) {
   options->skip_block_layout = val;
 }
+
+void spvValidatorOptionsSetNumThreads(spv_validator_options options,
+                                      uint32_t num_threads) {
+  options->num_threads = num_threads;
+}
+
+void spvValidatorOptionsSetCache(spv_validator_options options,
+                                 spv_validator_cache cache) {
+  options->cache = cache;
+}
+
+void spvValidatorOptionsSetLowMemory(spv_validator_options options, bool val) {
+  options->low_memory = val;
+}
@@ -46,7 +46,10 @@ struct spv_validator_options_t {
         uniform_buffer_standard_layout(false),
         scalar_block_layout(false),
         skip_block_layout(false),
-        before_hlsl_legalization(false) {}
+        before_hlsl_legalization(false),
+        num_threads(1),
+        cache(nullptr),
+        low_memory(false) {}
 
   validator_universal_limits_t universal_limits_;
   bool relax_struct_store;
@@ -56,6 +59,14 @@ struct spv_validator_options_t {
   bool scalar_block_layout;
   bool skip_block_layout;
   bool before_hlsl_legalization;
+  // The number of threads to spread function checks over.  Zero means one
+  // thread per hardware thread.
+  uint32_t num_threads;
+  // Outcomes of earlier validations to reuse, or null.  Not owned.
+  spv_validator_cache cache;
+  // Whether to keep the validation state small at some cost in speed, and
+  // report how large it got.
+  bool low_memory;
 };
 
 #endif  // SOURCE_SPIRV_VALIDATOR_OPTIONS_H_
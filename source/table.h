@@ -67,6 +67,9 @@ typedef struct spv_operand_desc_group_t {
   const spv_operand_type_t type;
   const uint32_t count;
   const spv_operand_desc_t* entries;
+  // Indices into entries, ordered by entry name.  Entries with the same name
+  // appear in their order in entries.
+  const uint16_t* name_index;
 } spv_operand_desc_group_t;
 
 typedef struct spv_ext_inst_desc_t {
@@ -81,11 +84,16 @@ typedef struct spv_ext_inst_group_t {
   const spv_ext_inst_type_t type;
   const uint32_t count;
   const spv_ext_inst_desc_t* entries;
+  // Indices into entries, ordered by entry name.
+  const uint16_t* name_index;
 } spv_ext_inst_group_t;
 
 typedef struct spv_opcode_table_t {
   const uint32_t count;
   const spv_opcode_desc_t* entries;
+  // Indices into entries, ordered by entry name.  Entries with the same name
+  // appear in their order in entries.
+  const uint16_t* name_index;
 } spv_opcode_table_t;
 
 typedef struct spv_operand_table_t {
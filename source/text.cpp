@@ -15,6 +15,7 @@
 #include "source/text.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cctype>
 #include <cstdio>
@@ -24,6 +25,7 @@
 #include <set>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -589,6 +591,8 @@ spv_result_t spvTextEncodeOpcode(const spvtools::AssemblyGrammar& grammar,
   // own operands depending on the selected extended instruction.
   spv_operand_pattern_t expectedOperands;
   expectedOperands.reserve(opcodeEntry->numTypes);
+  // Reused for each operand, to avoid allocating per word of text.
+  std::string operandValue;
   for (auto i = 0; i < opcodeEntry->numTypes; i++)
     expectedOperands.push_back(
         opcodeEntry->operandTypes[opcodeEntry->numTypes - i - 1]);
@@ -636,7 +640,6 @@ spv_result_t spvTextEncodeOpcode(const spvtools::AssemblyGrammar& grammar,
         }
       }
 
-      std::string operandValue;
       error = context->getWord(&operandValue, &nextPosition);
       if (error) return context->diagnostic(error) << "Internal Error";
 
@@ -679,6 +682,15 @@ spv_result_t spvTextEncodeOpcode(const spvtools::AssemblyGrammar& grammar,
 
 enum { kAssemblerVersion = 0 };
 
+// Prepares |inst| for encoding the next instruction, keeping the storage of
+// its words.
+void ResetInstruction(spv_instruction_t* inst) {
+  inst->opcode = SpvOpNop;
+  inst->extInstType = SPV_EXT_INST_TYPE_NONE;
+  inst->resultTypeId = 0;
+  inst->words.clear();
+}
+
 // Populates a binary stream's |header|. The target environment is specified via
 // |env| and Id bound is via |bound|.
 spv_result_t SetHeader(spv_target_env env, const uint32_t bound,
@@ -712,8 +724,9 @@ spv_result_t GetNumericIds(const spvtools::AssemblyGrammar& grammar,
   // Skip past whitespace and comments.
   context.advance();
 
+  spv_instruction_t inst;
   while (context.hasText()) {
-    spv_instruction_t inst;
+    ResetInstruction(&inst);
 
     if (spvTextEncodeOpcode(grammar, &context, &inst)) {
       return SPV_ERROR_INVALID_TEXT;
@@ -726,6 +739,226 @@ spv_result_t GetNumericIds(const spvtools::AssemblyGrammar& grammar,
   return SPV_SUCCESS;
 }
 
+// Reads the start of the instruction at the position of |context|, up to and
+// including its opcode, without encoding anything.  Writes its result ID,
+// including the '%', to |result_id|, or clears it if there is none.  |word| is
+// scratch space.  Returns SPV_FAILED_MATCH if the instruction does not start
+// with a known opcode, optionally preceded by "<result-id> =".
+spv_result_t ScanOpcode(const spvtools::AssemblyGrammar& grammar,
+                        spvtools::AssemblyContext* context,
+                        std::string* result_id, std::string* word,
+                        spv_opcode_desc* opcode_entry) {
+  spv_position_t next_position = {};
+  result_id->clear();
+  if (!context->startsWithOp()) {
+    if ('%' != context->peek() || context->getWord(result_id, &next_position))
+      return SPV_FAILED_MATCH;
+    context->setPosition(next_position);
+    if (context->advance() || context->getWord(word, &next_position) ||
+        "=" != *word)
+      return SPV_FAILED_MATCH;
+    context->setPosition(next_position);
+    if (context->advance() || !context->startsWithOp()) return SPV_FAILED_MATCH;
+  }
+  if (context->getWord(word, &next_position)) return SPV_FAILED_MATCH;
+  context->setPosition(next_position);
+  if (grammar.lookupOpcode(word->c_str() + 2, opcode_entry))
+    return SPV_FAILED_MATCH;
+  return SPV_SUCCESS;
+}
+
+// Advances |context| past the instruction at its position, assigning ids to
+// the IDs in it in the same order as spvTextEncodeOpcode would, but without
+// encoding it.  Writes its opcode to |opcode|.  |result_id| and |word| are
+// scratch space.  Returns SPV_END_OF_STREAM if there are no more instructions
+// after it.  Returns SPV_FAILED_MATCH if the instruction records a type or an
+// extended instruction import, which only the serial assembler does, or if it
+// is not well formed.
+spv_result_t ScanInstruction(const spvtools::AssemblyGrammar& grammar,
+                             spvtools::AssemblyContext* context,
+                             std::string* result_id, std::string* word,
+                             SpvOp* opcode) {
+  spv_opcode_desc opcode_entry = nullptr;
+  if (ScanOpcode(grammar, context, result_id, word, &opcode_entry))
+    return SPV_FAILED_MATCH;
+  *opcode = opcode_entry->opcode;
+  if (spvOpcodeGeneratesType(*opcode) || SpvOpExtInstImport == *opcode)
+    return SPV_FAILED_MATCH;
+
+  // The <result-id> is encoded after the type id, if there is one.
+  bool result_id_pending = !result_id->empty();
+  if (result_id_pending && !opcode_entry->hasType) {
+    context->spvNamedIdAssignOrGet(result_id->c_str() + 1);
+    result_id_pending = false;
+  }
+  spv_position_t next_position = {};
+  spv_result_t status = SPV_SUCCESS;
+  while (!(status = context->advance()) && !context->isStartOfNewInst()) {
+    if (context->getWord(word, &next_position)) return SPV_FAILED_MATCH;
+    if ('%' == word->front()) {
+      context->spvNamedIdAssignOrGet(word->c_str() + 1);
+    } else if (result_id_pending) {
+      return SPV_FAILED_MATCH;
+    }
+    if (result_id_pending) {
+      context->spvNamedIdAssignOrGet(result_id->c_str() + 1);
+      result_id_pending = false;
+    }
+    context->setPosition(next_position);
+  }
+  return result_id_pending ? SPV_FAILED_MATCH : status;
+}
+
+// Encodes the instructions of the text of |shared| from position |begin| up
+// to text index |end| into |words|, using a context that shares the ids and
+// types of |shared|.  Writes the values the instructions define with a type
+// to |typed_values|.  Returns false if the encoding fails, or if it may differ
+// from the serial encoding of those instructions.
+bool EncodeChunk(const spvtools::AssemblyGrammar& grammar,
+                 const spvtools::AssemblyContext& shared,
+                 const spv_position_t& begin, size_t end,
+                 std::vector<uint32_t>* words,
+                 std::vector<uint32_t>* typed_values) {
+  // Any diagnostic, even a warning, must come from the serial assembler.
+  bool diagnosed = false;
+  spvtools::AssemblyContext context(
+      &shared, [&diagnosed](spv_message_level_t, const char*,
+                            const spv_position_t&, const char*) {
+        diagnosed = true;
+      });
+  context.setPosition(begin);
+  spv_instruction_t inst;
+  while (context.position().index < end) {
+    ResetInstruction(&inst);
+    if (spvTextEncodeOpcode(grammar, &context, &inst) || diagnosed)
+      return false;
+    words->insert(words->end(), inst.words.begin(), inst.words.end());
+
+    if (context.advance()) break;
+  }
+  *typed_values = context.GetTypedValues();
+  return context.position().index == end;
+}
+
+// Function bodies smaller than this are not worth encoding on another thread.
+const size_t kMinParallelChunkSize = 64 * 1024;
+
+}  // anonymous namespace
+
+// The instructions before the first OpFunction declare the types and extended
+// instruction imports that others depend on, so they are encoded serially.
+// Function bodies are first scanned serially, to assign ids in the same order
+// as the serial assembler, and then encoded in chunks of whole functions on
+// several threads.  With a single hardware thread, the chunks are encoded on
+// the calling thread.
+spv_result_t spvtools::EncodeInstructionsInParallel(
+    const AssemblyGrammar& grammar, const spv_text text,
+    std::set<uint32_t>&& ids_to_preserve, std::vector<uint32_t>* words,
+    uint32_t* bound) {
+  const size_t num_threads =
+      std::max<size_t>(1, std::thread::hardware_concurrency());
+
+  bool diagnosed = false;
+  spvtools::AssemblyContext context(
+      text,
+      [&diagnosed](spv_message_level_t, const char*, const spv_position_t&,
+                   const char*) { diagnosed = true; },
+      std::move(ids_to_preserve));
+  spv_instruction_t inst;
+  std::string result_id;
+  std::string word;
+
+  // Skip past whitespace and comments.
+  context.advance();
+
+  bool has_more_instructions = context.hasText();
+  while (has_more_instructions) {
+    const spv_position_t start = context.position();
+    spv_opcode_desc opcode_entry = nullptr;
+    const bool starts_function =
+        !ScanOpcode(grammar, &context, &result_id, &word, &opcode_entry) &&
+        SpvOpFunction == opcode_entry->opcode;
+    context.setPosition(start);
+    if (starts_function) break;
+
+    ResetInstruction(&inst);
+    if (spvTextEncodeOpcode(grammar, &context, &inst) || diagnosed)
+      return SPV_FAILED_MATCH;
+    words->insert(words->end(), inst.words.begin(), inst.words.end());
+
+    has_more_instructions = !context.advance();
+  }
+
+  std::vector<spv_position_t> function_starts;
+  while (has_more_instructions) {
+    const spv_position_t start = context.position();
+    SpvOp opcode = SpvOpNop;
+    const spv_result_t status =
+        ScanInstruction(grammar, &context, &result_id, &word, &opcode);
+    if (status == SPV_FAILED_MATCH || diagnosed) return SPV_FAILED_MATCH;
+    if (SpvOpFunction == opcode) function_starts.push_back(start);
+    has_more_instructions = status == SPV_SUCCESS;
+  }
+  *bound = context.getBound();
+  if (function_starts.empty()) return SPV_SUCCESS;
+
+  // Split the function bodies into a few chunks per thread, for balance.
+  // Each chunk holds whole functions, since an OpSwitch needs the type of its
+  // selector, which is usually defined earlier in the same function.
+  const size_t end = context.position().index;
+  const size_t chunk_size =
+      std::max(kMinParallelChunkSize,
+               (end - function_starts.front().index) / (4 * num_threads));
+  std::vector<spv_position_t> chunk_starts;
+  for (const auto& start : function_starts) {
+    if (chunk_starts.empty() ||
+        start.index - chunk_starts.back().index >= chunk_size) {
+      chunk_starts.push_back(start);
+    }
+  }
+
+  // Each worker claims the next unencoded chunk until none are left.
+  std::vector<std::vector<uint32_t>> chunk_words(chunk_starts.size());
+  std::vector<std::vector<uint32_t>> chunk_typed_values(chunk_starts.size());
+  std::atomic<size_t> next_chunk(0);
+  std::atomic<bool> failed(false);
+  auto worker = [&]() {
+    for (size_t i = next_chunk++; i < chunk_starts.size() && !failed;
+         i = next_chunk++) {
+      const size_t chunk_end =
+          i + 1 < chunk_starts.size() ? chunk_starts[i + 1].index : end;
+      if (!EncodeChunk(grammar, context, chunk_starts[i], chunk_end,
+                       &chunk_words[i], &chunk_typed_values[i])) {
+        failed = true;
+      }
+    }
+  };
+  // The calling thread is one of the workers.
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < std::min(num_threads, chunk_starts.size()); ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (auto& thread : threads) thread.join();
+  if (failed) return SPV_FAILED_MATCH;
+
+  // Each chunk only sees its own definitions, so a value defined in two
+  // chunks is left for the serial assembler, which diagnoses the first
+  // redefinition in module order.
+  std::vector<bool> defined(*bound, false);
+  for (const auto& typed_values : chunk_typed_values) {
+    for (uint32_t value : typed_values) {
+      if (defined[value]) return SPV_FAILED_MATCH;
+      defined[value] = true;
+    }
+  }
+
+  for (const auto& chunk : chunk_words)
+    words->insert(words->end(), chunk.begin(), chunk.end());
+  return SPV_SUCCESS;
+}
+
+namespace {
+
 // Translates a given assembly language module into binary form.
 // If a diagnostic is generated, it is not yet marked as being
 // for a text-based input.
@@ -745,7 +978,8 @@ spv_result_t spvTextToBinaryInternal(const spvtools::AssemblyGrammar& grammar,
     if (result != SPV_SUCCESS) return result;
   }
 
-  spvtools::AssemblyContext context(text, consumer, std::move(ids_to_preserve));
+  spvtools::AssemblyContext context(text, consumer,
+                                    std::set<uint32_t>(ids_to_preserve));
 
   if (!text->str) return context.diagnostic() << "Missing assembly text.";
 
@@ -754,37 +988,44 @@ spv_result_t spvTextToBinaryInternal(const spvtools::AssemblyGrammar& grammar,
   }
   if (!pBinary) return SPV_ERROR_INVALID_POINTER;
 
-  std::vector<spv_instruction_t> instructions;
+  // The words of the module, starting with room for the header.  Each
+  // instruction is encoded into |inst|, whose storage is reused, and then
+  // appended here, so the words of all instructions share one allocation.
+  std::vector<uint32_t> words(SPV_INDEX_INSTRUCTION);
+  // Assembly text takes several bytes per word, so this rarely grows.
+  words.reserve(SPV_INDEX_INSTRUCTION + text->length / 4);
+  uint32_t bound = 0;
+
+  if (!(options & SPV_TEXT_TO_BINARY_OPTION_PARALLEL) ||
+      spvtools::EncodeInstructionsInParallel(
+          grammar, text, std::move(ids_to_preserve), &words, &bound)) {
+    // Assemble serially, from the start.  This also reports any errors.
+    words.resize(SPV_INDEX_INSTRUCTION);
+    spv_instruction_t inst;
 
-  // Skip past whitespace and comments.
-  context.advance();
+    // Skip past whitespace and comments.
+    context.advance();
 
-  while (context.hasText()) {
-    instructions.push_back({});
-    spv_instruction_t& inst = instructions.back();
+    while (context.hasText()) {
+      ResetInstruction(&inst);
 
-    if (spvTextEncodeOpcode(grammar, &context, &inst)) {
-      return SPV_ERROR_INVALID_TEXT;
-    }
-
-    if (context.advance()) break;
-  }
+      if (spvTextEncodeOpcode(grammar, &context, &inst)) {
+        return SPV_ERROR_INVALID_TEXT;
+      }
+      words.insert(words.end(), inst.words.begin(), inst.words.end());
 
-  size_t totalSize = SPV_INDEX_INSTRUCTION;
-  for (auto& inst : instructions) {
-    totalSize += inst.words.size();
+      if (context.advance()) break;
+    }
+    bound = context.getBound();
   }
 
+  const size_t totalSize = words.size();
   uint32_t* data = new uint32_t[totalSize];
   if (!data) return SPV_ERROR_OUT_OF_MEMORY;
-  uint64_t currentIndex = SPV_INDEX_INSTRUCTION;
-  for (auto& inst : instructions) {
-    memcpy(data + currentIndex, inst.words.data(),
-           sizeof(uint32_t) * inst.words.size());
-    currentIndex += inst.words.size();
-  }
+  memcpy(data + SPV_INDEX_INSTRUCTION, words.data() + SPV_INDEX_INSTRUCTION,
+         sizeof(uint32_t) * (totalSize - SPV_INDEX_INSTRUCTION));
 
-  if (auto error = SetHeader(grammar.target_env(), context.getBound(), data))
+  if (auto error = SetHeader(grammar.target_env(), bound, data))
     return error;
 
   spv_binary binary = new spv_binary_t();
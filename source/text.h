@@ -15,7 +15,9 @@
 #ifndef SOURCE_TEXT_H_
 #define SOURCE_TEXT_H_
 
+#include <set>
 #include <string>
+#include <vector>
 
 #include "source/operand.h"
 #include "source/spirv_constant.h"
@@ -50,4 +52,21 @@ typedef struct spv_literal_t {
 // which are then stripped.
 spv_result_t spvTextToLiteral(const char* text, spv_literal_t* literal);
 
+namespace spvtools {
+
+class AssemblyGrammar;
+
+// Encodes the instructions of the given module text into |words|, after the
+// room for its header, and writes its id bound to |bound|, encoding function
+// bodies on several threads.  Returns SPV_FAILED_MATCH, without emitting
+// diagnostics, if the result might not match the serial assembler's, such as
+// when the text has errors; the module must then be assembled serially.
+spv_result_t EncodeInstructionsInParallel(const AssemblyGrammar& grammar,
+                                          const spv_text text,
+                                          std::set<uint32_t>&& ids_to_preserve,
+                                          std::vector<uint32_t>* words,
+                                          uint32_t* bound);
+
+}  // namespace spvtools
+
 #endif  // SOURCE_TEXT_H_
@@ -85,27 +85,21 @@ spv_result_t advance(spv_text text, spv_position position) {
   return SPV_SUCCESS;
 }
 
-// Fetches the next word from the given text stream starting from the given
-// *position. On success, writes the decoded word into *word and updates
-// *position to the location past the returned word.
+// Advances *position past the next word in the given text stream, without
+// copying it.
 //
 // A word ends at the next comment or whitespace.  However, double-quoted
 // strings remain intact, and a backslash always escapes the next character.
-spv_result_t getWord(spv_text text, spv_position position, std::string* word) {
+spv_result_t skipWord(spv_text text, spv_position position) {
   if (!text->str || !text->length) return SPV_ERROR_INVALID_TEXT;
   if (!position) return SPV_ERROR_INVALID_POINTER;
 
-  const size_t start_index = position->index;
-
   bool quoting = false;
   bool escaping = false;
 
   // NOTE: Assumes first character is not white space!
   while (true) {
-    if (position->index >= text->length) {
-      word->assign(text->str + start_index, text->str + position->index);
-      return SPV_SUCCESS;
-    }
+    if (position->index >= text->length) return SPV_SUCCESS;
     const char ch = text->str[position->index];
     if (ch == '\\') {
       escaping = !escaping;
@@ -121,10 +115,8 @@ spv_result_t getWord(spv_text text, spv_position position, std::string* word) {
         case '\r':
           if (escaping || quoting) break;
         // Fall through.
-        case '\0': {  // NOTE: End of word found!
-          word->assign(text->str + start_index, text->str + position->index);
+        case '\0':  // NOTE: End of word found!
           return SPV_SUCCESS;
-        }
         default:
           break;
       }
@@ -136,6 +128,16 @@ spv_result_t getWord(spv_text text, spv_position position, std::string* word) {
   }
 }
 
+// Fetches the next word from the given text stream starting from the given
+// *position. On success, writes the decoded word into *word and updates
+// *position to the location past the returned word.
+spv_result_t getWord(spv_text text, spv_position position, std::string* word) {
+  const size_t start_index = position ? position->index : 0;
+  if (auto error = skipWord(text, position)) return error;
+  word->assign(text->str + start_index, text->str + position->index);
+  return SPV_SUCCESS;
+}
+
 // Returns true if the characters in the text as position represent
 // the start of an Opcode.
 bool startsWithOp(spv_text text, spv_position position) {
@@ -150,11 +152,69 @@ bool startsWithOp(spv_text text, spv_position position) {
 
 const IdType kUnknownType = {0, false, IdTypeClass::kBottom};
 
+uint32_t NamedIdTable::hash(const char* name, size_t length) {
+  // 32-bit FNV-1a.
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < length; ++i) {
+    h = (h ^ static_cast<unsigned char>(name[i])) * 16777619u;
+  }
+  return h;
+}
+
+uint32_t NamedIdTable::find(const char* name, size_t length) const {
+  if (slots_.empty()) return 0;
+  const uint32_t h = hash(name, length);
+  const size_t mask = slots_.size() - 1;
+  for (size_t i = h & mask;; i = (i + 1) & mask) {
+    const Slot& slot = slots_[i];
+    if (!slot.id) return 0;
+    if (slot.hash == h && slot.length == length &&
+        !memcmp(names_.data() + slot.offset, name, length)) {
+      return slot.id;
+    }
+  }
+}
+
+void NamedIdTable::insert(const char* name, size_t length, uint32_t id) {
+  assert(id && "Id 0 marks an empty slot");
+  assert(!find(name, length) && "Name is already recorded");
+  // Keep the table at most three quarters full.
+  if (4 * (num_ids_ + 1) > 3 * slots_.size()) grow();
+
+  const uint32_t h = hash(name, length);
+  const size_t mask = slots_.size() - 1;
+  size_t i = h & mask;
+  while (slots_[i].id) i = (i + 1) & mask;
+  slots_[i] = {id, h, names_.size(), length};
+  names_.append(name, length);
+  names_.push_back('\0');
+  ++num_ids_;
+}
+
+void NamedIdTable::grow() {
+  std::vector<Slot> old_slots(std::max<size_t>(64, 2 * slots_.size()),
+                              Slot{0, 0, 0, 0});
+  old_slots.swap(slots_);
+  const size_t mask = slots_.size() - 1;
+  for (const Slot& slot : old_slots) {
+    if (!slot.id) continue;
+    size_t i = slot.hash & mask;
+    while (slots_[i].id) i = (i + 1) & mask;
+    slots_[i] = slot;
+  }
+}
+
 // TODO(dneto): Reorder AssemblyContext definitions to match declaration order.
 
 // This represents all of the data that is only valid for the duration of
 // a single compilation.
 uint32_t AssemblyContext::spvNamedIdAssignOrGet(const char* textValue) {
+  if (shared_) {
+    const uint32_t id = shared_->getNamedId(textValue);
+    if (!id) diagnostic(SPV_ERROR_INTERNAL) << "Unassigned ID " << textValue;
+    return id;
+  }
+
   if (!ids_to_preserve_.empty()) {
     uint32_t id = 0;
     if (spvtools::utils::ParseNumber(textValue, &id)) {
@@ -165,21 +225,32 @@ uint32_t AssemblyContext::spvNamedIdAssignOrGet(const char* textValue) {
     }
   }
 
-  const auto it = named_ids_.find(textValue);
-  if (it == named_ids_.end()) {
-    uint32_t id = next_id_++;
+  const size_t length = strlen(textValue);
+  uint32_t id = named_ids_.find(textValue, length);
+  if (!id) {
+    id = next_id_++;
     if (!ids_to_preserve_.empty()) {
       while (ids_to_preserve_.find(id) != ids_to_preserve_.end()) {
         id = next_id_++;
       }
     }
 
-    named_ids_.emplace(textValue, id);
+    named_ids_.insert(textValue, length, id);
     bound_ = std::max(bound_, id + 1);
-    return id;
   }
 
-  return it->second;
+  return id;
+}
+
+uint32_t AssemblyContext::getNamedId(const char* textValue) const {
+  if (!ids_to_preserve_.empty()) {
+    uint32_t id = 0;
+    if (spvtools::utils::ParseNumber(textValue, &id) &&
+        ids_to_preserve_.find(id) != ids_to_preserve_.end()) {
+      return id;
+    }
+  }
+  return named_ids_.find(textValue, strlen(textValue));
 }
 
 uint32_t AssemblyContext::getBound() const { return bound_; }
@@ -203,14 +274,18 @@ bool AssemblyContext::isStartOfNewInst() {
   if (spvtools::advance(text_, &pos)) return false;
   if (spvtools::startsWithOp(text_, &pos)) return true;
 
-  std::string word;
+  // Check for "%<name> =" without copying the words.
   pos = current_position_;
-  if (spvtools::getWord(text_, &pos, &word)) return false;
-  if ('%' != word.front()) return false;
+  if (spvtools::skipWord(text_, &pos)) return false;
+  if (pos.index == current_position_.index ||
+      '%' != text_->str[current_position_.index])
+    return false;
 
   if (spvtools::advance(text_, &pos)) return false;
-  if (spvtools::getWord(text_, &pos, &word)) return false;
-  if ("=" != word) return false;
+  const size_t equal_sign_index = pos.index;
+  if (spvtools::skipWord(text_, &pos)) return false;
+  if (pos.index != equal_sign_index + 1 || '=' != text_->str[equal_sign_index])
+    return false;
 
   if (spvtools::advance(text_, &pos)) return false;
   if (spvtools::startsWithOp(text_, &pos)) return true;
@@ -320,6 +395,10 @@ spv_result_t AssemblyContext::binaryEncodeString(const char* value,
 
 spv_result_t AssemblyContext::recordTypeDefinition(
     const spv_instruction_t* pInst) {
+  if (shared_) {
+    return diagnostic(SPV_ERROR_INTERNAL)
+           << "Types cannot be recorded in a shared context";
+  }
   uint32_t value = pInst->words[1];
   if (types_.find(value) != types_.end()) {
     return diagnostic() << "Value " << value
@@ -342,6 +421,7 @@ spv_result_t AssemblyContext::recordTypeDefinition(
 }
 
 IdType AssemblyContext::getTypeOfTypeGeneratingValue(uint32_t value) const {
+  if (shared_) return shared_->getTypeOfTypeGeneratingValue(value);
   auto type = types_.find(value);
   if (type == types_.end()) {
     return kUnknownType;
@@ -352,6 +432,7 @@ IdType AssemblyContext::getTypeOfTypeGeneratingValue(uint32_t value) const {
 IdType AssemblyContext::getTypeOfValueInstruction(uint32_t value) const {
   auto type_value = value_types_.find(value);
   if (type_value == value_types_.end()) {
+    if (shared_) return shared_->getTypeOfValueInstruction(value);
     return {0, false, IdTypeClass::kBottom};
   }
   return getTypeOfTypeGeneratingValue(std::get<1>(*type_value));
@@ -359,6 +440,10 @@ IdType AssemblyContext::getTypeOfValueInstruction(uint32_t value) const {
 
 spv_result_t AssemblyContext::recordTypeIdForValue(uint32_t value,
                                                    uint32_t type) {
+  if (shared_ &&
+      shared_->value_types_.find(value) != shared_->value_types_.end()) {
+    return diagnostic() << "Value is being defined a second time";
+  }
   bool successfully_inserted = false;
   std::tie(std::ignore, successfully_inserted) =
       value_types_.insert(std::make_pair(value, type));
@@ -369,6 +454,10 @@ spv_result_t AssemblyContext::recordTypeIdForValue(uint32_t value,
 
 spv_result_t AssemblyContext::recordIdAsExtInstImport(
     uint32_t id, spv_ext_inst_type_t type) {
+  if (shared_) {
+    return diagnostic(SPV_ERROR_INTERNAL)
+           << "Imports cannot be recorded in a shared context";
+  }
   bool successfully_inserted = false;
   std::tie(std::ignore, successfully_inserted) =
       import_id_to_ext_inst_type_.insert(std::make_pair(id, type));
@@ -378,6 +467,7 @@ spv_result_t AssemblyContext::recordIdAsExtInstImport(
 }
 
 spv_ext_inst_type_t AssemblyContext::getExtInstTypeForId(uint32_t id) const {
+  if (shared_) return shared_->getExtInstTypeForId(id);
   auto type = import_id_to_ext_inst_type_.find(id);
   if (type == import_id_to_ext_inst_type_.end()) {
     return SPV_EXT_INST_TYPE_NONE;
@@ -387,11 +477,20 @@ spv_ext_inst_type_t AssemblyContext::getExtInstTypeForId(uint32_t id) const {
 
 std::set<uint32_t> AssemblyContext::GetNumericIds() const {
   std::set<uint32_t> ids;
-  for (const auto& kv : named_ids_) {
+  named_ids_.forEach([&ids](const char* name, uint32_t) {
     uint32_t id;
-    if (spvtools::utils::ParseNumber(kv.first.c_str(), &id)) ids.insert(id);
-  }
+    if (spvtools::utils::ParseNumber(name, &id)) ids.insert(id);
+  });
   return ids;
 }
 
+std::vector<uint32_t> AssemblyContext::GetTypedValues() const {
+  std::vector<uint32_t> values;
+  values.reserve(value_types_.size());
+  for (const auto& value_type : value_types_) {
+    values.push_back(value_type.first);
+  }
+  return values;
+}
+
 }  // namespace spvtools
@@ -22,6 +22,7 @@
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "source/diagnostic.h"
 #include "source/instruction.h"
@@ -117,6 +118,49 @@ class ClampToZeroIfUnsignedType<
   }
 };
 
+// Maps ID names to their numeric ids.  This is an open-addressing hash table
+// whose names are copied into one growing character buffer, so that
+// assembling a module does not allocate per name.
+class NamedIdTable {
+ public:
+  // Returns the id recorded for the given name, or 0 if there is none.
+  uint32_t find(const char* name, size_t length) const;
+
+  // Records the given non-zero id for the given name, which must not have
+  // been recorded before.
+  void insert(const char* name, size_t length, uint32_t id);
+
+  // Calls f(name, id) for each recorded name, as a null-terminated string,
+  // and its id.
+  template <typename F>
+  void forEach(F f) const {
+    for (const Slot& slot : slots_) {
+      if (slot.id) f(names_.data() + slot.offset, slot.id);
+    }
+  }
+
+ private:
+  struct Slot {
+    uint32_t id;    // 0 for an empty slot.
+    uint32_t hash;  // Hash of the name.
+    size_t offset;  // Offset of the name in names_.
+    size_t length;  // Length of the name.
+  };
+
+  // Returns the hash of the given name.
+  static uint32_t hash(const char* name, size_t length);
+
+  // Doubles the number of slots, and redistributes the recorded names.
+  void grow();
+
+  // The slots, whose number is zero or a power of 2.
+  std::vector<Slot> slots_;
+  // Number of non-empty slots.
+  size_t num_ids_ = 0;
+  // The recorded names, each followed by a null character.
+  std::string names_;
+};
+
 // Encapsulates the data used during the assembly of a SPIR-V module.
 class AssemblyContext {
  public:
@@ -129,6 +173,22 @@ class AssemblyContext {
         next_id_(1),
         ids_to_preserve_(std::move(ids_to_preserve)) {}
 
+  // Creates a context for encoding part of the same text as |shared|, once
+  // |shared| has assigned ids to all the ID names in the text.  Ids, types and
+  // extended instruction imports are looked up in |shared|, which must outlive
+  // this context and must not change while it is in use, so that several such
+  // contexts can encode parts of the text on different threads.  Needing to
+  // assign a new id, or to record a type or an extended instruction import,
+  // emits a diagnostic to |consumer|.
+  AssemblyContext(const AssemblyContext* shared,
+                  const MessageConsumer& consumer)
+      : current_position_({}),
+        consumer_(consumer),
+        text_(shared->text_),
+        bound_(shared->bound_),
+        next_id_(shared->next_id_),
+        shared_(shared) {}
+
   // Assigns a new integer value to the given text ID, or returns the previously
   // assigned integer value if the ID has been seen before.
   uint32_t spvNamedIdAssignOrGet(const char* textValue);
@@ -238,15 +298,22 @@ class AssemblyContext {
   // from "%foo".
   std::set<uint32_t> GetNumericIds() const;
 
+  // Returns the values whose types were recorded by recordTypeIdForValue in
+  // this context, not in the context it shares ids with, in no particular
+  // order.
+  std::vector<uint32_t> GetTypedValues() const;
+
  private:
-  // Maps ID names to their corresponding numerical ids.
-  using spv_named_id_table = std::unordered_map<std::string, uint32_t>;
+  // Returns the id assigned to the given text ID, or 0 if it has none.
+  uint32_t getNamedId(const char* textValue) const;
+
   // Maps type-defining IDs to their IdType.
   using spv_id_to_type_map = std::unordered_map<uint32_t, IdType>;
   // Maps Ids to the id of their type.
   using spv_id_to_type_id = std::unordered_map<uint32_t, uint32_t>;
 
-  spv_named_id_table named_ids_;
+  // Maps ID names to their corresponding numerical ids.
+  NamedIdTable named_ids_;
   spv_id_to_type_map types_;
   spv_id_to_type_id value_types_;
   // Maps an extended instruction import Id to the extended instruction type.
@@ -257,6 +324,8 @@ class AssemblyContext {
   uint32_t bound_;
   uint32_t next_id_;
   std::set<uint32_t> ids_to_preserve_;
+  // The context this one shares ids and types with, if any.
+  const AssemblyContext* shared_ = nullptr;
 };
 
 }  // namespace spvtools
@@ -40,6 +40,22 @@ void BasicBlock::SetImmediatePostDominator(BasicBlock* pdom_block) {
   immediate_post_dominator_ = pdom_block;
 }
 
+void BasicBlock::SetDominatorTreePosition(const BasicBlock* root,
+                                          uint32_t preorder,
+                                          uint32_t postorder) {
+  dominator_tree_position_.root = root;
+  dominator_tree_position_.preorder = preorder;
+  dominator_tree_position_.postorder = postorder;
+}
+
+void BasicBlock::SetPostDominatorTreePosition(const BasicBlock* root,
+                                              uint32_t preorder,
+                                              uint32_t postorder) {
+  post_dominator_tree_position_.root = root;
+  post_dominator_tree_position_.preorder = preorder;
+  post_dominator_tree_position_.postorder = postorder;
+}
+
 const BasicBlock* BasicBlock::immediate_dominator() const {
   return immediate_dominator_;
 }
@@ -62,12 +78,20 @@ void BasicBlock::RegisterSuccessors(
 }
 
 bool BasicBlock::dominates(const BasicBlock& other) const {
+  if (dominator_tree_position_.root && other.dominator_tree_position_.root) {
+    return dominator_tree_position_.Contains(other.dominator_tree_position_);
+  }
   return (this == &other) ||
          !(other.dom_end() ==
            std::find(other.dom_begin(), other.dom_end(), this));
 }
 
 bool BasicBlock::postdominates(const BasicBlock& other) const {
+  if (post_dominator_tree_position_.root &&
+      other.post_dominator_tree_position_.root) {
+    return post_dominator_tree_position_.Contains(
+        other.post_dominator_tree_position_);
+  }
   return (this == &other) ||
          !(other.pdom_end() ==
            std::find(other.pdom_begin(), other.pdom_end(), this));
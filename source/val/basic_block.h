@@ -94,6 +94,27 @@ class BasicBlock {
   /// @param[in] pdom_block The post dominator block
   void SetImmediatePostDominator(BasicBlock* pdom_block);
 
+  /// Records where this basic block is in a depth first traversal of the
+  /// dominator tree it belongs to, so that dominates() does not need to walk
+  /// the tree.  Must only be called once immediate dominators are final.
+  ///
+  /// @param[in] root The root of the dominator tree
+  /// @param[in] preorder The number of the block in preorder
+  /// @param[in] postorder The number of the block in postorder
+  void SetDominatorTreePosition(const BasicBlock* root, uint32_t preorder,
+                                uint32_t postorder);
+
+  /// Records where this basic block is in a depth first traversal of the
+  /// post dominator tree it belongs to, so that postdominates() does not need
+  /// to walk the tree.  Must only be called once immediate post dominators
+  /// are final.
+  ///
+  /// @param[in] root The root of the post dominator tree
+  /// @param[in] preorder The number of the block in preorder
+  /// @param[in] postorder The number of the block in postorder
+  void SetPostDominatorTreePosition(const BasicBlock* root, uint32_t preorder,
+                                    uint32_t postorder);
+
   /// Returns the immedate dominator of this basic block
   BasicBlock* immediate_dominator();
 
@@ -129,11 +150,13 @@ class BasicBlock {
   bool operator==(const uint32_t& other_id) const { return other_id == id_; }
 
   /// Returns true if this block dominates the other block.
-  /// Assumes dominators have been computed.
+  /// Assumes dominators have been computed.  Takes constant time if both
+  /// blocks have dominator tree positions.
   bool dominates(const BasicBlock& other) const;
 
   /// Returns true if this block postdominates the other block.
-  /// Assumes dominators have been computed.
+  /// Assumes dominators have been computed.  Takes constant time if both
+  /// blocks have post dominator tree positions.
   bool postdominates(const BasicBlock& other) const;
 
   /// @brief A BasicBlock dominator iterator class
@@ -200,6 +223,21 @@ class BasicBlock {
   DominatorIterator pdom_end();
 
  private:
+  /// Where a block is in a depth first traversal of a (post) dominator tree.
+  struct TreePosition {
+    /// The root of the tree, or nullptr if the position is not known.
+    const BasicBlock* root = nullptr;
+    uint32_t preorder = 0;
+    uint32_t postorder = 0;
+
+    /// Returns true if the block at this position is an ancestor of the
+    /// block at |other|, or the same block.  Both positions must be known.
+    bool Contains(const TreePosition& other) const {
+      return root == other.root && preorder <= other.preorder &&
+             other.postorder <= postorder;
+    }
+  };
+
   /// Id of the BasicBlock
   const uint32_t id_;
 
@@ -209,6 +247,12 @@ class BasicBlock {
   /// Pointer to the immediate dominator of the BasicBlock
   BasicBlock* immediate_post_dominator_;
 
+  /// Position of the BasicBlock in the dominator tree
+  TreePosition dominator_tree_position_;
+
+  /// Position of the BasicBlock in the post dominator tree
+  TreePosition post_dominator_tree_position_;
+
   /// The set of predecessors of the BasicBlock
   std::vector<BasicBlock*> predecessors_;
 
@@ -16,6 +16,7 @@
 #define SOURCE_VAL_INSTRUCTION_H_
 
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <utility>
@@ -31,14 +32,58 @@ namespace val {
 class BasicBlock;
 class Function;
 
+/// A read-only view of |size| contiguous objects of type T starting at |data|.
+/// The view does not own the objects.
+template <typename T>
+class ArrayView {
+ public:
+  using value_type = T;
+  using const_iterator = const T*;
+
+  ArrayView() : data_(nullptr), size_(0) {}
+  ArrayView(const T* data, size_t size) : data_(data), size_(size) {}
+
+  const T* data() const { return data_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  const_iterator begin() const { return data_; }
+  const_iterator end() const { return data_ + size_; }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+  const T& operator[](size_t index) const {
+    assert(index < size_);
+    return data_[index];
+  }
+  const T& at(size_t index) const { return (*this)[index]; }
+  const T& front() const { return (*this)[0]; }
+  const T& back() const { return (*this)[size_ - 1]; }
+
+ private:
+  const T* data_;
+  size_t size_;
+};
+
 /// Wraps the spv_parsed_instruction struct along with use and definition of the
 /// instruction's result id
 class Instruction {
  public:
+  /// Wraps |inst| without copying its words or operands, which must outlive
+  /// the Instruction.
   explicit Instruction(const spv_parsed_instruction_t* inst);
 
+  /// Sets where the uses of the Instruction are registered, which must have
+  /// room for all of them, and forgets any registered so far.
+  void SetUseStorage(std::pair<const Instruction*, uint32_t>* storage) {
+    uses_ = storage;
+    num_uses_ = 0;
+  }
+
   /// Registers the use of the Instruction in instruction \p inst at \p index
-  void RegisterUse(const Instruction* inst, uint32_t index);
+  void RegisterUse(const Instruction* inst, uint32_t index) {
+    uses_[num_uses_++] = std::make_pair(inst, index);
+  }
 
   uint32_t id() const { return inst_.result_id; }
   uint32_t type_id() const { return inst_.type_id; }
@@ -54,28 +99,31 @@ class Instruction {
   const BasicBlock* block() const { return block_; }
   void set_block(BasicBlock* b) { block_ = b; }
 
-  /// Returns a vector of pairs of all references to this instruction's result
-  /// id. The first element is the instruction in which this result id was
+  /// Returns the pairs of all references to this instruction's result id.
+  /// The first element is the instruction in which this result id was
   /// referenced and the second is the index of the word in that instruction
   /// where this result id appeared
-  const std::vector<std::pair<const Instruction*, uint32_t>>& uses() const {
-    return uses_;
+  ArrayView<std::pair<const Instruction*, uint32_t>> uses() const {
+    return ArrayView<std::pair<const Instruction*, uint32_t>>(uses_,
+                                                              num_uses_);
   }
 
   /// The word used to define the Instruction
-  uint32_t word(size_t index) const { return words_[index]; }
+  uint32_t word(size_t index) const { return words()[index]; }
 
   /// The words used to define the Instruction
-  const std::vector<uint32_t>& words() const { return words_; }
+  ArrayView<uint32_t> words() const {
+    return ArrayView<uint32_t>(inst_.words, inst_.num_words);
+  }
 
   /// Returns the operand at |idx|.
   const spv_parsed_operand_t& operand(size_t idx) const {
-    return operands_[idx];
+    return operands()[idx];
   }
 
   /// The operands of the Instruction
-  const std::vector<spv_parsed_operand_t>& operands() const {
-    return operands_;
+  ArrayView<spv_parsed_operand_t> operands() const {
+    return ArrayView<spv_parsed_operand_t>(inst_.operands, inst_.num_operands);
   }
 
   /// Provides direct access to the stored C instruction object.
@@ -100,20 +148,22 @@ class Instruction {
   // Casts the words belonging to the operand under |index| to |T| and returns.
   template <typename T>
   T GetOperandAs(size_t index) const {
-    const spv_parsed_operand_t& o = operands_.at(index);
+    const spv_parsed_operand_t& o = operands().at(index);
     assert(o.num_words * 4 >= sizeof(T));
     assert(o.offset + o.num_words <= inst_.num_words);
-    return *reinterpret_cast<const T*>(&words_[o.offset]);
+    return *reinterpret_cast<const T*>(&inst_.words[o.offset]);
   }
 
   size_t LineNum() const { return line_num_; }
-  void SetLineNum(size_t pos) { line_num_ = pos; }
+  void SetLineNum(size_t pos) { line_num_ = static_cast<uint32_t>(pos); }
 
  private:
-  const std::vector<uint32_t> words_;
-  const std::vector<spv_parsed_operand_t> operands_;
   spv_parsed_instruction_t inst_;
-  size_t line_num_ = 0;
+  // A module has fewer instructions than words, whose count fits 32 bits.
+  uint32_t line_num_ = 0;
+
+  /// The number of uses registered in uses_
+  uint32_t num_uses_ = 0;
 
   /// The function in which this instruction was declared
   Function* function_ = nullptr;
@@ -121,11 +171,11 @@ class Instruction {
   /// The basic block in which this instruction was declared
   BasicBlock* block_ = nullptr;
 
-  /// This is a vector of pairs of all references to this instruction's result
-  /// id. The first element is the instruction in which this result id was
-  /// referenced and the second is the index of the word in the referencing
-  /// instruction where this instruction appeared
-  std::vector<std::pair<const Instruction*, uint32_t>> uses_;
+  /// The pairs of all references to this instruction's result id, stored by
+  /// the validation state. The first element is the instruction in which this
+  /// result id was referenced and the second is the index of the word in the
+  /// referencing instruction where this instruction appeared
+  std::pair<const Instruction*, uint32_t>* uses_ = nullptr;
 };
 
 bool operator<(const Instruction& lhs, const Instruction& rhs);
@@ -15,13 +15,16 @@
 #include "source/val/validate.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdio>
 #include <functional>
 #include <iterator>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "source/binary.h"
@@ -38,6 +41,7 @@
 #include "source/val/construct.h"
 #include "source/val/function.h"
 #include "source/val/instruction.h"
+#include "source/val/validation_cache.h"
 #include "source/val/validation_state.h"
 #include "spirv-tools/libspirv.h"
 
@@ -209,6 +213,252 @@ spv_result_t ValidateEntryPoints(ValidationState_t& _) {
   return SPV_SUCCESS;
 }
 
+// Below this many instructions, a shard of instruction checks is not worth
+// running on its own thread.
+const size_t kMinInstructionsPerShard = 4096;
+
+// A diagnostic emitted by a check that ran on a worker thread.
+struct DivertedMessage {
+  spv_message_level_t level;
+  std::string source;
+  spv_position_t position;
+  std::string message;
+};
+
+}  // namespace
+
+size_t NumCheckThreads(const ValidationState_t& _) {
+  const size_t num_threads = _.options()->num_threads;
+  if (num_threads) return num_threads;
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+spv_result_t RunShards(const ValidationState_t& _, size_t num_shards,
+                       size_t num_threads,
+                       const std::function<spv_result_t(size_t)>& check,
+                       const std::function<uint64_t(size_t)>& failure_rank) {
+  std::vector<spv_result_t> results(num_shards, SPV_SUCCESS);
+  std::vector<std::vector<DivertedMessage>> messages(num_shards);
+  // Shards are claimed in order.  Without ranks, none after the first failing
+  // one can change the outcome, so workers stop claiming once they pass it.
+  std::atomic<size_t> next_shard(0);
+  std::atomic<size_t> first_failure(num_shards);
+  auto worker = [&]() {
+    for (size_t i = next_shard++; i < first_failure; i = next_shard++) {
+      std::vector<DivertedMessage>* shard_messages = &messages[i];
+      const MessageConsumer consumer =
+          [shard_messages](spv_message_level_t level, const char* source,
+                           const spv_position_t& position,
+                           const char* message) {
+            shard_messages->push_back({level, source ? source : "", position,
+                                       message ? message : ""});
+          };
+      ValidationState_t::DivertDiagnostics(&consumer);
+      results[i] = check(i);
+      ValidationState_t::DivertDiagnostics(nullptr);
+      if (results[i] != SPV_SUCCESS && !failure_rank) {
+        size_t failure = first_failure;
+        while (i < failure &&
+               !first_failure.compare_exchange_weak(failure, i)) {
+        }
+      }
+    }
+  };
+
+  num_threads = std::max<size_t>(1, std::min(num_threads, num_shards));
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads - 1);
+  for (size_t i = 1; i < num_threads; ++i) threads.emplace_back(worker);
+  worker();
+  for (auto& thread : threads) thread.join();
+
+  // The failing shard which decides the outcome.
+  size_t failure = num_shards;
+  for (size_t i = 0; i < num_shards; ++i) {
+    if (results[i] == SPV_SUCCESS) continue;
+    if (!failure_rank) {
+      failure = i;
+      break;
+    }
+    if (failure == num_shards || failure_rank(i) < failure_rank(failure)) {
+      failure = i;
+    }
+  }
+
+  const MessageConsumer& consumer = _.context()->consumer;
+  for (size_t i = 0; i < num_shards; ++i) {
+    if (results[i] != SPV_SUCCESS && i != failure) continue;
+    if (consumer) {
+      for (const auto& message : messages[i]) {
+        consumer(message.level, message.source.c_str(), message.position,
+                 message.message.c_str());
+      }
+    }
+    if (i == failure) return results[i];
+  }
+  return SPV_SUCCESS;
+}
+
+namespace {
+
+// A check of individual instructions, and the grammar entries it applies to.
+struct InstructionCheck {
+  spv_result_t (*check)(ValidationState_t&, const Instruction*);
+  bool (*applies_to)(const spv_opcode_desc_t&);
+};
+
+// Keep these passes in the order they appear in the SPIR-V specification
+// sections to maintain test consistency.
+const InstructionCheck kOpcodeChecks[] = {
+    {MiscPass, MiscPassAppliesTo},
+    {DebugPass, DebugPassAppliesTo},
+    {AnnotationPass, AnnotationPassAppliesTo},
+    {ExtensionPass, ExtensionPassAppliesTo},
+    {ModeSettingPass, ModeSettingPassAppliesTo},
+    {TypePass, TypePassAppliesTo},
+    {ConstantPass, ConstantPassAppliesTo},
+    {MemoryPass, MemoryPassAppliesTo},
+    {FunctionPass, FunctionPassAppliesTo},
+    {ImagePass, ImagePassAppliesTo},
+    {ConversionPass, ConversionPassAppliesTo},
+    {CompositesPass, CompositesPassAppliesTo},
+    {ArithmeticsPass, ArithmeticsPassAppliesTo},
+    {BitwisePass, BitwisePassAppliesTo},
+    {LogicalsPass, LogicalsPassAppliesTo},
+    {ControlFlowPass, ControlFlowPassAppliesTo},
+    {DerivativesPass, DerivativesPassAppliesTo},
+    {AtomicsPass, AtomicsPassAppliesTo},
+    {PrimitivesPass, PrimitivesPassAppliesTo},
+    {BarriersPass, BarriersPassAppliesTo},
+    // Group
+    // Device-Side Enqueue
+    // Pipe
+    {NonUniformPass, NonUniformPassAppliesTo},
+    {LiteralsPass, LiteralsPassAppliesTo},
+};
+
+// These must run after all the other checks, because the checks above
+// register the limitations checked here.
+const InstructionCheck kLateChecks[] = {
+    {ValidateExecutionLimitations, ValidateExecutionLimitationsAppliesTo},
+    {ValidateSmallTypeUses, ValidateSmallTypeUsesAppliesTo},
+};
+
+// For each opcode in the grammar, the checks that apply to it, in the order
+// they are listed.  Instructions then only pay for their own checks.
+class InstructionCheckTable {
+ public:
+  template <size_t N>
+  explicit InstructionCheckTable(const InstructionCheck (&checks)[N]) {
+    spv_opcode_table grammar = nullptr;
+    spvOpcodeTableGet(&grammar, SPV_ENV_UNIVERSAL_1_0);
+    const uint32_t num_opcodes =
+        grammar->count ? grammar->entries[grammar->count - 1].opcode + 1 : 0;
+    first_.reserve(num_opcodes + 1);
+    // The entries are ordered by opcode.  Aliases share an opcode, and a check
+    // applies to the opcode if it applies to any of them.
+    uint32_t entry = 0;
+    for (uint32_t opcode = 0; opcode < num_opcodes; ++opcode) {
+      first_.push_back(static_cast<uint32_t>(checks_.size()));
+      uint32_t end = entry;
+      while (end < grammar->count && grammar->entries[end].opcode == opcode)
+        ++end;
+      for (const auto& check : checks) {
+        for (uint32_t i = entry; i < end; ++i) {
+          if (check.applies_to(grammar->entries[i])) {
+            checks_.push_back(check.check);
+            break;
+          }
+        }
+      }
+      entry = end;
+    }
+    first_.push_back(static_cast<uint32_t>(checks_.size()));
+  }
+
+  // Runs the checks that apply to |inst| and returns the first error.  The
+  // parser rejects opcodes missing from the grammar, so those have no checks.
+  spv_result_t Run(ValidationState_t& _, const Instruction* inst) const {
+    const uint32_t opcode = inst->opcode();
+    if (opcode + 1 >= first_.size()) return SPV_SUCCESS;
+    for (uint32_t i = first_[opcode]; i < first_[opcode + 1]; ++i) {
+      if (auto error = checks_[i](_, inst)) return error;
+    }
+    return SPV_SUCCESS;
+  }
+
+ private:
+  // The checks of opcode |op| are checks_[first_[op]] to checks_[first_[op+1]].
+  std::vector<uint32_t> first_;
+  std::vector<spv_result_t (*)(ValidationState_t&, const Instruction*)>
+      checks_;
+};
+
+spv_result_t ValidateInstructionOpcodes(ValidationState_t& _,
+                                        const Instruction* inst) {
+  static const InstructionCheckTable table(kOpcodeChecks);
+  return table.Run(_, inst);
+}
+
+spv_result_t ValidateInstructionLimitations(ValidationState_t& _,
+                                            const Instruction* inst) {
+  static const InstructionCheckTable table(kLateChecks);
+  return table.Run(_, inst);
+}
+
+// Runs the checks of individual opcodes on all instructions, in order.  The
+// checks of instructions outside functions register state that later checks
+// use, so they run first.  The checks of function instructions only read
+// shared state, so with more than one thread, the functions are split into
+// shards that are checked on different threads.
+spv_result_t ValidateAllInstructionOpcodes(ValidationState_t& _) {
+  const auto& instructions = _.ordered_instructions();
+  // Where each shard starts.  The first shard holds the instructions before
+  // the first function.
+  std::vector<size_t> shard_begin(1, 0);
+  const size_t num_threads = NumCheckThreads(_);
+  if (num_threads > 1) {
+    const size_t num_instructions = instructions.size();
+    size_t i = 0;
+    while (i < num_instructions && instructions[i].opcode() != SpvOpFunction)
+      ++i;
+    const size_t shard_size = std::max(
+        kMinInstructionsPerShard, (num_instructions - i) / (4 * num_threads));
+    for (; i < num_instructions; ++i) {
+      if (instructions[i].opcode() == SpvOpFunction &&
+          i - shard_begin.back() >= shard_size) {
+        shard_begin.push_back(i);
+      }
+    }
+  }
+  shard_begin.push_back(instructions.size());
+
+  auto check_shard = [&_, &instructions, &shard_begin](size_t shard) {
+    for (size_t i = shard_begin[shard]; i < shard_begin[shard + 1]; ++i) {
+      if (auto error = ValidateInstructionOpcodes(_, &instructions[i]))
+        return error;
+    }
+    return SPV_SUCCESS;
+  };
+  if (auto error = check_shard(0)) return error;
+  return RunShards(_, shard_begin.size() - 2, num_threads,
+                   [&check_shard](size_t shard) {
+                     return check_shard(shard + 1);
+                   });
+}
+
+// Performs the control flow graph checks of each function, spread over
+// threads if the options allow it.
+spv_result_t PerformAllCfgChecks(ValidationState_t& _) {
+  const size_t num_threads = NumCheckThreads(_);
+  if (num_threads == 1) return PerformCfgChecks(_);
+  auto& functions = _.functions();
+  return RunShards(_, functions.size(), num_threads,
+                   [&_, &functions](size_t i) {
+                     return PerformCfgChecks(_, &functions[i]);
+                   });
+}
+
 spv_result_t ValidateBinaryUsingContextAndValidationState(
     const spv_context_t& context, const uint32_t* words, const size_t num_words,
     spv_diagnostic* pDiagnostic, ValidationState_t* vstate) {
@@ -381,44 +631,10 @@ spv_result_t ValidateBinaryUsingContextAndValidationState(
   // It should also live after the forward declaration check, since it will
   // have problems with missing forward declarations, but give less useful error
   // messages.
-  for (size_t i = 0; i < vstate->ordered_instructions().size(); ++i) {
-    auto& instruction = vstate->ordered_instructions()[i];
-    if (auto error = UpdateIdUse(*vstate, &instruction)) return error;
-  }
+  if (auto error = UpdateIdUses(*vstate)) return error;
 
   // Validate individual opcodes.
-  for (size_t i = 0; i < vstate->ordered_instructions().size(); ++i) {
-    auto& instruction = vstate->ordered_instructions()[i];
-
-    // Keep these passes in the order they appear in the SPIR-V specification
-    // sections to maintain test consistency.
-    if (auto error = MiscPass(*vstate, &instruction)) return error;
-    if (auto error = DebugPass(*vstate, &instruction)) return error;
-    if (auto error = AnnotationPass(*vstate, &instruction)) return error;
-    if (auto error = ExtensionPass(*vstate, &instruction)) return error;
-    if (auto error = ModeSettingPass(*vstate, &instruction)) return error;
-    if (auto error = TypePass(*vstate, &instruction)) return error;
-    if (auto error = ConstantPass(*vstate, &instruction)) return error;
-    if (auto error = MemoryPass(*vstate, &instruction)) return error;
-    if (auto error = FunctionPass(*vstate, &instruction)) return error;
-    if (auto error = ImagePass(*vstate, &instruction)) return error;
-    if (auto error = ConversionPass(*vstate, &instruction)) return error;
-    if (auto error = CompositesPass(*vstate, &instruction)) return error;
-    if (auto error = ArithmeticsPass(*vstate, &instruction)) return error;
-    if (auto error = BitwisePass(*vstate, &instruction)) return error;
-    if (auto error = LogicalsPass(*vstate, &instruction)) return error;
-    if (auto error = ControlFlowPass(*vstate, &instruction)) return error;
-    if (auto error = DerivativesPass(*vstate, &instruction)) return error;
-    if (auto error = AtomicsPass(*vstate, &instruction)) return error;
-    if (auto error = PrimitivesPass(*vstate, &instruction)) return error;
-    if (auto error = BarriersPass(*vstate, &instruction)) return error;
-    // Group
-    // Device-Side Enqueue
-    // Pipe
-    if (auto error = NonUniformPass(*vstate, &instruction)) return error;
-
-    if (auto error = LiteralsPass(*vstate, &instruction)) return error;
-  }
+  if (auto error = ValidateAllInstructionOpcodes(*vstate)) return error;
 
   // Validate the preconditions involving adjacent instructions. e.g. SpvOpPhi
   // must only be preceeded by SpvOpLabel, SpvOpPhi, or SpvOpLine.
@@ -427,7 +643,7 @@ spv_result_t ValidateBinaryUsingContextAndValidationState(
   if (auto error = ValidateEntryPoints(*vstate)) return error;
   // CFG checks are performed after the binary has been parsed
   // and the CFGPass has collected information about the control flow
-  if (auto error = PerformCfgChecks(*vstate)) return error;
+  if (auto error = PerformAllCfgChecks(*vstate)) return error;
   if (auto error = CheckIdDefinitionDominateUse(*vstate)) return error;
   if (auto error = ValidateDecorations(*vstate)) return error;
   if (auto error = ValidateInterfaces(*vstate)) return error;
@@ -437,13 +653,41 @@ spv_result_t ValidateBinaryUsingContextAndValidationState(
   // These checks must be performed after individual opcode checks because
   // those checks register the limitation checked here.
   for (const auto& inst : vstate->ordered_instructions()) {
-    if (auto error = ValidateExecutionLimitations(*vstate, &inst)) return error;
-    if (auto error = ValidateSmallTypeUses(*vstate, &inst)) return error;
+    if (auto error = ValidateInstructionLimitations(*vstate, &inst))
+      return error;
+  }
+
+  if (vstate->options()->low_memory) {
+    DiagnosticStream(position, context.consumer, "", SPV_SUCCESS)
+        << "Partial estimate of the memory of the validation state: "
+        << (vstate->MemoryUse() + 1023) / 1024 << " KiB for "
+        << vstate->ordered_instructions().size() << " instructions.";
   }
 
   return SPV_SUCCESS;
 }
 
+// Makes |context| write the issues found in the module into |diagnostic|.
+// Informational messages are not issues, so they still go to the message
+// consumer of |context|, if any, and |diagnostic| stays null for a valid
+// module.
+void UseDiagnosticForIssues(spv_context context, spv_diagnostic* diagnostic) {
+  const MessageConsumer consumer = context->consumer;
+  UseDiagnosticAsMessageConsumer(context, diagnostic);
+  const MessageConsumer issue_consumer = context->consumer;
+  SetContextMessageConsumer(
+      context, [consumer, issue_consumer](spv_message_level_t level,
+                                          const char* source,
+                                          const spv_position_t& position,
+                                          const char* message) {
+        if (level != SPV_MSG_INFO) {
+          issue_consumer(level, source, position, message);
+        } else if (consumer) {
+          consumer(level, source, position, message);
+        }
+      });
+}
+
 }  // namespace
 
 spv_result_t ValidateBinaryAndKeepValidationState(
@@ -453,7 +697,7 @@ spv_result_t ValidateBinaryAndKeepValidationState(
   spv_context_t hijack_context = *context;
   if (pDiagnostic) {
     *pDiagnostic = nullptr;
-    UseDiagnosticAsMessageConsumer(&hijack_context, pDiagnostic);
+    UseDiagnosticForIssues(&hijack_context, pDiagnostic);
   }
 
   vstate->reset(new ValidationState_t(&hijack_context, options, words,
@@ -463,6 +707,59 @@ spv_result_t ValidateBinaryAndKeepValidationState(
       hijack_context, words, num_words, pDiagnostic, vstate->get());
 }
 
+namespace {
+
+// Validates the module with |options|, sending messages to the consumer of
+// |context|.  If the options have a cache, the outcome of an earlier
+// validation of the same module is replayed instead, if there is one, and
+// otherwise the outcome is added to the cache.
+spv_result_t ValidateBinaryUsingCache(const spv_context_t& context,
+                                      spv_const_validator_options options,
+                                      const uint32_t* words,
+                                      const size_t num_words) {
+  spv_validator_cache cache = options->cache;
+  if (!cache) {
+    ValidationState_t vstate(&context, options, words, num_words,
+                             kDefaultMaxNumOfWarnings);
+    return ValidateBinaryUsingContextAndValidationState(
+        context, words, num_words, nullptr, &vstate);
+  }
+
+  const uint64_t key =
+      spv_validator_cache_t::Key(context.target_env, options, words, num_words);
+  spv_validator_cache_t::Outcome outcome;
+  if (cache->Lookup(key, &outcome)) {
+    if (context.consumer) {
+      for (const auto& message : outcome.messages) {
+        context.consumer(message.level, message.source.c_str(),
+                         message.position, message.text.c_str());
+      }
+    }
+    return outcome.result;
+  }
+
+  // Record the messages on their way to the consumer.
+  spv_context_t recording_context = context;
+  const MessageConsumer consumer = context.consumer;
+  SetContextMessageConsumer(
+      &recording_context,
+      [&outcome, &consumer](spv_message_level_t level, const char* source,
+                            const spv_position_t& position,
+                            const char* message) {
+        outcome.messages.push_back({level, source ? source : "", position,
+                                    message ? message : ""});
+        if (consumer) consumer(level, source, position, message);
+      });
+  ValidationState_t vstate(&recording_context, options, words, num_words,
+                           kDefaultMaxNumOfWarnings);
+  outcome.result = ValidateBinaryUsingContextAndValidationState(
+      recording_context, words, num_words, nullptr, &vstate);
+  cache->Store(key, outcome);
+  return outcome.result;
+}
+
+}  // namespace
+
 }  // namespace val
 }  // namespace spvtools
 
@@ -479,7 +776,7 @@ spv_result_t spvValidateBinary(const spv_const_context context,
   spv_context_t hijack_context = *context;
   if (pDiagnostic) {
     *pDiagnostic = nullptr;
-    spvtools::UseDiagnosticAsMessageConsumer(&hijack_context, pDiagnostic);
+    spvtools::val::UseDiagnosticForIssues(&hijack_context, pDiagnostic);
   }
 
   // This interface is used for default command line options.
@@ -505,14 +802,75 @@ spv_result_t spvValidateWithOptions(const spv_const_context context,
   spv_context_t hijack_context = *context;
   if (pDiagnostic) {
     *pDiagnostic = nullptr;
-    spvtools::UseDiagnosticAsMessageConsumer(&hijack_context, pDiagnostic);
+    spvtools::val::UseDiagnosticForIssues(&hijack_context, pDiagnostic);
   }
 
-  // Create the ValidationState using the context.
-  spvtools::val::ValidationState_t vstate(&hijack_context, options,
-                                          binary->code, binary->wordCount,
-                                          kDefaultMaxNumOfWarnings);
+  return spvtools::val::ValidateBinaryUsingCache(
+      hijack_context, options, binary->code, binary->wordCount);
+}
+
+spv_result_t spvValidateBinaries(const spv_const_context context,
+                                 spv_const_validator_options options,
+                                 const spv_const_binary_t* binaries,
+                                 size_t num_binaries, size_t num_threads,
+                                 spv_result_t* results,
+                                 spv_diagnostic* diagnostics) {
+  if (!context || (num_binaries && (!binaries || !results)))
+    return SPV_ERROR_INVALID_POINTER;
+
+  spv_validator_options default_options = nullptr;
+  if (!options) {
+    default_options = spvValidatorOptionsCreate();
+    options = default_options;
+  }
 
-  return spvtools::val::ValidateBinaryUsingContextAndValidationState(
-      hijack_context, binary->code, binary->wordCount, pDiagnostic, &vstate);
+  // Messages from all workers that are not written into diagnostics go to the
+  // context's consumer, one at a time.
+  std::mutex consumer_mutex;
+  spv_context_t shared_context = *context;
+  if (context->consumer) {
+    const spvtools::MessageConsumer consumer = context->consumer;
+    spvtools::SetContextMessageConsumer(
+        &shared_context,
+        [&consumer_mutex, consumer](spv_message_level_t level,
+                                    const char* source,
+                                    const spv_position_t& position,
+                                    const char* message) {
+          std::lock_guard<std::mutex> lock(consumer_mutex);
+          consumer(level, source, position, message);
+        });
+  }
+
+  // Each worker claims the next unvalidated module until none are left.  The
+  // grammar tables referenced by the context are immutable and shared; each
+  // module gets its own ValidationState_t.
+  std::atomic<size_t> next_binary(0);
+  auto worker = [&]() {
+    for (size_t i = next_binary++; i < num_binaries; i = next_binary++) {
+      spv_context_t module_context = shared_context;
+      if (diagnostics) {
+        diagnostics[i] = nullptr;
+        spvtools::val::UseDiagnosticForIssues(&module_context,
+                                              &diagnostics[i]);
+      }
+      results[i] = spvtools::val::ValidateBinaryUsingCache(
+          module_context, options, binaries[i].code, binaries[i].wordCount);
+    }
+  };
+
+  if (num_threads == 0) num_threads = std::thread::hardware_concurrency();
+  num_threads = std::max<size_t>(1, std::min(num_threads, num_binaries));
+  // The calling thread is one of the workers.
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads - 1);
+  for (size_t i = 1; i < num_threads; ++i) threads.emplace_back(worker);
+  worker();
+  for (auto& thread : threads) thread.join();
+
+  spvValidatorOptionsDestroy(default_options);
+
+  for (size_t i = 0; i < num_binaries; ++i) {
+    if (results[i] != SPV_SUCCESS) return results[i];
+  }
+  return SPV_SUCCESS;
 }
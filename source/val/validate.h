@@ -15,6 +15,7 @@
 #ifndef SOURCE_VAL_VALIDATE_H_
 #define SOURCE_VAL_VALIDATE_H_
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <utility>
@@ -29,6 +30,7 @@ namespace val {
 
 class ValidationState_t;
 class BasicBlock;
+class Function;
 class Instruction;
 
 /// A function that returns a vector of BasicBlocks given a BasicBlock. Used to
@@ -43,15 +45,60 @@ using get_blocks_func =
 /// @return SPV_SUCCESS if no errors are found. SPV_ERROR_INVALID_CFG otherwise
 spv_result_t PerformCfgChecks(ValidationState_t& _);
 
-/// @brief Updates the use vectors of all instructions that can be referenced
+/// @brief Performs the Control Flow Graph checks on one function
 ///
-/// This function will update the vector which define where an instruction was
-/// referenced in the binary.
+/// Checks of different functions only read shared validation state, so they
+/// may run on different threads at once.
+///
+/// @param[in] _ the validation state of the module
+/// @param[in] function the function to check
+///
+/// @return SPV_SUCCESS if no errors are found. SPV_ERROR_INVALID_CFG otherwise
+spv_result_t PerformCfgChecks(ValidationState_t& _, Function* function);
+
+/// @brief Returns the number of threads to use for checks that the options
+/// allow to be spread over threads
+///
+/// @param[in] _ the validation state of the module
+size_t NumCheckThreads(const ValidationState_t& _);
+
+/// @brief Runs independent checks on several threads
+///
+/// Runs check(i) for each shard i in [0, num_shards) on up to num_threads
+/// threads, the calling thread being one of them.  The diagnostics of each
+/// shard are held back.  Afterward they are emitted in shard order, up to
+/// and including those of the first shard whose check failed, and that
+/// shard's result is returned.  As long as the checks of different shards
+/// only read shared state, the outcome is the same as running the shards one
+/// after another and stopping at the first failure.
+///
+/// If |failure_rank| is given, every shard is checked, and the failing shard
+/// with the lowest failure_rank(i) decides the outcome instead, the earlier
+/// shard winning ties.  The diagnostics of the other failing shards are
+/// dropped.
+///
+/// @param[in] _ the validation state of the module
+/// @param[in] num_shards the number of shards
+/// @param[in] num_threads the most threads to use
+/// @param[in] check the check of a shard
+/// @param[in] failure_rank how early the failure of a shard is reported
+///
+/// @return the result of the shard whose failure is reported, or SPV_SUCCESS
+spv_result_t RunShards(
+    const ValidationState_t& _, size_t num_shards, size_t num_threads,
+    const std::function<spv_result_t(size_t)>& check,
+    const std::function<uint64_t(size_t)>& failure_rank = nullptr);
+
+/// @brief Updates the uses of all instructions that can be referenced
+///
+/// This function will record where each instruction was referenced in the
+/// binary.  The uses are counted first, so that they all fit in a single
+/// buffer of the validation state.
 ///
 /// @param[in] _ the validation state of the module
 ///
 /// @return SPV_SUCCESS if no errors are found.
-spv_result_t UpdateIdUse(ValidationState_t& _, const Instruction* inst);
+spv_result_t UpdateIdUses(ValidationState_t& _);
 
 /// @brief This function checks all ID definitions dominate their use in the
 /// CFG.
@@ -213,6 +260,35 @@ spv_result_t ValidateExecutionLimitations(ValidationState_t& _,
 spv_result_t ValidateSmallTypeUses(ValidationState_t& _,
                                    const Instruction* inst);
 
+/// Each of the following returns true if the check of the same name can
+/// report an error or record state for an instruction whose grammar entry is
+/// |entry|.  The validator only runs a check on the opcodes it applies to, so
+/// these must be kept in step with the opcodes each check handles.
+bool MiscPassAppliesTo(const spv_opcode_desc_t& entry);
+bool DebugPassAppliesTo(const spv_opcode_desc_t& entry);
+bool AnnotationPassAppliesTo(const spv_opcode_desc_t& entry);
+bool ExtensionPassAppliesTo(const spv_opcode_desc_t& entry);
+bool ModeSettingPassAppliesTo(const spv_opcode_desc_t& entry);
+bool TypePassAppliesTo(const spv_opcode_desc_t& entry);
+bool ConstantPassAppliesTo(const spv_opcode_desc_t& entry);
+bool MemoryPassAppliesTo(const spv_opcode_desc_t& entry);
+bool FunctionPassAppliesTo(const spv_opcode_desc_t& entry);
+bool ImagePassAppliesTo(const spv_opcode_desc_t& entry);
+bool ConversionPassAppliesTo(const spv_opcode_desc_t& entry);
+bool CompositesPassAppliesTo(const spv_opcode_desc_t& entry);
+bool ArithmeticsPassAppliesTo(const spv_opcode_desc_t& entry);
+bool BitwisePassAppliesTo(const spv_opcode_desc_t& entry);
+bool LogicalsPassAppliesTo(const spv_opcode_desc_t& entry);
+bool ControlFlowPassAppliesTo(const spv_opcode_desc_t& entry);
+bool DerivativesPassAppliesTo(const spv_opcode_desc_t& entry);
+bool AtomicsPassAppliesTo(const spv_opcode_desc_t& entry);
+bool PrimitivesPassAppliesTo(const spv_opcode_desc_t& entry);
+bool BarriersPassAppliesTo(const spv_opcode_desc_t& entry);
+bool NonUniformPassAppliesTo(const spv_opcode_desc_t& entry);
+bool LiteralsPassAppliesTo(const spv_opcode_desc_t& entry);
+bool ValidateExecutionLimitationsAppliesTo(const spv_opcode_desc_t& entry);
+bool ValidateSmallTypeUsesAppliesTo(const spv_opcode_desc_t& entry);
+
 /// @brief Validate the ID's within a SPIR-V binary
 ///
 /// @param[in] pInstructions array of instructions
@@ -230,7 +306,8 @@ spv_result_t spvValidateIDs(const spv_instruction_t* pInstructions,
 // Performs validation for the SPIRV-V module binary.
 // The main difference between this API and spvValidateBinary is that the
 // "Validation State" is not destroyed upon function return; it lives on and is
-// pointed to by the vstate unique_ptr.
+// pointed to by the vstate unique_ptr.  In low-memory mode its instructions
+// point into |words|, so they must outlive the validation state.
 spv_result_t ValidateBinaryAndKeepValidationState(
     const spv_const_context context, spv_const_validator_options options,
     const uint32_t* words, const size_t num_words, spv_diagnostic* pDiagnostic,
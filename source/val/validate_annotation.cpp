@@ -476,5 +476,20 @@ spv_result_t AnnotationPass(ValidationState_t& _, const Instruction* inst) {
   return SPV_SUCCESS;
 }
 
+bool AnnotationPassAppliesTo(const spv_opcode_desc_t& entry) {
+  switch (entry.opcode) {
+    case SpvOpDecorate:
+    case SpvOpDecorateId:
+    case SpvOpMemberDecorate:
+    case SpvOpDecorationGroup:
+    case SpvOpGroupDecorate:
+    case SpvOpGroupMemberDecorate:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
 }  // namespace val
 }  // namespace spvtools
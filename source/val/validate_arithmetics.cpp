@@ -546,5 +546,42 @@ spv_result_t ArithmeticsPass(ValidationState_t& _, const Instruction* inst) {
   return SPV_SUCCESS;
 }
 
+bool ArithmeticsPassAppliesTo(const spv_opcode_desc_t& entry) {
+  switch (entry.opcode) {
+    case SpvOpFAdd:
+    case SpvOpFSub:
+    case SpvOpFMul:
+    case SpvOpFDiv:
+    case SpvOpFRem:
+    case SpvOpFMod:
+    case SpvOpFNegate:
+    case SpvOpUDiv:
+    case SpvOpUMod:
+    case SpvOpISub:
+    case SpvOpIAdd:
+    case SpvOpIMul:
+    case SpvOpSDiv:
+    case SpvOpSMod:
+    case SpvOpSRem:
+    case SpvOpSNegate:
+    case SpvOpDot:
+    case SpvOpVectorTimesScalar:
+    case SpvOpMatrixTimesScalar:
+    case SpvOpVectorTimesMatrix:
+    case SpvOpMatrixTimesVector:
+    case SpvOpMatrixTimesMatrix:
+    case SpvOpOuterProduct:
+    case SpvOpIAddCarry:
+    case SpvOpISubBorrow:
+    case SpvOpUMulExtended:
+    case SpvOpSMulExtended:
+    case SpvOpCooperativeMatrixMulAddNV:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
 }  // namespace val
 }  // namespace spvtools
@@ -132,5 +132,18 @@ spv_result_t BarriersPass(ValidationState_t& _, const Instruction* inst) {
   return SPV_SUCCESS;
 }
 
+bool BarriersPassAppliesTo(const spv_opcode_desc_t& entry) {
+  switch (entry.opcode) {
+    case SpvOpControlBarrier:
+    case SpvOpMemoryBarrier:
+    case SpvOpNamedBarrierInitialize:
+    case SpvOpMemoryNamedBarrier:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
 }  // namespace val
 }  // namespace spvtools
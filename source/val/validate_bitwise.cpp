@@ -215,5 +215,26 @@ spv_result_t BitwisePass(ValidationState_t& _, const Instruction* inst) {
   return SPV_SUCCESS;
 }
 
+bool BitwisePassAppliesTo(const spv_opcode_desc_t& entry) {
+  switch (entry.opcode) {
+    case SpvOpShiftRightLogical:
+    case SpvOpShiftRightArithmetic:
+    case SpvOpShiftLeftLogical:
+    case SpvOpBitwiseOr:
+    case SpvOpBitwiseXor:
+    case SpvOpBitwiseAnd:
+    case SpvOpNot:
+    case SpvOpBitFieldInsert:
+    case SpvOpBitFieldSExtract:
+    case SpvOpBitFieldUExtract:
+    case SpvOpBitReverse:
+    case SpvOpBitCount:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
 }  // namespace val
 }  // namespace spvtools
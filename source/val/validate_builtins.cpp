@@ -18,9 +18,11 @@
 
 #include "source/val/validate.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
-#include <list>
-#include <map>
+#include <iterator>
+#include <queue>
 #include <set>
 #include <sstream>
 #include <stack>
@@ -138,21 +140,66 @@ bool IsBuiltInValidForWebGPU(SpvBuiltIn label) {
 // Helper class managing validation of built-ins.
 // TODO: Generic functionality of this class can be moved into
 // ValidationState_t to be made available to other users.
+//
+// Each validator checks the built-in decorations of a single id.  Validators
+// of different ids only read the validation state, so they can run on
+// different threads at once.
 class BuiltInsValidator {
  public:
-  BuiltInsValidator(ValidationState_t& vstate) : _(vstate) {}
+  BuiltInsValidator(ValidationState_t& vstate, const Instruction& built_in_inst)
+      : _(vstate), built_in_inst_(built_in_inst) {}
 
   // Run validation.
   spv_result_t Run();
 
+  // Returns how early in the module validation failed: 0 if a definition
+  // failed, or else a number which grows with the position of the instruction
+  // and operand whose reference failed.
+  uint64_t failure_rank() const { return failure_rank_; }
+
  private:
-  // Goes through all decorations in the module, if decoration is BuiltIn
+  // A rule which validates an instruction referencing an id.
+  using AtReferenceCheck = std::function<spv_result_t(const Instruction&)>;
+
+  // The rules of an id, as a range of at_reference_checks_.
+  struct IdAtReferenceChecks {
+    uint32_t id;
+    size_t begin;
+    size_t end;
+  };
+
+  // Orders instructions so that the first in the module comes out of a
+  // priority queue first.
+  struct LaterInModule {
+    bool operator()(const Instruction* lhs, const Instruction* rhs) const {
+      return lhs->LineNum() > rhs->LineNum();
+    }
+  };
+
+  // Goes through the decorations of built_in_inst_, if decoration is BuiltIn
   // calls ValidateSingleBuiltInAtDefinition().
   spv_result_t ValidateBuiltInsAtDefinition();
 
+  // Runs the rules of every id |inst| references on |inst|.  On failure, sets
+  // failure_rank_.
+  spv_result_t ValidateAtReference(const Instruction& inst);
+
+  // Moves the rules in new_at_reference_checks_ to at_reference_checks_ as
+  // the rules of the id defined by |inst|, and schedules the instructions
+  // referencing it to be validated.  If |earlier_uses| is false, only those
+  // after |inst| are scheduled, as the others were already validated.
+  void AddAtReferenceChecks(const Instruction& inst, bool earlier_uses);
+
+  // Returns the rules of |id|, as ranges of at_reference_checks_ in the
+  // order they were added.
+  std::pair<std::vector<IdAtReferenceChecks>::const_iterator,
+            std::vector<IdAtReferenceChecks>::const_iterator>
+  FindAtReferenceChecks(uint32_t id) const;
+
   // Validates the instruction defining an id with built-in decoration.
   // Can be called multiple times for the same id, if multiple built-ins are
-  // specified. Seeds id_to_at_reference_checks_ with decorated ids if needed.
+  // specified. Seeds new_at_reference_checks_ with rules for the id if
+  // needed.
   spv_result_t ValidateSingleBuiltInAtDefinition(const Decoration& decoration,
                                                  const Instruction& inst);
 
@@ -493,18 +540,34 @@ class BuiltInsValidator {
   // UniformConstant".
   std::string GetStorageClassDesc(const Instruction& inst) const;
 
-  // Updates inner working of the class. Is called sequentially for every
-  // instruction.
+  // Updates inner working of the class. Is called for every instruction
+  // before it is validated, in module order.
   void Update(const Instruction& inst);
 
   ValidationState_t& _;
 
-  // Mapping id -> list of rules which validate instruction referencing the
-  // id. Rules can create new rules and add them to this container.
-  // Using std::map, and not std::unordered_map to avoid iterator invalidation
-  // during rehashing.
-  std::map<uint32_t, std::list<std::function<spv_result_t(const Instruction&)>>>
-      id_to_at_reference_checks_;
+  // The instruction defining the id with built-in decorations.
+  const Instruction& built_in_inst_;
+
+  // Rules which validate instructions referencing ids, grouped by id.  The
+  // rules of an id are created while validating the instruction defining it,
+  // so they are added together.
+  std::vector<AtReferenceCheck> at_reference_checks_;
+
+  // The ranges of rules of each id, sorted by id.
+  std::vector<IdAtReferenceChecks> id_at_reference_checks_;
+
+  // Rules created for the id defined by the instruction being validated.
+  // Rules create new rules and add them to this container.
+  std::vector<AtReferenceCheck> new_at_reference_checks_;
+
+  // Instructions referencing ids with rules, which remain to be validated.
+  std::priority_queue<const Instruction*, std::vector<const Instruction*>,
+                      LaterInModule>
+      instructions_to_validate_;
+
+  // See failure_rank().
+  uint64_t failure_rank_ = 0;
 
   // Id of the function we are currently inside. 0 if not inside a function.
   uint32_t function_id_ = 0;
@@ -520,28 +583,33 @@ class BuiltInsValidator {
 };
 
 void BuiltInsValidator::Update(const Instruction& inst) {
+  // Instructions are not all visited, so find the function from the
+  // instruction.  OpFunctionEnd counts as outside of its function.
   const SpvOp opcode = inst.opcode();
+  uint32_t function_id = 0;
   if (opcode == SpvOpFunction) {
-    // Entering a function.
-    assert(function_id_ == 0);
-    function_id_ = inst.id();
-    execution_models_.clear();
-    entry_points_ = &_.FunctionEntryPoints(function_id_);
-    // Collect execution models from all entry points from which the current
-    // function can be called.
-    for (const uint32_t entry_point : *entry_points_) {
-      if (const auto* models = _.GetExecutionModels(entry_point)) {
-        execution_models_.insert(models->begin(), models->end());
-      }
-    }
+    function_id = inst.id();
+  } else if (opcode != SpvOpFunctionEnd && inst.function()) {
+    function_id = inst.function()->id();
   }
+  if (function_id == function_id_) return;
 
-  if (opcode == SpvOpFunctionEnd) {
+  function_id_ = function_id;
+  execution_models_.clear();
+  if (function_id_ == 0) {
     // Exiting a function.
-    assert(function_id_ != 0);
-    function_id_ = 0;
     entry_points_ = &no_entry_points;
-    execution_models_.clear();
+    return;
+  }
+
+  // Entering a function.
+  entry_points_ = &_.FunctionEntryPoints(function_id_);
+  // Collect execution models from all entry points from which the current
+  // function can be called.
+  for (const uint32_t entry_point : *entry_points_) {
+    if (const auto* models = _.GetExecutionModels(entry_point)) {
+      execution_models_.insert(models->begin(), models->end());
+    }
   }
 }
 
@@ -931,10 +999,10 @@ spv_result_t BuiltInsValidator::ValidateNotCalledWithExecutionModel(
     }
   } else {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(
-        std::bind(&BuiltInsValidator::ValidateNotCalledWithExecutionModel, this,
-                  comment, execution_model, decoration, built_in_inst,
-                  referenced_from_inst, std::placeholders::_1));
+    new_at_reference_checks_.push_back(std::bind(
+        &BuiltInsValidator::ValidateNotCalledWithExecutionModel, this, comment,
+        execution_model, decoration, built_in_inst, referenced_from_inst,
+        std::placeholders::_1));
   }
   return SPV_SUCCESS;
 }
@@ -968,7 +1036,7 @@ spv_result_t BuiltInsValidator::ValidateClipOrCullDistanceAtReference(
 
     if (storage_class == SpvStorageClassInput) {
       assert(function_id_ == 0);
-      id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+      new_at_reference_checks_.push_back(std::bind(
           &BuiltInsValidator::ValidateNotCalledWithExecutionModel, this,
           "Vulkan spec doesn't allow BuiltIn ClipDistance/CullDistance to be "
           "used for variables with Input storage class if execution model is "
@@ -979,7 +1047,7 @@ spv_result_t BuiltInsValidator::ValidateClipOrCullDistanceAtReference(
 
     if (storage_class == SpvStorageClassOutput) {
       assert(function_id_ == 0);
-      id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+      new_at_reference_checks_.push_back(std::bind(
           &BuiltInsValidator::ValidateNotCalledWithExecutionModel, this,
           "Vulkan spec doesn't allow BuiltIn ClipDistance/CullDistance to be "
           "used for variables with Output storage class if execution model is "
@@ -1083,10 +1151,10 @@ spv_result_t BuiltInsValidator::ValidateClipOrCullDistanceAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(
-        std::bind(&BuiltInsValidator::ValidateClipOrCullDistanceAtReference,
-                  this, decoration, built_in_inst, referenced_from_inst,
-                  std::placeholders::_1));
+    new_at_reference_checks_.push_back(std::bind(
+        &BuiltInsValidator::ValidateClipOrCullDistanceAtReference, this,
+        decoration, built_in_inst, referenced_from_inst,
+        std::placeholders::_1));
   }
 
   return SPV_SUCCESS;
@@ -1146,7 +1214,7 @@ spv_result_t BuiltInsValidator::ValidateFragCoordAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+    new_at_reference_checks_.push_back(std::bind(
         &BuiltInsValidator::ValidateFragCoordAtReference, this, decoration,
         built_in_inst, referenced_from_inst, std::placeholders::_1));
   }
@@ -1222,7 +1290,7 @@ spv_result_t BuiltInsValidator::ValidateFragDepthAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+    new_at_reference_checks_.push_back(std::bind(
         &BuiltInsValidator::ValidateFragDepthAtReference, this, decoration,
         built_in_inst, referenced_from_inst, std::placeholders::_1));
   }
@@ -1283,7 +1351,7 @@ spv_result_t BuiltInsValidator::ValidateFrontFacingAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+    new_at_reference_checks_.push_back(std::bind(
         &BuiltInsValidator::ValidateFrontFacingAtReference, this, decoration,
         built_in_inst, referenced_from_inst, std::placeholders::_1));
   }
@@ -1342,10 +1410,10 @@ spv_result_t BuiltInsValidator::ValidateHelperInvocationAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(
-        std::bind(&BuiltInsValidator::ValidateHelperInvocationAtReference, this,
-                  decoration, built_in_inst, referenced_from_inst,
-                  std::placeholders::_1));
+    new_at_reference_checks_.push_back(std::bind(
+        &BuiltInsValidator::ValidateHelperInvocationAtReference, this,
+        decoration, built_in_inst, referenced_from_inst,
+        std::placeholders::_1));
   }
 
   return SPV_SUCCESS;
@@ -1403,7 +1471,7 @@ spv_result_t BuiltInsValidator::ValidateInvocationIdAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+    new_at_reference_checks_.push_back(std::bind(
         &BuiltInsValidator::ValidateInvocationIdAtReference, this, decoration,
         built_in_inst, referenced_from_inst, std::placeholders::_1));
   }
@@ -1464,7 +1532,7 @@ spv_result_t BuiltInsValidator::ValidateInstanceIndexAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+    new_at_reference_checks_.push_back(std::bind(
         &BuiltInsValidator::ValidateInstanceIndexAtReference, this, decoration,
         built_in_inst, referenced_from_inst, std::placeholders::_1));
   }
@@ -1525,7 +1593,7 @@ spv_result_t BuiltInsValidator::ValidatePatchVerticesAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+    new_at_reference_checks_.push_back(std::bind(
         &BuiltInsValidator::ValidatePatchVerticesAtReference, this, decoration,
         built_in_inst, referenced_from_inst, std::placeholders::_1));
   }
@@ -1585,7 +1653,7 @@ spv_result_t BuiltInsValidator::ValidatePointCoordAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+    new_at_reference_checks_.push_back(std::bind(
         &BuiltInsValidator::ValidatePointCoordAtReference, this, decoration,
         built_in_inst, referenced_from_inst, std::placeholders::_1));
   }
@@ -1619,13 +1687,13 @@ spv_result_t BuiltInsValidator::ValidatePointSizeAtReference(
 
     if (storage_class == SpvStorageClassInput) {
       assert(function_id_ == 0);
-      id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+      new_at_reference_checks_.push_back(std::bind(
           &BuiltInsValidator::ValidateNotCalledWithExecutionModel, this,
           std::string(
-              _.VkErrorID(4315) +
-              "Vulkan spec doesn't allow BuiltIn PointSize to be used for "
-              "variables with Input storage class if execution model is "
-              "Vertex."),
+          _.VkErrorID(4315) +
+          "Vulkan spec doesn't allow BuiltIn PointSize to be used for "
+          "variables with Input storage class if execution model is "
+          "Vertex."),
           SpvExecutionModelVertex, decoration, built_in_inst,
           referenced_from_inst, std::placeholders::_1));
     }
@@ -1704,7 +1772,7 @@ spv_result_t BuiltInsValidator::ValidatePointSizeAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+    new_at_reference_checks_.push_back(std::bind(
         &BuiltInsValidator::ValidatePointSizeAtReference, this, decoration,
         built_in_inst, referenced_from_inst, std::placeholders::_1));
   }
@@ -1737,12 +1805,12 @@ spv_result_t BuiltInsValidator::ValidatePositionAtReference(
 
     if (storage_class == SpvStorageClassInput) {
       assert(function_id_ == 0);
-      id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+      new_at_reference_checks_.push_back(std::bind(
           &BuiltInsValidator::ValidateNotCalledWithExecutionModel, this,
           std::string(_.VkErrorID(4320) +
-                      "Vulkan spec doesn't allow BuiltIn Position to be used "
-                      "for variables "
-                      "with Input storage class if execution model is Vertex."),
+          "Vulkan spec doesn't allow BuiltIn Position to be used "
+          "for variables "
+          "with Input storage class if execution model is Vertex."),
           SpvExecutionModelVertex, decoration, built_in_inst,
           referenced_from_inst, std::placeholders::_1));
     }
@@ -1864,7 +1932,7 @@ spv_result_t BuiltInsValidator::ValidatePositionAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+    new_at_reference_checks_.push_back(std::bind(
         &BuiltInsValidator::ValidatePositionAtReference, this, decoration,
         built_in_inst, referenced_from_inst, std::placeholders::_1));
   }
@@ -1928,31 +1996,31 @@ spv_result_t BuiltInsValidator::ValidatePrimitiveIdAtReference(
 
     if (storage_class == SpvStorageClassOutput) {
       assert(function_id_ == 0);
-      id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+      new_at_reference_checks_.push_back(std::bind(
           &BuiltInsValidator::ValidateNotCalledWithExecutionModel, this,
           std::string(
-              _.VkErrorID(4334) +
-              "Vulkan spec doesn't allow BuiltIn PrimitiveId to be used for "
-              "variables with Output storage class if execution model is "
-              "TessellationControl."),
+          _.VkErrorID(4334) +
+          "Vulkan spec doesn't allow BuiltIn PrimitiveId to be used for "
+          "variables with Output storage class if execution model is "
+          "TessellationControl."),
           SpvExecutionModelTessellationControl, decoration, built_in_inst,
           referenced_from_inst, std::placeholders::_1));
-      id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+      new_at_reference_checks_.push_back(std::bind(
           &BuiltInsValidator::ValidateNotCalledWithExecutionModel, this,
           std::string(
-              _.VkErrorID(4334) +
-              "Vulkan spec doesn't allow BuiltIn PrimitiveId to be used for "
-              "variables with Output storage class if execution model is "
-              "TessellationEvaluation."),
+          _.VkErrorID(4334) +
+          "Vulkan spec doesn't allow BuiltIn PrimitiveId to be used for "
+          "variables with Output storage class if execution model is "
+          "TessellationEvaluation."),
           SpvExecutionModelTessellationEvaluation, decoration, built_in_inst,
           referenced_from_inst, std::placeholders::_1));
-      id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+      new_at_reference_checks_.push_back(std::bind(
           &BuiltInsValidator::ValidateNotCalledWithExecutionModel, this,
           std::string(
-              _.VkErrorID(4334) +
-              "Vulkan spec doesn't allow BuiltIn PrimitiveId to be used for "
-              "variables with Output storage class if execution model is "
-              "Fragment."),
+          _.VkErrorID(4334) +
+          "Vulkan spec doesn't allow BuiltIn PrimitiveId to be used for "
+          "variables with Output storage class if execution model is "
+          "Fragment."),
           SpvExecutionModelFragment, decoration, built_in_inst,
           referenced_from_inst, std::placeholders::_1));
     }
@@ -1989,7 +2057,7 @@ spv_result_t BuiltInsValidator::ValidatePrimitiveIdAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+    new_at_reference_checks_.push_back(std::bind(
         &BuiltInsValidator::ValidatePrimitiveIdAtReference, this, decoration,
         built_in_inst, referenced_from_inst, std::placeholders::_1));
   }
@@ -2048,7 +2116,7 @@ spv_result_t BuiltInsValidator::ValidateSampleIdAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+    new_at_reference_checks_.push_back(std::bind(
         &BuiltInsValidator::ValidateSampleIdAtReference, this, decoration,
         built_in_inst, referenced_from_inst, std::placeholders::_1));
   }
@@ -2109,7 +2177,7 @@ spv_result_t BuiltInsValidator::ValidateSampleMaskAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+    new_at_reference_checks_.push_back(std::bind(
         &BuiltInsValidator::ValidateSampleMaskAtReference, this, decoration,
         built_in_inst, referenced_from_inst, std::placeholders::_1));
   }
@@ -2171,7 +2239,7 @@ spv_result_t BuiltInsValidator::ValidateSamplePositionAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+    new_at_reference_checks_.push_back(std::bind(
         &BuiltInsValidator::ValidateSamplePositionAtReference, this, decoration,
         built_in_inst, referenced_from_inst, std::placeholders::_1));
   }
@@ -2231,7 +2299,7 @@ spv_result_t BuiltInsValidator::ValidateTessCoordAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+    new_at_reference_checks_.push_back(std::bind(
         &BuiltInsValidator::ValidateTessCoordAtReference, this, decoration,
         built_in_inst, referenced_from_inst, std::placeholders::_1));
   }
@@ -2304,7 +2372,7 @@ spv_result_t BuiltInsValidator::ValidateTessLevelAtReference(
 
     if (storage_class == SpvStorageClassInput) {
       assert(function_id_ == 0);
-      id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+      new_at_reference_checks_.push_back(std::bind(
           &BuiltInsValidator::ValidateNotCalledWithExecutionModel, this,
           "Vulkan spec doesn't allow TessLevelOuter/TessLevelInner to be "
           "used "
@@ -2316,7 +2384,7 @@ spv_result_t BuiltInsValidator::ValidateTessLevelAtReference(
 
     if (storage_class == SpvStorageClassOutput) {
       assert(function_id_ == 0);
-      id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+      new_at_reference_checks_.push_back(std::bind(
           &BuiltInsValidator::ValidateNotCalledWithExecutionModel, this,
           "Vulkan spec doesn't allow TessLevelOuter/TessLevelInner to be "
           "used "
@@ -2351,7 +2419,7 @@ spv_result_t BuiltInsValidator::ValidateTessLevelAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+    new_at_reference_checks_.push_back(std::bind(
         &BuiltInsValidator::ValidateTessLevelAtReference, this, decoration,
         built_in_inst, referenced_from_inst, std::placeholders::_1));
   }
@@ -2426,7 +2494,7 @@ spv_result_t BuiltInsValidator::ValidateInstanceIdAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+    new_at_reference_checks_.push_back(std::bind(
         &BuiltInsValidator::ValidateInstanceIdAtReference, this, decoration,
         built_in_inst, referenced_from_inst, std::placeholders::_1));
   }
@@ -2483,10 +2551,10 @@ spv_result_t BuiltInsValidator::ValidateLocalInvocationIndexAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(
-        std::bind(&BuiltInsValidator::ValidateLocalInvocationIndexAtReference,
-                  this, decoration, built_in_inst, referenced_from_inst,
-                  std::placeholders::_1));
+    new_at_reference_checks_.push_back(std::bind(
+        &BuiltInsValidator::ValidateLocalInvocationIndexAtReference, this,
+        decoration, built_in_inst, referenced_from_inst,
+        std::placeholders::_1));
   }
 
   return SPV_SUCCESS;
@@ -2524,7 +2592,7 @@ spv_result_t BuiltInsValidator::ValidateVertexIndexAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+    new_at_reference_checks_.push_back(std::bind(
         &BuiltInsValidator::ValidateVertexIndexAtReference, this, decoration,
         built_in_inst, referenced_from_inst, std::placeholders::_1));
   }
@@ -2605,22 +2673,21 @@ spv_result_t BuiltInsValidator::ValidateLayerOrViewportIndexAtReference(
       for (const auto em :
            {SpvExecutionModelVertex, SpvExecutionModelTessellationEvaluation,
             SpvExecutionModelGeometry}) {
-        id_to_at_reference_checks_[referenced_from_inst.id()].push_back(
-            std::bind(&BuiltInsValidator::ValidateNotCalledWithExecutionModel,
-                      this,
-                      "Vulkan spec doesn't allow BuiltIn Layer and "
-                      "ViewportIndex to be "
-                      "used for variables with Input storage class if "
-                      "execution model is Vertex, TessellationEvaluation, or "
-                      "Geometry.",
-                      em, decoration, built_in_inst, referenced_from_inst,
-                      std::placeholders::_1));
+        new_at_reference_checks_.push_back(std::bind(
+            &BuiltInsValidator::ValidateNotCalledWithExecutionModel, this,
+            "Vulkan spec doesn't allow BuiltIn Layer and "
+            "ViewportIndex to be "
+            "used for variables with Input storage class if "
+            "execution model is Vertex, TessellationEvaluation, or "
+            "Geometry.",
+            em, decoration, built_in_inst, referenced_from_inst,
+            std::placeholders::_1));
       }
     }
 
     if (storage_class == SpvStorageClassOutput) {
       assert(function_id_ == 0);
-      id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+      new_at_reference_checks_.push_back(std::bind(
           &BuiltInsValidator::ValidateNotCalledWithExecutionModel, this,
           "Vulkan spec doesn't allow BuiltIn Layer and "
           "ViewportIndex to be "
@@ -2667,10 +2734,10 @@ spv_result_t BuiltInsValidator::ValidateLayerOrViewportIndexAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(
-        std::bind(&BuiltInsValidator::ValidateLayerOrViewportIndexAtReference,
-                  this, decoration, built_in_inst, referenced_from_inst,
-                  std::placeholders::_1));
+    new_at_reference_checks_.push_back(std::bind(
+        &BuiltInsValidator::ValidateLayerOrViewportIndexAtReference, this,
+        decoration, built_in_inst, referenced_from_inst,
+        std::placeholders::_1));
   }
 
   return SPV_SUCCESS;
@@ -2790,7 +2857,7 @@ spv_result_t BuiltInsValidator::ValidateComputeShaderI32Vec3InputAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+    new_at_reference_checks_.push_back(std::bind(
         &BuiltInsValidator::ValidateComputeShaderI32Vec3InputAtReference, this,
         decoration, built_in_inst, referenced_from_inst,
         std::placeholders::_1));
@@ -2869,10 +2936,10 @@ spv_result_t BuiltInsValidator::ValidateComputeI32InputAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(
-        std::bind(&BuiltInsValidator::ValidateComputeI32InputAtReference, this,
-                  decoration, built_in_inst, referenced_from_inst,
-                  std::placeholders::_1));
+    new_at_reference_checks_.push_back(std::bind(
+        &BuiltInsValidator::ValidateComputeI32InputAtReference, this,
+        decoration, built_in_inst, referenced_from_inst,
+        std::placeholders::_1));
   }
 
   return SPV_SUCCESS;
@@ -3016,7 +3083,7 @@ spv_result_t BuiltInsValidator::ValidateWorkgroupSizeAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+    new_at_reference_checks_.push_back(std::bind(
         &BuiltInsValidator::ValidateWorkgroupSizeAtReference, this, decoration,
         built_in_inst, referenced_from_inst, std::placeholders::_1));
   }
@@ -3085,10 +3152,10 @@ spv_result_t BuiltInsValidator::ValidateBaseInstanceOrVertexAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(
-        std::bind(&BuiltInsValidator::ValidateBaseInstanceOrVertexAtReference,
-                  this, decoration, built_in_inst, referenced_from_inst,
-                  std::placeholders::_1));
+    new_at_reference_checks_.push_back(std::bind(
+        &BuiltInsValidator::ValidateBaseInstanceOrVertexAtReference, this,
+        decoration, built_in_inst, referenced_from_inst,
+        std::placeholders::_1));
   }
 
   return SPV_SUCCESS;
@@ -3153,7 +3220,7 @@ spv_result_t BuiltInsValidator::ValidateDrawIndexAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+    new_at_reference_checks_.push_back(std::bind(
         &BuiltInsValidator::ValidateDrawIndexAtReference, this, decoration,
         built_in_inst, referenced_from_inst, std::placeholders::_1));
   }
@@ -3217,7 +3284,7 @@ spv_result_t BuiltInsValidator::ValidateViewIndexAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+    new_at_reference_checks_.push_back(std::bind(
         &BuiltInsValidator::ValidateViewIndexAtReference, this, decoration,
         built_in_inst, referenced_from_inst, std::placeholders::_1));
   }
@@ -3269,7 +3336,7 @@ spv_result_t BuiltInsValidator::ValidateDeviceIndexAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+    new_at_reference_checks_.push_back(std::bind(
         &BuiltInsValidator::ValidateDeviceIndexAtReference, this, decoration,
         built_in_inst, referenced_from_inst, std::placeholders::_1));
   }
@@ -3324,7 +3391,7 @@ spv_result_t BuiltInsValidator::ValidateSMBuiltinsAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+    new_at_reference_checks_.push_back(std::bind(
         &BuiltInsValidator::ValidateSMBuiltinsAtReference, this, decoration,
         built_in_inst, referenced_from_inst, std::placeholders::_1));
   }
@@ -3395,10 +3462,10 @@ spv_result_t BuiltInsValidator::ValidatePrimitiveShadingRateAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(
-        std::bind(&BuiltInsValidator::ValidatePrimitiveShadingRateAtReference,
-                  this, decoration, built_in_inst, referenced_from_inst,
-                  std::placeholders::_1));
+    new_at_reference_checks_.push_back(std::bind(
+        &BuiltInsValidator::ValidatePrimitiveShadingRateAtReference, this,
+        decoration, built_in_inst, referenced_from_inst,
+        std::placeholders::_1));
   }
 
   return SPV_SUCCESS;
@@ -3460,7 +3527,7 @@ spv_result_t BuiltInsValidator::ValidateShadingRateAtReference(
 
   if (function_id_ == 0) {
     // Propagate this rule to all dependant ids in the global scope.
-    id_to_at_reference_checks_[referenced_from_inst.id()].push_back(std::bind(
+    new_at_reference_checks_.push_back(std::bind(
         &BuiltInsValidator::ValidateShadingRateAtReference, this, decoration,
         built_in_inst, referenced_from_inst, std::placeholders::_1));
   }
@@ -3679,24 +3746,55 @@ spv_result_t BuiltInsValidator::ValidateSingleBuiltInAtDefinition(
 }
 
 spv_result_t BuiltInsValidator::ValidateBuiltInsAtDefinition() {
-  for (const auto& kv : _.id_decorations()) {
-    const uint32_t id = kv.first;
-    const auto& decorations = kv.second;
-    if (decorations.empty()) {
+  for (const auto& decoration : _.FindDecorations(built_in_inst_.id())) {
+    if (decoration.dec_type() != SpvDecorationBuiltIn) {
       continue;
     }
 
-    const Instruction* inst = _.FindDef(id);
-    assert(inst);
+    if (spv_result_t error =
+            ValidateSingleBuiltInAtDefinition(decoration, built_in_inst_)) {
+      return error;
+    }
+  }
 
-    for (const auto& decoration : kv.second) {
-      if (decoration.dec_type() != SpvDecorationBuiltIn) {
-        continue;
-      }
+  return SPV_SUCCESS;
+}
 
-      if (spv_result_t error =
-              ValidateSingleBuiltInAtDefinition(decoration, *inst)) {
-        return error;
+spv_result_t BuiltInsValidator::ValidateAtReference(const Instruction& inst) {
+  std::vector<uint32_t> already_checked;
+
+  const auto operands = inst.operands();
+  for (size_t operand_index = 0; operand_index < operands.size();
+       ++operand_index) {
+    const auto& operand = operands[operand_index];
+    if (!spvIsIdType(operand.type)) {
+      // Not id.
+      continue;
+    }
+
+    const uint32_t id = inst.word(operand.offset);
+    if (id == inst.id()) {
+      // No need to check result id.
+      continue;
+    }
+
+    if (std::find(already_checked.begin(), already_checked.end(), id) !=
+        already_checked.end()) {
+      // The instruction has already referenced this id.
+      continue;
+    }
+    already_checked.push_back(id);
+
+    // Instruction references the id. Run all checks associated with the id
+    // on the instruction. New rules go to new_at_reference_checks_, so
+    // at_reference_checks_ is not modified in the process.
+    const auto checks = FindAtReferenceChecks(id);
+    for (auto range = checks.first; range != checks.second; ++range) {
+      for (size_t i = range->begin; i < range->end; ++i) {
+        if (spv_result_t error = at_reference_checks_[i](inst)) {
+          failure_rank_ = uint64_t(inst.LineNum()) << 32 | operand_index;
+          return error;
+        }
       }
     }
   }
@@ -3704,54 +3802,76 @@ spv_result_t BuiltInsValidator::ValidateBuiltInsAtDefinition() {
   return SPV_SUCCESS;
 }
 
-spv_result_t BuiltInsValidator::Run() {
-  // First pass: validate all built-ins at definition and seed
-  // id_to_at_reference_checks_ with built-ins.
-  if (auto error = ValidateBuiltInsAtDefinition()) {
-    return error;
-  }
-
-  if (id_to_at_reference_checks_.empty()) {
-    // No validation tasks were seeded. Nothing else to do.
-    return SPV_SUCCESS;
+void BuiltInsValidator::AddAtReferenceChecks(const Instruction& inst,
+                                             bool earlier_uses) {
+  if (new_at_reference_checks_.empty()) return;
+  if (inst.id() == 0) {
+    // Nothing can reference the instruction.
+    new_at_reference_checks_.clear();
+    return;
   }
 
-  // Second pass: validate every id reference in the module using
-  // rules in id_to_at_reference_checks_.
-  for (const Instruction& inst : _.ordered_instructions()) {
-    Update(inst);
+  const size_t begin = at_reference_checks_.size();
+  std::move(new_at_reference_checks_.begin(), new_at_reference_checks_.end(),
+            std::back_inserter(at_reference_checks_));
+  new_at_reference_checks_.clear();
+  const IdAtReferenceChecks checks = {inst.id(), begin,
+                                      at_reference_checks_.size()};
+  const auto position = std::upper_bound(
+      id_at_reference_checks_.begin(), id_at_reference_checks_.end(), checks,
+      [](const IdAtReferenceChecks& lhs, const IdAtReferenceChecks& rhs) {
+        return lhs.id < rhs.id;
+      });
+  id_at_reference_checks_.insert(position, checks);
 
-    std::set<uint32_t> already_checked;
+  for (const auto& use : inst.uses()) {
+    if (earlier_uses || use.first->LineNum() > inst.LineNum()) {
+      instructions_to_validate_.push(use.first);
+    }
+  }
+}
 
-    for (const auto& operand : inst.operands()) {
-      if (!spvIsIdType(operand.type)) {
-        // Not id.
-        continue;
-      }
+std::pair<std::vector<BuiltInsValidator::IdAtReferenceChecks>::const_iterator,
+          std::vector<BuiltInsValidator::IdAtReferenceChecks>::const_iterator>
+BuiltInsValidator::FindAtReferenceChecks(uint32_t id) const {
+  const IdAtReferenceChecks key = {id, 0, 0};
+  return std::equal_range(
+      id_at_reference_checks_.begin(), id_at_reference_checks_.end(), key,
+      [](const IdAtReferenceChecks& lhs, const IdAtReferenceChecks& rhs) {
+        return lhs.id < rhs.id;
+      });
+}
 
-      const uint32_t id = inst.word(operand.offset);
-      if (id == inst.id()) {
-        // No need to check result id.
-        continue;
-      }
+spv_result_t BuiltInsValidator::Run() {
+  // First pass: validate the built-ins at definition and seed
+  // at_reference_checks_ with rules for the built-in id.
+  if (auto error = ValidateBuiltInsAtDefinition()) {
+    return error;
+  }
 
-      if (!already_checked.insert(id).second) {
-        // The instruction has already referenced this id.
-        continue;
-      }
+  // Instructions before the definition, such as decorations, reference the
+  // built-in id as well.
+  AddAtReferenceChecks(built_in_inst_, /* earlier_uses = */ true);
+
+  // Second pass: validate every instruction referencing an id with rules, in
+  // module order.  Rules only create rules for the id of the instruction they
+  // validate, so only instructions referencing that id are added, and all
+  // of them come later in the module.
+  const Instruction* previous = nullptr;
+  while (!instructions_to_validate_.empty()) {
+    const Instruction* inst = instructions_to_validate_.top();
+    instructions_to_validate_.pop();
+    if (inst == previous) {
+      // The instruction references more than one id with rules.
+      continue;
+    }
+    previous = inst;
 
-      // Instruction references the id. Run all checks associated with the id
-      // on the instruction. id_to_at_reference_checks_ can be modified in the
-      // process, iterators are safe because it's a tree-based map.
-      const auto it = id_to_at_reference_checks_.find(id);
-      if (it != id_to_at_reference_checks_.end()) {
-        for (const auto& check : it->second) {
-          if (spv_result_t error = check(inst)) {
-            return error;
-          }
-        }
-      }
+    Update(*inst);
+    if (auto error = ValidateAtReference(*inst)) {
+      return error;
     }
+    AddAtReferenceChecks(*inst, /* earlier_uses = */ false);
   }
 
   return SPV_SUCCESS;
@@ -3761,8 +3881,32 @@ spv_result_t BuiltInsValidator::Run() {
 
 // Validates correctness of built-in variables.
 spv_result_t ValidateBuiltIns(ValidationState_t& _) {
-  BuiltInsValidator validator(_);
-  return validator.Run();
+  std::vector<const Instruction*> built_in_insts;
+  for (uint32_t id = 1; id < _.decorated_id_bound(); ++id) {
+    for (const auto& decoration : _.FindDecorations(id)) {
+      if (decoration.dec_type() == SpvDecorationBuiltIn) {
+        const Instruction* inst = _.FindDef(id);
+        assert(inst);
+        built_in_insts.push_back(inst);
+        break;
+      }
+    }
+  }
+
+  // Each id is validated on its own, possibly on different threads.  The
+  // failure reported is the one validating all ids together would find
+  // first: a failed definition, in order of ids, or else the failed
+  // reference that comes first in the module.
+  std::vector<uint64_t> failure_ranks(built_in_insts.size(), 0);
+  return RunShards(
+      _, built_in_insts.size(), NumCheckThreads(_),
+      [&_, &built_in_insts, &failure_ranks](size_t i) {
+        BuiltInsValidator validator(_, *built_in_insts[i]);
+        const spv_result_t result = validator.Run();
+        failure_ranks[i] = validator.failure_rank();
+        return result;
+      },
+      [&failure_ranks](size_t i) { return failure_ranks[i]; });
 }
 
 }  // namespace val
@@ -327,6 +327,78 @@ spv_result_t ValidateLoopMerge(ValidationState_t& _, const Instruction* inst) {
   return SPV_SUCCESS;
 }
 
+// Numbers the blocks of |function| in a depth first traversal of the forest
+// in which |parent| returns the parent of each block, and passes each block
+// with the root of its tree and its preorder and postorder numbers to
+// |set_position|.  A block without a parent, or that is its own parent, is a
+// root.  A block is then an ancestor of another exactly when they share a
+// root and its interval of numbers contains the other's.
+void NumberTree(
+    Function* function, const std::function<BasicBlock*(BasicBlock*)>& parent,
+    const std::function<void(BasicBlock*, const BasicBlock*, uint32_t,
+                             uint32_t)>& set_position) {
+  std::vector<BasicBlock*> nodes(function->ordered_blocks());
+  nodes.push_back(function->pseudo_entry_block());
+  nodes.push_back(function->pseudo_exit_block());
+  std::unordered_map<const BasicBlock*, uint32_t> index;
+  for (uint32_t i = 0; i < nodes.size(); ++i) index.emplace(nodes[i], i);
+  // Parents are in the function, but take any that are not into account so
+  // that the numbering agrees with walking the parents.
+  for (uint32_t i = 0; i < nodes.size(); ++i) {
+    BasicBlock* p = parent(nodes[i]);
+    if (p && index.emplace(p, uint32_t(nodes.size())).second) {
+      nodes.push_back(p);
+    }
+  }
+
+  // Lay the children of each node out contiguously.
+  const uint32_t num_nodes = uint32_t(nodes.size());
+  std::vector<uint32_t> parent_index(num_nodes, num_nodes);
+  std::vector<uint32_t> child_begin(num_nodes + 1, 0);
+  for (uint32_t i = 0; i < num_nodes; ++i) {
+    BasicBlock* p = parent(nodes[i]);
+    if (p && p != nodes[i]) {
+      parent_index[i] = index[p];
+      ++child_begin[parent_index[i] + 1];
+    }
+  }
+  for (uint32_t i = 0; i < num_nodes; ++i) {
+    child_begin[i + 1] += child_begin[i];
+  }
+  std::vector<uint32_t> children(child_begin[num_nodes]);
+  std::vector<uint32_t> next_child(child_begin.begin(), child_begin.end() - 1);
+  for (uint32_t i = 0; i < num_nodes; ++i) {
+    if (parent_index[i] != num_nodes) {
+      children[next_child[parent_index[i]]++] = i;
+    }
+  }
+
+  std::vector<uint32_t> preorder(num_nodes);
+  std::vector<uint32_t> stack;
+  uint32_t preorder_count = 0;
+  uint32_t postorder_count = 0;
+  for (uint32_t root = 0; root < num_nodes; ++root) {
+    if (parent_index[root] != num_nodes) continue;
+    // Reuse next_child as the cursor over the children of each node.
+    next_child[root] = child_begin[root];
+    preorder[root] = preorder_count++;
+    stack.push_back(root);
+    while (!stack.empty()) {
+      const uint32_t node = stack.back();
+      if (next_child[node] != child_begin[node + 1]) {
+        const uint32_t child = children[next_child[node]++];
+        next_child[child] = child_begin[child];
+        preorder[child] = preorder_count++;
+        stack.push_back(child);
+      } else {
+        stack.pop_back();
+        set_position(nodes[node], nodes[root], preorder[node],
+                     postorder_count++);
+      }
+    }
+  }
+}
+
 }  // namespace
 
 void printDominatorList(const BasicBlock& b) {
@@ -930,116 +1002,132 @@ spv_result_t PerformWebGPUCfgChecks(ValidationState_t& _, Function* function) {
   return SPV_SUCCESS;
 }
 
-spv_result_t PerformCfgChecks(ValidationState_t& _) {
-  for (auto& function : _.functions()) {
-    // Check all referenced blocks are defined within a function
-    if (function.undefined_block_count() != 0) {
-      std::string undef_blocks("{");
-      bool first = true;
-      for (auto undefined_block : function.undefined_blocks()) {
-        undef_blocks += _.getIdName(undefined_block);
-        if (!first) {
-          undef_blocks += " ";
-        }
-        first = false;
+spv_result_t PerformCfgChecks(ValidationState_t& _, Function* function) {
+  // Check all referenced blocks are defined within a function
+  if (function->undefined_block_count() != 0) {
+    std::string undef_blocks("{");
+    bool first = true;
+    for (auto undefined_block : function->undefined_blocks()) {
+      undef_blocks += _.getIdName(undefined_block);
+      if (!first) {
+        undef_blocks += " ";
       }
-      return _.diag(SPV_ERROR_INVALID_CFG, _.FindDef(function.id()))
-             << "Block(s) " << undef_blocks << "}"
-             << " are referenced but not defined in function "
-             << _.getIdName(function.id());
+      first = false;
     }
+    return _.diag(SPV_ERROR_INVALID_CFG, _.FindDef(function->id()))
+           << "Block(s) " << undef_blocks << "}"
+           << " are referenced but not defined in function "
+           << _.getIdName(function->id());
+  }
 
-    // Set each block's immediate dominator and immediate postdominator,
-    // and find all back-edges.
-    //
-    // We want to analyze all the blocks in the function, even in degenerate
-    // control flow cases including unreachable blocks.  So use the augmented
-    // CFG to ensure we cover all the blocks.
-    std::vector<const BasicBlock*> postorder;
-    std::vector<const BasicBlock*> postdom_postorder;
-    std::vector<std::pair<uint32_t, uint32_t>> back_edges;
-    auto ignore_block = [](const BasicBlock*) {};
-    auto ignore_edge = [](const BasicBlock*, const BasicBlock*) {};
-    if (!function.ordered_blocks().empty()) {
-      /// calculate dominators
-      CFA<BasicBlock>::DepthFirstTraversal(
-          function.first_block(), function.AugmentedCFGSuccessorsFunction(),
-          ignore_block, [&](const BasicBlock* b) { postorder.push_back(b); },
-          ignore_edge);
-      auto edges = CFA<BasicBlock>::CalculateDominators(
-          postorder, function.AugmentedCFGPredecessorsFunction());
-      for (auto edge : edges) {
-        if (edge.first != edge.second)
-          edge.first->SetImmediateDominator(edge.second);
-      }
+  // Set each block's immediate dominator and immediate postdominator,
+  // and find all back-edges.
+  //
+  // We want to analyze all the blocks in the function, even in degenerate
+  // control flow cases including unreachable blocks.  So use the augmented
+  // CFG to ensure we cover all the blocks.
+  std::vector<const BasicBlock*> postorder;
+  std::vector<const BasicBlock*> postdom_postorder;
+  std::vector<std::pair<uint32_t, uint32_t>> back_edges;
+  auto ignore_block = [](const BasicBlock*) {};
+  auto ignore_edge = [](const BasicBlock*, const BasicBlock*) {};
+  if (!function->ordered_blocks().empty()) {
+    /// calculate dominators
+    CFA<BasicBlock>::DepthFirstTraversal(
+        function->first_block(), function->AugmentedCFGSuccessorsFunction(),
+        ignore_block, [&](const BasicBlock* b) { postorder.push_back(b); },
+        ignore_edge);
+    auto edges = CFA<BasicBlock>::CalculateDominators(
+        postorder, function->AugmentedCFGPredecessorsFunction());
+    for (auto edge : edges) {
+      if (edge.first != edge.second)
+        edge.first->SetImmediateDominator(edge.second);
+    }
 
-      /// calculate post dominators
-      CFA<BasicBlock>::DepthFirstTraversal(
-          function.pseudo_exit_block(),
-          function.AugmentedCFGPredecessorsFunction(), ignore_block,
-          [&](const BasicBlock* b) { postdom_postorder.push_back(b); },
-          ignore_edge);
-      auto postdom_edges = CFA<BasicBlock>::CalculateDominators(
-          postdom_postorder, function.AugmentedCFGSuccessorsFunction());
-      for (auto edge : postdom_edges) {
-        edge.first->SetImmediatePostDominator(edge.second);
-      }
-      /// calculate back edges.
-      CFA<BasicBlock>::DepthFirstTraversal(
-          function.pseudo_entry_block(),
-          function
-              .AugmentedCFGSuccessorsFunctionIncludingHeaderToContinueEdge(),
-          ignore_block, ignore_block,
-          [&](const BasicBlock* from, const BasicBlock* to) {
-            back_edges.emplace_back(from->id(), to->id());
-          });
+    /// calculate post dominators
+    CFA<BasicBlock>::DepthFirstTraversal(
+        function->pseudo_exit_block(),
+        function->AugmentedCFGPredecessorsFunction(), ignore_block,
+        [&](const BasicBlock* b) { postdom_postorder.push_back(b); },
+        ignore_edge);
+    auto postdom_edges = CFA<BasicBlock>::CalculateDominators(
+        postdom_postorder, function->AugmentedCFGSuccessorsFunction());
+    for (auto edge : postdom_edges) {
+      edge.first->SetImmediatePostDominator(edge.second);
     }
-    UpdateContinueConstructExitBlocks(function, back_edges);
-
-    auto& blocks = function.ordered_blocks();
-    if (!blocks.empty()) {
-      // Check if the order of blocks in the binary appear before the blocks
-      // they dominate
-      for (auto block = begin(blocks) + 1; block != end(blocks); ++block) {
-        if (auto idom = (*block)->immediate_dominator()) {
-          if (idom != function.pseudo_entry_block() &&
-              block == std::find(begin(blocks), block, idom)) {
-            return _.diag(SPV_ERROR_INVALID_CFG, _.FindDef(idom->id()))
-                   << "Block " << _.getIdName((*block)->id())
-                   << " appears in the binary before its dominator "
-                   << _.getIdName(idom->id());
-          }
-        }
 
-        // For WebGPU check that all unreachable blocks are degenerate cases for
-        // merge-block or continue-target.
-        if (spvIsWebGPUEnv(_.context()->target_env)) {
-          spv_result_t result = PerformWebGPUCfgChecks(_, &function);
-          if (result != SPV_SUCCESS) return result;
+    /// number the dominator trees so that dominance takes constant time
+    NumberTree(
+        function, [](BasicBlock* b) { return b->immediate_dominator(); },
+        [](BasicBlock* b, const BasicBlock* root, uint32_t pre,
+           uint32_t post) { b->SetDominatorTreePosition(root, pre, post); });
+    NumberTree(
+        function, [](BasicBlock* b) { return b->immediate_post_dominator(); },
+        [](BasicBlock* b, const BasicBlock* root, uint32_t pre,
+           uint32_t post) {
+          b->SetPostDominatorTreePosition(root, pre, post);
+        });
+    /// calculate back edges.
+    CFA<BasicBlock>::DepthFirstTraversal(
+        function->pseudo_entry_block(),
+        function->AugmentedCFGSuccessorsFunctionIncludingHeaderToContinueEdge(),
+        ignore_block, ignore_block,
+        [&](const BasicBlock* from, const BasicBlock* to) {
+          back_edges.emplace_back(from->id(), to->id());
+        });
+  }
+  UpdateContinueConstructExitBlocks(*function, back_edges);
+
+  auto& blocks = function->ordered_blocks();
+  if (!blocks.empty()) {
+    // Check if the order of blocks in the binary appear before the blocks
+    // they dominate
+    for (auto block = begin(blocks) + 1; block != end(blocks); ++block) {
+      if (auto idom = (*block)->immediate_dominator()) {
+        if (idom != function->pseudo_entry_block() &&
+            block == std::find(begin(blocks), block, idom)) {
+          return _.diag(SPV_ERROR_INVALID_CFG, _.FindDef(idom->id()))
+                 << "Block " << _.getIdName((*block)->id())
+                 << " appears in the binary before its dominator "
+                 << _.getIdName(idom->id());
         }
       }
-      // If we have structed control flow, check that no block has a control
-      // flow nesting depth larger than the limit.
-      if (_.HasCapability(SpvCapabilityShader)) {
-        const int control_flow_nesting_depth_limit =
-            _.options()->universal_limits_.max_control_flow_nesting_depth;
-        for (auto block = begin(blocks); block != end(blocks); ++block) {
-          if (function.GetBlockDepth(*block) >
-              control_flow_nesting_depth_limit) {
-            return _.diag(SPV_ERROR_INVALID_CFG, _.FindDef((*block)->id()))
-                   << "Maximum Control Flow nesting depth exceeded.";
-          }
-        }
+
+      // For WebGPU check that all unreachable blocks are degenerate cases for
+      // merge-block or continue-target.
+      if (spvIsWebGPUEnv(_.context()->target_env)) {
+        spv_result_t result = PerformWebGPUCfgChecks(_, function);
+        if (result != SPV_SUCCESS) return result;
       }
     }
-
-    /// Structured control flow checks are only required for shader capabilities
+    // If we have structed control flow, check that no block has a control
+    // flow nesting depth larger than the limit.
     if (_.HasCapability(SpvCapabilityShader)) {
-      if (auto error =
-              StructuredControlFlowChecks(_, &function, back_edges, postorder))
-        return error;
+      const int control_flow_nesting_depth_limit =
+          _.options()->universal_limits_.max_control_flow_nesting_depth;
+      for (auto block = begin(blocks); block != end(blocks); ++block) {
+        if (function->GetBlockDepth(*block) >
+            control_flow_nesting_depth_limit) {
+          return _.diag(SPV_ERROR_INVALID_CFG, _.FindDef((*block)->id()))
+                 << "Maximum Control Flow nesting depth exceeded.";
+        }
+      }
     }
   }
+
+  /// Structured control flow checks are only required for shader capabilities
+  if (_.HasCapability(SpvCapabilityShader)) {
+    if (auto error =
+            StructuredControlFlowChecks(_, function, back_edges, postorder))
+      return error;
+  }
+  return SPV_SUCCESS;
+}
+
+spv_result_t PerformCfgChecks(ValidationState_t& _) {
+  for (auto& function : _.functions()) {
+    if (auto error = PerformCfgChecks(_, &function)) return error;
+  }
   return SPV_SUCCESS;
 }
 
@@ -1176,5 +1264,20 @@ spv_result_t ControlFlowPass(ValidationState_t& _, const Instruction* inst) {
   return SPV_SUCCESS;
 }
 
+bool ControlFlowPassAppliesTo(const spv_opcode_desc_t& entry) {
+  switch (entry.opcode) {
+    case SpvOpPhi:
+    case SpvOpBranch:
+    case SpvOpBranchConditional:
+    case SpvOpReturnValue:
+    case SpvOpSwitch:
+    case SpvOpLoopMerge:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
 }  // namespace val
 }  // namespace spvtools
@@ -67,9 +67,45 @@ struct LayoutConstraints {
 using MemberConstraints = std::unordered_map<std::pair<uint32_t, uint32_t>,
                                              LayoutConstraints, PairHash>;
 
+// Identifies a layout computation: a type id with the constraints it inherits
+// and whether structs and arrays are rounded up to 16 bytes.
+struct LayoutKey {
+  LayoutKey(uint32_t id, bool round_up, const LayoutConstraints& inherited)
+      : type_id(id),
+        matrix_stride(inherited.matrix_stride),
+        majorness(inherited.majorness),
+        roundUp(round_up) {}
+  bool operator==(const LayoutKey& other) const {
+    return type_id == other.type_id && matrix_stride == other.matrix_stride &&
+           majorness == other.majorness && roundUp == other.roundUp;
+  }
+  uint32_t type_id;
+  uint32_t matrix_stride;
+  MatrixLayout majorness;
+  bool roundUp;
+};
+
+// A functor for hashing layout keys.
+struct LayoutKeyHash {
+  std::size_t operator()(const LayoutKey& key) const {
+    const std::size_t flags = (key.majorness == kRowMajor ? 1 : 0) |
+                              (key.roundUp ? 2 : 0);
+    return key.type_id ^ (std::size_t(key.matrix_stride) << 2) ^ (flags << 30);
+  }
+};
+
+// Memoized alignments and sizes of types.  The member constraints of a struct
+// come only from its own decorations, so they are the same in every block that
+// contains it, and the results can be shared by all the blocks of a module.
+struct LayoutCache {
+  std::unordered_map<LayoutKey, uint32_t, LayoutKeyHash> base_alignments;
+  std::unordered_map<LayoutKey, uint32_t, LayoutKeyHash> sizes;
+  std::unordered_map<uint32_t, uint32_t> scalar_alignments;
+};
+
 // Returns the array stride of the given array type.
 uint32_t GetArrayStride(uint32_t array_id, ValidationState_t& vstate) {
-  for (auto& decoration : vstate.id_decorations(array_id)) {
+  for (auto& decoration : vstate.FindDecorations(array_id)) {
     if (SpvDecorationArrayStride == decoration.dec_type()) {
       return decoration.params()[0];
     }
@@ -79,7 +115,7 @@ uint32_t GetArrayStride(uint32_t array_id, ValidationState_t& vstate) {
 
 // Returns true if the given variable has a BuiltIn decoration.
 bool isBuiltInVar(uint32_t var_id, ValidationState_t& vstate) {
-  const auto& decorations = vstate.id_decorations(var_id);
+  const auto& decorations = vstate.FindDecorations(var_id);
   return std::any_of(
       decorations.begin(), decorations.end(),
       [](const Decoration& d) { return SpvDecorationBuiltIn == d.dec_type(); });
@@ -88,7 +124,7 @@ bool isBuiltInVar(uint32_t var_id, ValidationState_t& vstate) {
 // Returns true if the given structure type has any members with BuiltIn
 // decoration.
 bool isBuiltInStruct(uint32_t struct_id, ValidationState_t& vstate) {
-  const auto& decorations = vstate.id_decorations(struct_id);
+  const auto& decorations = vstate.FindDecorations(struct_id);
   return std::any_of(
       decorations.begin(), decorations.end(), [](const Decoration& d) {
         return SpvDecorationBuiltIn == d.dec_type() &&
@@ -98,7 +134,7 @@ bool isBuiltInStruct(uint32_t struct_id, ValidationState_t& vstate) {
 
 // Returns true if the given ID has the Import LinkageAttributes decoration.
 bool hasImportLinkageAttribute(uint32_t id, ValidationState_t& vstate) {
-  const auto& decorations = vstate.id_decorations(id);
+  const auto& decorations = vstate.FindDecorations(id);
   return std::any_of(decorations.begin(), decorations.end(),
                      [](const Decoration& d) {
                        return SpvDecorationLinkageAttributes == d.dec_type() &&
@@ -132,7 +168,7 @@ bool isMissingOffsetInStruct(uint32_t struct_id, ValidationState_t& vstate) {
   std::vector<bool> hasOffset(getStructMembers(struct_id, vstate).size(),
                               false);
   // Check offsets of member decorations
-  for (auto& decoration : vstate.id_decorations(struct_id)) {
+  for (auto& decoration : vstate.FindDecorations(struct_id)) {
     if (SpvDecorationOffset == decoration.dec_type() &&
         Decoration::kInvalidMember != decoration.struct_member_index()) {
       hasOffset[decoration.struct_member_index()] = true;
@@ -156,13 +192,23 @@ uint32_t align(uint32_t x, uint32_t alignment) {
   return (x + alignment - 1) & ~(alignment - 1);
 }
 
-// Returns base alignment of struct member. If |roundUp| is true, also
-// ensure that structs and arrays are aligned at least to a multiple of 16
-// bytes.
 uint32_t getBaseAlignment(uint32_t member_id, bool roundUp,
                           const LayoutConstraints& inherited,
-                          MemberConstraints& constraints,
-                          ValidationState_t& vstate) {
+                          MemberConstraints& constraints, LayoutCache& cache,
+                          ValidationState_t& vstate);
+uint32_t getScalarAlignment(uint32_t type_id, LayoutCache& cache,
+                            ValidationState_t& vstate);
+uint32_t getSize(uint32_t member_id, const LayoutConstraints& inherited,
+                 MemberConstraints& constraints, LayoutCache& cache,
+                 ValidationState_t& vstate);
+
+// Computes the base alignment of struct member. If |roundUp| is true, also
+// ensure that structs and arrays are aligned at least to a multiple of 16
+// bytes.
+uint32_t computeBaseAlignment(uint32_t member_id, bool roundUp,
+                              const LayoutConstraints& inherited,
+                              MemberConstraints& constraints,
+                              LayoutCache& cache, ValidationState_t& vstate) {
   const auto inst = vstate.FindDef(member_id);
   const auto& words = inst->words();
   // Minimal alignment is byte-aligned.
@@ -176,7 +222,7 @@ uint32_t getBaseAlignment(uint32_t member_id, bool roundUp,
       const auto componentId = words[2];
       const auto numComponents = words[3];
       const auto componentAlignment = getBaseAlignment(
-          componentId, roundUp, inherited, constraints, vstate);
+          componentId, roundUp, inherited, constraints, cache, vstate);
       baseAlignment =
           componentAlignment * (numComponents == 3 ? 4 : numComponents);
       break;
@@ -185,7 +231,7 @@ uint32_t getBaseAlignment(uint32_t member_id, bool roundUp,
       const auto column_type = words[2];
       if (inherited.majorness == kColumnMajor) {
         baseAlignment = getBaseAlignment(column_type, roundUp, inherited,
-                                         constraints, vstate);
+                                         constraints, cache, vstate);
       } else {
         // A row-major matrix of C columns has a base alignment equal to the
         // base alignment of a vector of C matrix components.
@@ -193,15 +239,15 @@ uint32_t getBaseAlignment(uint32_t member_id, bool roundUp,
         const auto component_inst = vstate.FindDef(column_type);
         const auto component_id = component_inst->words()[2];
         const auto componentAlignment = getBaseAlignment(
-            component_id, roundUp, inherited, constraints, vstate);
+            component_id, roundUp, inherited, constraints, cache, vstate);
         baseAlignment =
             componentAlignment * (num_columns == 3 ? 4 : num_columns);
       }
     } break;
     case SpvOpTypeArray:
     case SpvOpTypeRuntimeArray:
-      baseAlignment =
-          getBaseAlignment(words[2], roundUp, inherited, constraints, vstate);
+      baseAlignment = getBaseAlignment(words[2], roundUp, inherited,
+                                       constraints, cache, vstate);
       if (roundUp) baseAlignment = align(baseAlignment, 16u);
       break;
     case SpvOpTypeStruct: {
@@ -212,8 +258,8 @@ uint32_t getBaseAlignment(uint32_t member_id, bool roundUp,
         const auto& constraint =
             constraints[std::make_pair(member_id, memberIdx)];
         baseAlignment = std::max(
-            baseAlignment,
-            getBaseAlignment(id, roundUp, constraint, constraints, vstate));
+            baseAlignment, getBaseAlignment(id, roundUp, constraint,
+                                            constraints, cache, vstate));
       }
       if (roundUp) baseAlignment = align(baseAlignment, 16u);
       break;
@@ -229,8 +275,24 @@ uint32_t getBaseAlignment(uint32_t member_id, bool roundUp,
   return baseAlignment;
 }
 
-// Returns scalar alignment of a type.
-uint32_t getScalarAlignment(uint32_t type_id, ValidationState_t& vstate) {
+// Returns base alignment of struct member, computing it only the first time
+// it is asked for.
+uint32_t getBaseAlignment(uint32_t member_id, bool roundUp,
+                          const LayoutConstraints& inherited,
+                          MemberConstraints& constraints, LayoutCache& cache,
+                          ValidationState_t& vstate) {
+  const LayoutKey key(member_id, roundUp, inherited);
+  const auto cached = cache.base_alignments.find(key);
+  if (cached != cache.base_alignments.end()) return cached->second;
+  const uint32_t alignment = computeBaseAlignment(
+      member_id, roundUp, inherited, constraints, cache, vstate);
+  cache.base_alignments[key] = alignment;
+  return alignment;
+}
+
+// Computes the scalar alignment of a type.
+uint32_t computeScalarAlignment(uint32_t type_id, LayoutCache& cache,
+                                ValidationState_t& vstate) {
   const auto inst = vstate.FindDef(type_id);
   const auto& words = inst->words();
   switch (inst->opcode()) {
@@ -242,7 +304,7 @@ uint32_t getScalarAlignment(uint32_t type_id, ValidationState_t& vstate) {
     case SpvOpTypeArray:
     case SpvOpTypeRuntimeArray: {
       const auto compositeMemberTypeId = words[2];
-      return getScalarAlignment(compositeMemberTypeId, vstate);
+      return getScalarAlignment(compositeMemberTypeId, cache, vstate);
     }
     case SpvOpTypeStruct: {
       const auto members = getStructMembers(type_id, vstate);
@@ -250,7 +312,7 @@ uint32_t getScalarAlignment(uint32_t type_id, ValidationState_t& vstate) {
       for (uint32_t memberIdx = 0, numMembers = uint32_t(members.size());
            memberIdx < numMembers; ++memberIdx) {
         const auto id = members[memberIdx];
-        uint32_t member_alignment = getScalarAlignment(id, vstate);
+        uint32_t member_alignment = getScalarAlignment(id, cache, vstate);
         if (member_alignment > max_member_alignment) {
           max_member_alignment = member_alignment;
         }
@@ -267,10 +329,22 @@ uint32_t getScalarAlignment(uint32_t type_id, ValidationState_t& vstate) {
   return 1;
 }
 
-// Returns size of a struct member. Doesn't include padding at the end of struct
-// or array.  Assumes that in the struct case, all members have offsets.
-uint32_t getSize(uint32_t member_id, const LayoutConstraints& inherited,
-                 MemberConstraints& constraints, ValidationState_t& vstate) {
+// Returns scalar alignment of a type, computing it only the first time it is
+// asked for.
+uint32_t getScalarAlignment(uint32_t type_id, LayoutCache& cache,
+                            ValidationState_t& vstate) {
+  const auto cached = cache.scalar_alignments.find(type_id);
+  if (cached != cache.scalar_alignments.end()) return cached->second;
+  const uint32_t alignment = computeScalarAlignment(type_id, cache, vstate);
+  cache.scalar_alignments[type_id] = alignment;
+  return alignment;
+}
+
+// Computes the size of a struct member. Doesn't include padding at the end of
+// struct or array.  Assumes that in the struct case, all members have offsets.
+uint32_t computeSize(uint32_t member_id, const LayoutConstraints& inherited,
+                     MemberConstraints& constraints, LayoutCache& cache,
+                     ValidationState_t& vstate) {
   const auto inst = vstate.FindDef(member_id);
   const auto& words = inst->words();
   switch (inst->opcode()) {
@@ -281,7 +355,7 @@ uint32_t getSize(uint32_t member_id, const LayoutConstraints& inherited,
       const auto componentId = words[2];
       const auto numComponents = words[3];
       const auto componentSize =
-          getSize(componentId, inherited, constraints, vstate);
+          getSize(componentId, inherited, constraints, cache, vstate);
       const auto size = componentSize * numComponents;
       return size;
     }
@@ -292,7 +366,7 @@ uint32_t getSize(uint32_t member_id, const LayoutConstraints& inherited,
       const uint32_t num_elem = sizeInst->words()[3];
       const uint32_t elem_type = words[2];
       const uint32_t elem_size =
-          getSize(elem_type, inherited, constraints, vstate);
+          getSize(elem_type, inherited, constraints, cache, vstate);
       // Account for gaps due to alignments in the first N-1 elements,
       // then add the size of the last element.
       const auto size =
@@ -312,7 +386,7 @@ uint32_t getSize(uint32_t member_id, const LayoutConstraints& inherited,
         const auto num_rows = component_inst->words()[3];
         const auto scalar_elem_type = component_inst->words()[2];
         const uint32_t scalar_elem_size =
-            getSize(scalar_elem_type, inherited, constraints, vstate);
+            getSize(scalar_elem_type, inherited, constraints, cache, vstate);
         return (num_rows - 1) * inherited.matrix_stride +
                num_columns * scalar_elem_size;
       }
@@ -324,7 +398,7 @@ uint32_t getSize(uint32_t member_id, const LayoutConstraints& inherited,
       const auto& lastMember = members.back();
       uint32_t offset = 0xffffffff;
       // Find the offset of the last element and add the size.
-      for (auto& decoration : vstate.id_decorations(member_id)) {
+      for (auto& decoration : vstate.FindDecorations(member_id)) {
         if (SpvDecorationOffset == decoration.dec_type() &&
             decoration.struct_member_index() == (int)lastIdx) {
           offset = decoration.params()[0];
@@ -334,7 +408,8 @@ uint32_t getSize(uint32_t member_id, const LayoutConstraints& inherited,
       // has been checked earlier in the flow.
       assert(offset != 0xffffffff);
       const auto& constraint = constraints[std::make_pair(lastMember, lastIdx)];
-      return offset + getSize(lastMember, constraint, constraints, vstate);
+      return offset +
+             getSize(lastMember, constraint, constraints, cache, vstate);
     }
     case SpvOpTypePointer:
       return vstate.pointer_size_and_alignment();
@@ -344,6 +419,21 @@ uint32_t getSize(uint32_t member_id, const LayoutConstraints& inherited,
   }
 }
 
+// Returns size of a struct member, computing it only the first time it is
+// asked for.
+uint32_t getSize(uint32_t member_id, const LayoutConstraints& inherited,
+                 MemberConstraints& constraints, LayoutCache& cache,
+                 ValidationState_t& vstate) {
+  // Sizes do not depend on rounding up, so the key always leaves it unset.
+  const LayoutKey key(member_id, false, inherited);
+  const auto cached = cache.sizes.find(key);
+  if (cached != cache.sizes.end()) return cached->second;
+  const uint32_t size =
+      computeSize(member_id, inherited, constraints, cache, vstate);
+  cache.sizes[key] = size;
+  return size;
+}
+
 // A member is defined to improperly straddle if either of the following are
 // true:
 // - It is a vector with total size less than or equal to 16 bytes, and has
@@ -353,9 +443,9 @@ uint32_t getSize(uint32_t member_id, const LayoutConstraints& inherited,
 // decorations placing its first byte at a non-integer multiple of 16.
 bool hasImproperStraddle(uint32_t id, uint32_t offset,
                          const LayoutConstraints& inherited,
-                         MemberConstraints& constraints,
+                         MemberConstraints& constraints, LayoutCache& cache,
                          ValidationState_t& vstate) {
-  const auto size = getSize(id, inherited, constraints, vstate);
+  const auto size = getSize(id, inherited, constraints, cache, vstate);
   const auto F = offset;
   const auto L = offset + size - 1;
   if (size <= 16) {
@@ -380,7 +470,7 @@ bool IsAlignedTo(uint32_t offset, uint32_t alignment) {
 spv_result_t checkLayout(uint32_t struct_id, const char* storage_class_str,
                          const char* decoration_str, bool blockRules,
                          uint32_t incoming_offset,
-                         MemberConstraints& constraints,
+                         MemberConstraints& constraints, LayoutCache& cache,
                          ValidationState_t& vstate) {
   if (vstate.options()->skip_block_layout) return SPV_SUCCESS;
 
@@ -423,7 +513,7 @@ spv_result_t checkLayout(uint32_t struct_id, const char* storage_class_str,
   for (uint32_t memberIdx = 0, numMembers = uint32_t(members.size());
        memberIdx < numMembers; memberIdx++) {
     uint32_t offset = 0xffffffff;
-    for (auto& decoration : vstate.id_decorations(struct_id)) {
+    for (auto& decoration : vstate.FindDecorations(struct_id)) {
       if (decoration.struct_member_index() == (int)memberIdx) {
         switch (decoration.dec_type()) {
           case SpvDecorationOffset:
@@ -457,12 +547,12 @@ spv_result_t checkLayout(uint32_t struct_id, const char* storage_class_str,
     // an alignment that divides evenly into the alignment that would otherwise
     // be used.
     const auto alignment =
-        scalar_block_layout
-            ? getScalarAlignment(id, vstate)
-            : getBaseAlignment(id, blockRules, constraint, constraints, vstate);
+        scalar_block_layout ? getScalarAlignment(id, cache, vstate)
+                            : getBaseAlignment(id, blockRules, constraint,
+                                               constraints, cache, vstate);
     const auto inst = vstate.FindDef(id);
     const auto opcode = inst->opcode();
-    const auto size = getSize(id, constraint, constraints, vstate);
+    const auto size = getSize(id, constraint, constraints, cache, vstate);
     // Check offset.
     if (offset == 0xffffffff)
       return fail(memberIdx) << "is missing an Offset decoration";
@@ -471,7 +561,8 @@ spv_result_t checkLayout(uint32_t struct_id, const char* storage_class_str,
       // In relaxed block layout, the vector offset must be aligned to the
       // vector's scalar element type.
       const auto componentId = inst->words()[2];
-      const auto scalar_alignment = getScalarAlignment(componentId, vstate);
+      const auto scalar_alignment =
+          getScalarAlignment(componentId, cache, vstate);
       if (!IsAlignedTo(offset, scalar_alignment)) {
         return fail(memberIdx)
                << "at offset " << offset
@@ -492,7 +583,8 @@ spv_result_t checkLayout(uint32_t struct_id, const char* storage_class_str,
     if (!scalar_block_layout && relaxed_block_layout) {
       // Check improper straddle of vectors.
       if (SpvOpTypeVector == opcode &&
-          hasImproperStraddle(id, offset, constraint, constraints, vstate))
+          hasImproperStraddle(id, offset, constraint, constraints, cache,
+                              vstate))
         return fail(memberIdx)
                << "is an improperly straddling vector at offset " << offset;
     }
@@ -501,11 +593,11 @@ spv_result_t checkLayout(uint32_t struct_id, const char* storage_class_str,
     if (SpvOpTypeStruct == opcode &&
         SPV_SUCCESS != (recursive_status = checkLayout(
                             id, storage_class_str, decoration_str, blockRules,
-                            offset, constraints, vstate)))
+                            offset, constraints, cache, vstate)))
       return recursive_status;
     // Check matrix stride.
     if (SpvOpTypeMatrix == opcode) {
-      for (auto& decoration : vstate.id_decorations(id)) {
+      for (auto& decoration : vstate.FindDecorations(id)) {
         if (SpvDecorationMatrixStride == decoration.dec_type() &&
             !IsAlignedTo(decoration.params()[0], alignment))
           return fail(memberIdx)
@@ -523,7 +615,7 @@ spv_result_t checkLayout(uint32_t struct_id, const char* storage_class_str,
       const auto element_inst = vstate.FindDef(typeId);
       // Check array stride.
       uint32_t array_stride = 0;
-      for (auto& decoration : vstate.id_decorations(array_inst->id())) {
+      for (auto& decoration : vstate.FindDecorations(array_inst->id())) {
         if (SpvDecorationArrayStride == decoration.dec_type()) {
           array_stride = decoration.params()[0];
           if (array_stride == 0) {
@@ -553,7 +645,8 @@ spv_result_t checkLayout(uint32_t struct_id, const char* storage_class_str,
         if (SpvOpTypeStruct == element_inst->opcode() &&
             SPV_SUCCESS != (recursive_status = checkLayout(
                                 typeId, storage_class_str, decoration_str,
-                                blockRules, next_offset, constraints, vstate)))
+                                blockRules, next_offset, constraints, cache,
+                                vstate)))
           return recursive_status;
         // If offsets accumulate up to a 16-byte multiple stop checking since
         // it will just repeat.
@@ -562,13 +655,14 @@ spv_result_t checkLayout(uint32_t struct_id, const char* storage_class_str,
 
       // Proceed to the element in case it is an array.
       array_inst = element_inst;
-      array_alignment = scalar_block_layout
-                            ? getScalarAlignment(array_inst->id(), vstate)
-                            : getBaseAlignment(array_inst->id(), blockRules,
-                                               constraint, constraints, vstate);
+      array_alignment =
+          scalar_block_layout
+              ? getScalarAlignment(array_inst->id(), cache, vstate)
+              : getBaseAlignment(array_inst->id(), blockRules, constraint,
+                                 constraints, cache, vstate);
 
       const auto element_size =
-          getSize(element_inst->id(), constraint, constraints, vstate);
+          getSize(element_inst->id(), constraint, constraints, cache, vstate);
       if (element_size > array_stride) {
         return fail(memberIdx)
                << "contains an array with stride " << array_stride
@@ -590,7 +684,7 @@ spv_result_t checkLayout(uint32_t struct_id, const char* storage_class_str,
 // nested structures.
 bool hasDecoration(uint32_t id, SpvDecoration decoration,
                    ValidationState_t& vstate) {
-  for (auto& dec : vstate.id_decorations(id)) {
+  for (auto& dec : vstate.FindDecorations(id)) {
     if (decoration == dec.dec_type()) return true;
   }
   if (SpvOpTypeStruct != vstate.FindDef(id)->opcode()) {
@@ -612,10 +706,10 @@ bool checkForRequiredDecoration(uint32_t struct_id, SpvDecoration decoration,
     const auto id = members[memberIdx];
     if (type != vstate.FindDef(id)->opcode()) continue;
     bool found = false;
-    for (auto& dec : vstate.id_decorations(id)) {
+    for (auto& dec : vstate.FindDecorations(id)) {
       if (decoration == dec.dec_type()) found = true;
     }
-    for (auto& dec : vstate.id_decorations(struct_id)) {
+    for (auto& dec : vstate.FindDecorations(struct_id)) {
       if (decoration == dec.dec_type() &&
           (int)memberIdx == dec.struct_member_index()) {
         found = true;
@@ -678,7 +772,7 @@ spv_result_t CheckImportedVariableInitialization(ValidationState_t& vstate) {
 
 // Checks whether a builtin variable is valid.
 spv_result_t CheckBuiltInVariable(uint32_t var_id, ValidationState_t& vstate) {
-  const auto& decorations = vstate.id_decorations(var_id);
+  const auto& decorations = vstate.FindDecorations(var_id);
   for (const auto& d : decorations) {
     if (spvIsVulkanEnv(vstate.context()->target_env)) {
       if (d.dec_type() == SpvDecorationLocation ||
@@ -765,7 +859,7 @@ spv_result_t CheckDecorationsOfEntryPoints(ValidationState_t& vstate) {
       }
       // The LinkageAttributes Decoration cannot be applied to functions
       // targeted by an OpEntryPoint instruction
-      for (auto& decoration : vstate.id_decorations(entry_point)) {
+      for (auto& decoration : vstate.FindDecorations(entry_point)) {
         if (SpvDecorationLinkageAttributes == decoration.dec_type()) {
           const char* linkage_name =
               reinterpret_cast<const char*>(&decoration.params()[0]);
@@ -802,7 +896,7 @@ void ComputeMemberConstraintsForStruct(MemberConstraints* constraints,
     LayoutConstraints& constraint =
         (*constraints)[std::make_pair(struct_id, memberIdx)];
     constraint = inherited;
-    for (auto& decoration : vstate.id_decorations(struct_id)) {
+    for (auto& decoration : vstate.FindDecorations(struct_id)) {
       if (decoration.struct_member_index() == (int)memberIdx) {
         switch (decoration.dec_type()) {
           case SpvDecorationRowMajor:
@@ -866,6 +960,8 @@ void ComputeMemberConstraintsForArray(MemberConstraints* constraints,
 spv_result_t CheckDecorationsOfBuffers(ValidationState_t& vstate) {
   // Set of entry points that are known to use a push constant.
   std::unordered_set<uint32_t> uses_push_constant;
+  // Layouts of types shared by the blocks of the module.
+  LayoutCache layout_cache;
   for (const auto& inst : vstate.ordered_instructions()) {
     const auto& words = inst.words();
     if (SpvOpVariable == inst.opcode()) {
@@ -1024,7 +1120,7 @@ spv_result_t CheckDecorationsOfBuffers(ValidationState_t& vstate) {
           }
         }
 
-        for (const auto& dec : vstate.id_decorations(id)) {
+        for (const auto& dec : vstate.FindDecorations(id)) {
           const bool blockDeco = SpvDecorationBlock == dec.dec_type();
           const bool bufferDeco = SpvDecorationBufferBlock == dec.dec_type();
           const bool blockRules = uniform && blockDeco;
@@ -1073,12 +1169,14 @@ spv_result_t CheckDecorationsOfBuffers(ValidationState_t& vstate) {
             } else if (blockRules &&
                        (SPV_SUCCESS != (recursive_status = checkLayout(
                                             id, sc_str, deco_str, true, 0,
-                                            constraints, vstate)))) {
+                                            constraints, layout_cache,
+                                            vstate)))) {
               return recursive_status;
             } else if (bufferRules &&
                        (SPV_SUCCESS != (recursive_status = checkLayout(
                                             id, sc_str, deco_str, false, 0,
-                                            constraints, vstate)))) {
+                                            constraints, layout_cache,
+                                            vstate)))) {
               return recursive_status;
             }
           }
@@ -1235,10 +1333,10 @@ spv_result_t CheckVulkanMemoryModelDeprecatedDecorations(
 
   std::string msg;
   std::ostringstream str(msg);
-  for (const auto& def : vstate.all_definitions()) {
-    const auto inst = def.second;
+  for (const auto inst : vstate.id_definitions()) {
+    if (!inst) continue;
     const auto id = inst->id();
-    for (const auto& dec : vstate.id_decorations(id)) {
+    for (const auto& dec : vstate.FindDecorations(id)) {
       const auto member = dec.struct_member_index();
       if (dec.dec_type() == SpvDecorationCoherent ||
           dec.dec_type() == SpvDecorationVolatile) {
@@ -1569,9 +1667,8 @@ spv_result_t CheckDecorationsFromDecoration(ValidationState_t& vstate) {
   // Some rules are only checked for shaders.
   const bool is_shader = vstate.HasCapability(SpvCapabilityShader);
 
-  for (const auto& kv : vstate.id_decorations()) {
-    const uint32_t id = kv.first;
-    const auto& decorations = kv.second;
+  for (uint32_t id = 1; id < vstate.decorated_id_bound(); ++id) {
+    const auto& decorations = vstate.FindDecorations(id);
     if (decorations.empty()) continue;
 
     const Instruction* inst = vstate.FindDef(id);
@@ -68,5 +68,9 @@ spv_result_t ValidateExecutionLimitations(ValidationState_t& _,
   return SPV_SUCCESS;
 }
 
+bool ValidateExecutionLimitationsAppliesTo(const spv_opcode_desc_t& entry) {
+  return entry.opcode == SpvOpFunction;
+}
+
 }  // namespace val
 }  // namespace spvtools
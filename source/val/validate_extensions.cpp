@@ -3156,5 +3156,17 @@ spv_result_t ExtensionPass(ValidationState_t& _, const Instruction* inst) {
   return SPV_SUCCESS;
 }
 
+bool ExtensionPassAppliesTo(const spv_opcode_desc_t& entry) {
+  switch (entry.opcode) {
+    case SpvOpExtension:
+    case SpvOpExtInstImport:
+    case SpvOpExtInst:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
 }  // namespace val
 }  // namespace spvtools
@@ -32,8 +32,8 @@ bool DoPointeesLogicallyMatch(val::Instruction* a, val::Instruction* b,
     return false;
   }
 
-  const auto& dec_a = _.id_decorations(a->id());
-  const auto& dec_b = _.id_decorations(b->id());
+  const auto& dec_a = _.FindDecorations(a->id());
+  const auto& dec_b = _.FindDecorations(b->id());
   for (const auto& dec : dec_b) {
     if (std::find(dec_a.begin(), dec_a.end(), dec) == dec_a.end()) {
       return false;
@@ -159,7 +159,7 @@ spv_result_t ValidateFunctionParameter(ValidationState_t& _,
     if (param_nonarray_type->GetOperandAs<uint32_t>(1u) ==
         SpvStorageClassPhysicalStorageBufferEXT) {
       // check for Aliased or Restrict
-      const auto& decorations = _.id_decorations(inst->id());
+      const auto& decorations = _.FindDecorations(inst->id());
 
       bool foundAliased = std::any_of(
           decorations.begin(), decorations.end(), [](const Decoration& d) {
@@ -191,7 +191,7 @@ spv_result_t ValidateFunctionParameter(ValidationState_t& _,
           pointee_type->GetOperandAs<uint32_t>(1u) ==
               SpvStorageClassPhysicalStorageBufferEXT) {
         // check for AliasedPointerEXT/RestrictPointerEXT
-        const auto& decorations = _.id_decorations(inst->id());
+        const auto& decorations = _.FindDecorations(inst->id());
 
         bool foundAliased = std::any_of(
             decorations.begin(), decorations.end(), [](const Decoration& d) {
@@ -354,5 +354,17 @@ spv_result_t FunctionPass(ValidationState_t& _, const Instruction* inst) {
   return SPV_SUCCESS;
 }
 
+bool FunctionPassAppliesTo(const spv_opcode_desc_t& entry) {
+  switch (entry.opcode) {
+    case SpvOpFunction:
+    case SpvOpFunctionParameter:
+    case SpvOpFunctionCall:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
 }  // namespace val
 }  // namespace spvtools
@@ -37,15 +37,37 @@
 namespace spvtools {
 namespace val {
 
-spv_result_t UpdateIdUse(ValidationState_t& _, const Instruction* inst) {
+namespace {
+
+// Calls |f| with the definition of each id that |inst| refers to and the
+// index of the word that refers to it.
+template <typename F>
+void ForEachIdUse(ValidationState_t& _, const Instruction* inst, F f) {
   for (auto& operand : inst->operands()) {
     const spv_operand_type_t& type = operand.type;
     const uint32_t operand_id = inst->word(operand.offset);
     if (spvIsIdType(type) && type != SPV_OPERAND_TYPE_RESULT_ID) {
-      if (auto def = _.FindDef(operand_id))
-        def->RegisterUse(inst, operand.offset);
+      if (auto def = _.FindDef(operand_id)) f(def, operand.offset);
     }
   }
+}
+
+}  // namespace
+
+spv_result_t UpdateIdUses(ValidationState_t& _) {
+  const auto& instructions = _.ordered_instructions();
+  std::vector<uint32_t> num_uses(instructions.size(), 0);
+  for (const auto& inst : instructions) {
+    ForEachIdUse(_, &inst, [&num_uses](Instruction* def, uint32_t) {
+      ++num_uses[def->LineNum() - 1];
+    });
+  }
+  _.ReserveUses(num_uses);
+  for (const auto& inst : instructions) {
+    ForEachIdUse(_, &inst, [&inst](Instruction* def, uint32_t index) {
+      def->RegisterUse(&inst, index);
+    });
+  }
 
   return SPV_SUCCESS;
 }
@@ -231,7 +231,7 @@ spv_result_t GetLocationsForVariable(
   bool has_patch = false;
   bool has_per_task_nv = false;
   bool has_per_vertex_nv = false;
-  for (auto& dec : _.id_decorations(variable->id())) {
+  for (auto& dec : _.FindDecorations(variable->id())) {
     if (dec.dec_type() == SpvDecorationLocation) {
       if (has_location && dec.params()[0] != location) {
         return _.diag(SPV_ERROR_INVALID_DATA, variable)
@@ -372,7 +372,7 @@ spv_result_t GetLocationsForVariable(
     // if they agree on the location/component.
     std::unordered_map<uint32_t, uint32_t> member_locations;
     std::unordered_map<uint32_t, uint32_t> member_components;
-    for (auto& dec : _.id_decorations(type_id)) {
+    for (auto& dec : _.FindDecorations(type_id)) {
       if (dec.dec_type() == SpvDecorationLocation) {
         auto where = member_locations.find(dec.struct_member_index());
         if (where == member_locations.end()) {
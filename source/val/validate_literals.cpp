@@ -95,5 +95,20 @@ spv_result_t LiteralsPass(ValidationState_t& _, const Instruction* inst) {
   return SPV_SUCCESS;
 }
 
+bool LiteralsPassAppliesTo(const spv_opcode_desc_t& entry) {
+  // Only typed literal numbers can be narrower than a word.
+  for (uint16_t i = 0; i < entry.numTypes; ++i) {
+    switch (entry.operandTypes[i]) {
+      case SPV_OPERAND_TYPE_TYPED_LITERAL_NUMBER:
+      case SPV_OPERAND_TYPE_OPTIONAL_TYPED_LITERAL_INTEGER:
+      case SPV_OPERAND_TYPE_VARIABLE_LITERAL_INTEGER_ID:
+        return true;
+      default:
+        break;
+    }
+  }
+  return false;
+}
+
 }  // namespace val
 }  // namespace spvtools
@@ -106,9 +106,9 @@ bool HaveSameLayoutDecorations(ValidationState_t& _, const Instruction* type1,
   assert(type2->opcode() == SpvOpTypeStruct &&
          "type2 must be an OpTypeStruct instruction.");
   const std::vector<Decoration>& type1_decorations =
-      _.id_decorations(type1->id());
+      _.FindDecorations(type1->id());
   const std::vector<Decoration>& type2_decorations =
-      _.id_decorations(type2->id());
+      _.FindDecorations(type2->id());
 
   // TODO: Will have to add other check for arrays an matricies if we want to
   // handle them.
@@ -164,7 +164,7 @@ bool HasConflictingMemberOffsets(
 bool ContainsInvalidBool(ValidationState_t& _, const Instruction* storage,
                          bool skip_builtin) {
   if (skip_builtin) {
-    for (const Decoration& decoration : _.id_decorations(storage->id())) {
+    for (const Decoration& decoration : _.FindDecorations(storage->id())) {
       if (decoration.dec_type() == SpvDecorationBuiltIn) return false;
     }
   }
@@ -447,7 +447,7 @@ spv_result_t ValidateVariable(ValidationState_t& _, const Instruction* inst) {
                                    storage_class == SpvStorageClassOutput;
     bool builtin = false;
     if (storage_input_or_output) {
-      for (const Decoration& decoration : _.id_decorations(inst->id())) {
+      for (const Decoration& decoration : _.FindDecorations(inst->id())) {
         if (decoration.dec_type() == SpvDecorationBuiltIn) {
           builtin = true;
           break;
@@ -1665,5 +1665,30 @@ spv_result_t MemoryPass(ValidationState_t& _, const Instruction* inst) {
 
   return SPV_SUCCESS;
 }
+
+bool MemoryPassAppliesTo(const spv_opcode_desc_t& entry) {
+  switch (entry.opcode) {
+    case SpvOpVariable:
+    case SpvOpLoad:
+    case SpvOpStore:
+    case SpvOpCopyMemory:
+    case SpvOpCopyMemorySized:
+    case SpvOpPtrAccessChain:
+    case SpvOpAccessChain:
+    case SpvOpInBoundsAccessChain:
+    case SpvOpInBoundsPtrAccessChain:
+    case SpvOpArrayLength:
+    case SpvOpCooperativeMatrixLoadNV:
+    case SpvOpCooperativeMatrixStoreNV:
+    case SpvOpCooperativeMatrixLengthNV:
+    case SpvOpPtrEqual:
+    case SpvOpPtrNotEqual:
+    case SpvOpPtrDiff:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
 }  // namespace val
 }  // namespace spvtools
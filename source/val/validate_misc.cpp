@@ -159,5 +159,20 @@ spv_result_t MiscPass(ValidationState_t& _, const Instruction* inst) {
   return SPV_SUCCESS;
 }
 
+bool MiscPassAppliesTo(const spv_opcode_desc_t& entry) {
+  switch (entry.opcode) {
+    case SpvOpUndef:
+    case SpvOpBeginInvocationInterlockEXT:
+    case SpvOpEndInvocationInterlockEXT:
+    case SpvOpDemoteToHelperInvocationEXT:
+    case SpvOpIsHelperInvocationEXT:
+    case SpvOpReadClockKHR:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
 }  // namespace val
 }  // namespace spvtools
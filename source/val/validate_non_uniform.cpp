@@ -73,5 +73,10 @@ spv_result_t NonUniformPass(ValidationState_t& _, const Instruction* inst) {
   return SPV_SUCCESS;
 }
 
+bool NonUniformPassAppliesTo(const spv_opcode_desc_t& entry) {
+  return spvOpcodeIsNonUniformGroupOperation(entry.opcode) ||
+         entry.opcode == SpvOpGroupNonUniformBallotBitCount;
+}
+
 }  // namespace val
 }  // namespace spvtools
@@ -53,5 +53,9 @@ spv_result_t ValidateSmallTypeUses(ValidationState_t& _,
   return SPV_SUCCESS;
 }
 
+bool ValidateSmallTypeUsesAppliesTo(const spv_opcode_desc_t& entry) {
+  return entry.hasType;
+}
+
 }  // namespace val
 }  // namespace spvtools
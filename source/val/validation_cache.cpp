@@ -0,0 +1,273 @@
+// Copyright (c) 2026 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/val/validation_cache.h"
+
+#include <cstdio>
+#include <random>
+
+#include "source/spirv_validator_options.h"
+
+namespace {
+
+const uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+const uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+
+// Identifies outcome files, and the version of their layout.
+const uint32_t kFileMagic = 0x53505643;  // "SPVC"
+const uint32_t kFileVersion = 1;
+
+// Messages and sources longer than this are taken to mean a corrupt file.
+const uint32_t kMaxFileStringSize = 1u << 24;
+
+// Spreads the bits of |x| over the whole word.
+uint64_t Mix(uint64_t x) {
+  x ^= x >> 33;
+  x *= kPrime2;
+  x ^= x >> 29;
+  x *= kPrime1;
+  x ^= x >> 32;
+  return x;
+}
+
+// Hashes |num_words| words starting at |words|, starting from |seed|.
+//
+// Stripes of eight words are folded into four independent 64-bit lanes with
+// 32x32->64 bit multiplies, which compilers turn into vector instructions.
+// The key of each stripe depends on its position, so reordering stripes
+// changes the hash, and the lanes are scrambled every few stripes.
+uint64_t HashWords(const uint32_t* words, size_t num_words, uint64_t seed) {
+  const size_t kLanes = 4;
+  const size_t kStripeWords = 2 * kLanes;
+  const size_t kStripesPerScramble = 16;
+
+  uint64_t lanes[kLanes] = {seed + kPrime1, seed + kPrime2, seed,
+                            seed - kPrime1};
+  size_t index = 0;
+  for (uint64_t stripe = 0; index + kStripeWords <= num_words;
+       index += kStripeWords, ++stripe) {
+    const uint64_t stripe_key = (stripe + 1) * kPrime2;
+    for (size_t lane = 0; lane < kLanes; ++lane) {
+      const uint64_t data = uint64_t(words[index + 2 * lane]) |
+                            uint64_t(words[index + 2 * lane + 1]) << 32;
+      const uint64_t keyed = data ^ (stripe_key + lane * kPrime1);
+      lanes[lane] += data + (keyed & 0xFFFFFFFFu) * (keyed >> 32);
+    }
+    if (stripe % kStripesPerScramble == kStripesPerScramble - 1) {
+      for (size_t lane = 0; lane < kLanes; ++lane) {
+        lanes[lane] = (lanes[lane] ^ (lanes[lane] >> 47)) * kPrime1;
+      }
+    }
+  }
+
+  uint64_t hash = Mix(num_words * kPrime1 + seed);
+  for (size_t lane = 0; lane < kLanes; ++lane) {
+    hash = Mix(hash ^ Mix(lanes[lane]));
+  }
+  for (; index < num_words; ++index) {
+    hash = Mix(hash ^ words[index]);
+  }
+  return hash;
+}
+
+bool WriteUint32(FILE* file, uint32_t value) {
+  return fwrite(&value, sizeof(value), 1, file) == 1;
+}
+
+bool WriteUint64(FILE* file, uint64_t value) {
+  return fwrite(&value, sizeof(value), 1, file) == 1;
+}
+
+bool WriteString(FILE* file, const std::string& value) {
+  return WriteUint32(file, static_cast<uint32_t>(value.size())) &&
+         fwrite(value.data(), 1, value.size(), file) == value.size();
+}
+
+bool ReadUint32(FILE* file, uint32_t* value) {
+  return fread(value, sizeof(*value), 1, file) == 1;
+}
+
+bool ReadUint64(FILE* file, uint64_t* value) {
+  return fread(value, sizeof(*value), 1, file) == 1;
+}
+
+bool ReadString(FILE* file, std::string* value) {
+  uint32_t size = 0;
+  if (!ReadUint32(file, &size) || size > kMaxFileStringSize) return false;
+  value->resize(size);
+  return size == 0 || fread(&(*value)[0], 1, size, file) == size;
+}
+
+}  // namespace
+
+spv_validator_cache_t::spv_validator_cache_t(size_t capacity,
+                                             const char* directory)
+    : capacity_(capacity), directory_(directory ? directory : "") {}
+
+uint64_t spv_validator_cache_t::Key(spv_target_env env,
+                                    spv_const_validator_options options,
+                                    const uint32_t* words, size_t num_words) {
+  // Everything in the options but the number of threads and the cache itself
+  // can change the outcome.
+  const validator_universal_limits_t& limits = options->universal_limits_;
+  const uint32_t settings[] = {
+      static_cast<uint32_t>(env),
+      limits.max_struct_members,
+      limits.max_struct_depth,
+      limits.max_local_variables,
+      limits.max_global_variables,
+      limits.max_switch_branches,
+      limits.max_function_args,
+      limits.max_control_flow_nesting_depth,
+      limits.max_access_chain_indexes,
+      limits.max_id_bound,
+      options->relax_struct_store,
+      options->relax_logical_pointer,
+      options->relax_block_layout,
+      options->uniform_buffer_standard_layout,
+      options->scalar_block_layout,
+      options->skip_block_layout,
+      options->before_hlsl_legalization,
+      options->low_memory,
+  };
+  // Outcomes stored on disk by another version of the validator may differ.
+  uint64_t version = 0;
+  for (const char* c = spvSoftwareVersionDetailsString(); *c; ++c) {
+    version = Mix(version ^ static_cast<unsigned char>(*c));
+  }
+  const uint64_t seed =
+      HashWords(settings, sizeof(settings) / sizeof(settings[0]), version);
+  return HashWords(words, num_words, seed);
+}
+
+bool spv_validator_cache_t::Lookup(uint64_t key, Outcome* outcome) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = entry_for_key_.find(key);
+    if (found != entry_for_key_.end()) {
+      entries_.splice(entries_.begin(), entries_, found->second);
+      *outcome = found->second->second;
+      return true;
+    }
+  }
+  if (directory_.empty() || !ReadFile(key, outcome)) return false;
+  std::lock_guard<std::mutex> lock(mutex_);
+  Remember(key, *outcome);
+  return true;
+}
+
+void spv_validator_cache_t::Store(uint64_t key, const Outcome& outcome) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Remember(key, outcome);
+  }
+  if (!directory_.empty()) WriteFile(key, outcome);
+}
+
+void spv_validator_cache_t::Remember(uint64_t key, const Outcome& outcome) {
+  if (capacity_ == 0) return;
+  auto found = entry_for_key_.find(key);
+  if (found != entry_for_key_.end()) {
+    found->second->second = outcome;
+    entries_.splice(entries_.begin(), entries_, found->second);
+    return;
+  }
+  if (entries_.size() == capacity_) {
+    entry_for_key_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+  entries_.emplace_front(key, outcome);
+  entry_for_key_[key] = entries_.begin();
+}
+
+std::string spv_validator_cache_t::PathFor(uint64_t key) const {
+  char name[32];
+  snprintf(name, sizeof(name), "%016llx.spvval",
+           static_cast<unsigned long long>(key));
+  return directory_ + "/" + name;
+}
+
+bool spv_validator_cache_t::ReadFile(uint64_t key, Outcome* outcome) const {
+  FILE* file = fopen(PathFor(key).c_str(), "rb");
+  if (!file) return false;
+
+  Outcome read;
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  uint64_t file_key = 0;
+  uint32_t result = 0;
+  uint32_t num_messages = 0;
+  bool ok = ReadUint32(file, &magic) && magic == kFileMagic &&
+            ReadUint32(file, &version) && version == kFileVersion &&
+            ReadUint64(file, &file_key) && file_key == key &&
+            ReadUint32(file, &result) && ReadUint32(file, &num_messages);
+  read.result = static_cast<spv_result_t>(static_cast<int32_t>(result));
+  for (uint32_t i = 0; ok && i < num_messages; ++i) {
+    Outcome::Message message;
+    uint32_t level = 0;
+    uint64_t line = 0;
+    uint64_t column = 0;
+    uint64_t index = 0;
+    ok = ReadUint32(file, &level) && ReadUint64(file, &line) &&
+         ReadUint64(file, &column) && ReadUint64(file, &index) &&
+         ReadString(file, &message.source) && ReadString(file, &message.text);
+    message.level = static_cast<spv_message_level_t>(level);
+    message.position = {static_cast<size_t>(line), static_cast<size_t>(column),
+                        static_cast<size_t>(index)};
+    read.messages.push_back(std::move(message));
+  }
+  fclose(file);
+
+  if (!ok) return false;
+  *outcome = std::move(read);
+  return true;
+}
+
+void spv_validator_cache_t::WriteFile(uint64_t key,
+                                      const Outcome& outcome) const {
+  // Write to a file of our own and move it into place, so that readers never
+  // see a partly written outcome.
+  const std::string path = PathFor(key);
+  std::random_device random;
+  char suffix[32];
+  snprintf(suffix, sizeof(suffix), ".%08x.tmp", random());
+  const std::string temp_path = path + suffix;
+
+  FILE* file = fopen(temp_path.c_str(), "wb");
+  if (!file) return;
+  bool ok = WriteUint32(file, kFileMagic) && WriteUint32(file, kFileVersion) &&
+            WriteUint64(file, key) &&
+            WriteUint32(file, static_cast<uint32_t>(outcome.result)) &&
+            WriteUint32(file, static_cast<uint32_t>(outcome.messages.size()));
+  for (size_t i = 0; ok && i < outcome.messages.size(); ++i) {
+    const Outcome::Message& message = outcome.messages[i];
+    ok = WriteUint32(file, static_cast<uint32_t>(message.level)) &&
+         WriteUint64(file, message.position.line) &&
+         WriteUint64(file, message.position.column) &&
+         WriteUint64(file, message.position.index) &&
+         WriteString(file, message.source) && WriteString(file, message.text);
+  }
+  ok = (fclose(file) == 0) && ok;
+
+  if (!ok || std::rename(temp_path.c_str(), path.c_str()) != 0) {
+    std::remove(temp_path.c_str());
+  }
+}
+
+spv_validator_cache spvValidatorCacheCreate(size_t capacity,
+                                            const char* directory) {
+  return new spv_validator_cache_t(capacity, directory);
+}
+
+void spvValidatorCacheDestroy(spv_validator_cache cache) { delete cache; }
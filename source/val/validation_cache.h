@@ -0,0 +1,95 @@
+// Copyright (c) 2026 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_VAL_VALIDATION_CACHE_H_
+#define SOURCE_VAL_VALIDATION_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "spirv-tools/libspirv.h"
+
+// Holds the outcomes of validating modules, so that validating the same module
+// again only replays them.  An outcome is found by a 64-bit hash of the module
+// words, the target environment and the validator options that affect
+// validation.  The most recently used outcomes are kept in memory.  If a
+// directory is given, every outcome is also written to a file in it, so that
+// other caches using the directory, in this or other processes, find it too.
+//
+// A cache may be used by several threads at once.
+struct spv_validator_cache_t {
+  // The messages validation sent to the message consumer, and its result.
+  struct Outcome {
+    struct Message {
+      spv_message_level_t level;
+      std::string source;
+      spv_position_t position;
+      std::string text;
+    };
+
+    spv_result_t result = SPV_SUCCESS;
+    std::vector<Message> messages;
+  };
+
+  // Creates a cache that keeps up to |capacity| outcomes in memory.  If
+  // |directory| is not null, it names an existing directory to keep outcomes
+  // in as well.
+  spv_validator_cache_t(size_t capacity, const char* directory);
+
+  // Returns the key for validating the |num_words| words at |words| in
+  // |env| with |options|.
+  static uint64_t Key(spv_target_env env, spv_const_validator_options options,
+                      const uint32_t* words, size_t num_words);
+
+  // Copies the outcome stored for |key| into |outcome| and returns true.
+  // Returns false if there is none.
+  bool Lookup(uint64_t key, Outcome* outcome);
+
+  // Stores |outcome| for |key|.
+  void Store(uint64_t key, const Outcome& outcome);
+
+ private:
+  using Entry = std::pair<uint64_t, Outcome>;
+
+  // Adds |outcome| to the memory for |key| as the most recently used,
+  // forgetting the least recently used one if the memory is full.  The mutex
+  // must be held.
+  void Remember(uint64_t key, const Outcome& outcome);
+
+  // Returns the path of the file that holds the outcome for |key|.
+  std::string PathFor(uint64_t key) const;
+
+  // Reads the file for |key| into |outcome|.  Returns false if it does not
+  // exist or is not a valid outcome file for |key|.
+  bool ReadFile(uint64_t key, Outcome* outcome) const;
+
+  // Writes |outcome| to the file for |key|, replacing it as a whole.
+  void WriteFile(uint64_t key, const Outcome& outcome) const;
+
+  const size_t capacity_;
+  const std::string directory_;
+
+  std::mutex mutex_;
+  // Outcomes in memory, most recently used first.
+  std::list<Entry> entries_;
+  std::unordered_map<uint64_t, std::list<Entry>::iterator> entry_for_key_;
+};
+
+#endif  // SOURCE_VAL_VALIDATION_CACHE_H_
@@ -14,7 +14,9 @@
 
 #include "source/val/validation_state.h"
 
+#include <algorithm>
 #include <cassert>
+#include <functional>
 #include <stack>
 #include <utility>
 
@@ -100,12 +102,13 @@ bool IsInstructionInLayoutSection(ModuleLayoutSection layout, SpvOp op) {
   return layout == InstructionLayoutSection(layout, op);
 }
 
-// Counts the number of instructions and functions in the file.
+// Counts the number of instructions, functions and operands in the file.
 spv_result_t CountInstructions(void* user_data,
                                const spv_parsed_instruction_t* inst) {
   ValidationState_t& _ = *(reinterpret_cast<ValidationState_t*>(user_data));
   if (inst->opcode == SpvOpFunction) _.increment_total_functions();
   _.increment_total_instructions();
+  _.add_total_operands(inst->num_operands);
 
   return SPV_SUCCESS;
 }
@@ -122,6 +125,24 @@ spv_result_t setHeader(void* user_data, spv_endianness_t, uint32_t,
   return SPV_SUCCESS;
 }
 
+// Copies the |count| objects at |first| into the last block of |arena| and
+// returns the copy.  If they do not fit in the capacity of that block, a new
+// block is started instead, so earlier copies never move.
+template <typename T>
+const T* CopyToArena(const T* first, size_t count,
+                     std::vector<std::vector<T>>* arena) {
+  if (arena->empty() ||
+      arena->back().capacity() - arena->back().size() < count) {
+    const size_t kMinBlockSize = 4096;
+    arena->emplace_back();
+    arena->back().reserve(std::max(count, kMinBlockSize));
+  }
+  std::vector<T>& block = arena->back();
+  const size_t offset = block.size();
+  block.insert(block.end(), first, first + count);
+  return block.data() + offset;
+}
+
 // Add features based on SPIR-V core version number.
 void UpdateFeaturesBasedOnSpirvVersion(ValidationState_t::Feature* features,
                                        uint32_t version) {
@@ -152,11 +173,9 @@ ValidationState_t::ValidationState_t(const spv_const_context ctx,
       module_capabilities_(),
       module_extensions_(),
       ordered_instructions_(),
-      all_definitions_(),
       global_vars_(),
-      local_vars_(),
+      num_local_vars_(0),
       struct_nesting_depth_(),
-      struct_has_nested_blockorbufferblock_struct_(),
       grammar_(ctx),
       addressing_model_(SpvAddressingModelMax),
       memory_model_(SpvMemoryModelMax),
@@ -200,6 +219,14 @@ ValidationState_t::ValidationState_t(const spv_const_context ctx,
 void ValidationState_t::preallocateStorage() {
   ordered_instructions_.reserve(total_instructions_);
   module_functions_.reserve(total_functions_);
+  // In low-memory mode, the words are normally referred to rather than
+  // copied, and few operands are copied.
+  if (options_->low_memory) return;
+  // The instructions cannot have more words than the module.
+  word_arena_.assign(1, std::vector<uint32_t>());
+  word_arena_.back().reserve(num_words_);
+  operand_arena_.assign(1, std::vector<spv_parsed_operand_t>());
+  operand_arena_.back().reserve(total_operands_);
 }
 
 spv_result_t ValidationState_t::ForwardDeclareId(uint32_t id) {
@@ -213,12 +240,12 @@ spv_result_t ValidationState_t::RemoveIfForwardDeclared(uint32_t id) {
 }
 
 spv_result_t ValidationState_t::RegisterForwardPointer(uint32_t id) {
-  forward_pointer_ids_.insert(id);
+  SetIdFlag(id, kForwardPointer);
   return SPV_SUCCESS;
 }
 
 bool ValidationState_t::IsForwardPointer(uint32_t id) const {
-  return (forward_pointer_ids_.find(id) != forward_pointer_ids_.end());
+  return HasIdFlag(id, kForwardPointer);
 }
 
 void ValidationState_t::AssignNameToId(uint32_t id, std::string name) {
@@ -244,19 +271,15 @@ std::vector<uint32_t> ValidationState_t::UnresolvedForwardIds() const {
 }
 
 bool ValidationState_t::IsDefinedId(uint32_t id) const {
-  return all_definitions_.find(id) != std::end(all_definitions_);
+  return FindDef(id) != nullptr;
 }
 
 const Instruction* ValidationState_t::FindDef(uint32_t id) const {
-  auto it = all_definitions_.find(id);
-  if (it == all_definitions_.end()) return nullptr;
-  return it->second;
+  return id < id_definitions_.size() ? id_definitions_[id] : nullptr;
 }
 
 Instruction* ValidationState_t::FindDef(uint32_t id) {
-  auto it = all_definitions_.find(id);
-  if (it == all_definitions_.end()) return nullptr;
-  return it->second;
+  return id < id_definitions_.size() ? id_definitions_[id] : nullptr;
 }
 
 ModuleLayoutSection ValidationState_t::current_layout_section() const {
@@ -281,6 +304,18 @@ bool ValidationState_t::IsOpcodeInCurrentLayoutSection(SpvOp op) {
   return IsInstructionInLayoutSection(current_layout_section_, op);
 }
 
+namespace {
+
+// Where diag() sends diagnostics on this thread instead of the context's
+// message consumer, if anywhere.
+thread_local const MessageConsumer* diverted_consumer = nullptr;
+
+}  // namespace
+
+void ValidationState_t::DivertDiagnostics(const MessageConsumer* consumer) {
+  diverted_consumer = consumer;
+}
+
 DiagnosticStream ValidationState_t::diag(spv_result_t error_code,
                                          const Instruction* inst) {
   if (error_code == SPV_WARNING) {
@@ -298,7 +333,9 @@ DiagnosticStream ValidationState_t::diag(spv_result_t error_code,
   if (inst) disassembly = Disassemble(*inst);
 
   return DiagnosticStream({0, 0, inst ? inst->LineNum() : 0},
-                          context_->consumer, disassembly, error_code);
+                          diverted_consumer ? *diverted_consumer
+                                            : context_->consumer,
+                          disassembly, error_code);
 }
 
 std::vector<Function>& ValidationState_t::functions() {
@@ -482,11 +519,103 @@ spv_result_t ValidationState_t::RegisterFunctionEnd() {
 
 Instruction* ValidationState_t::AddOrderedInstruction(
     const spv_parsed_instruction_t* inst) {
-  ordered_instructions_.emplace_back(inst);
+  spv_parsed_instruction_t stored = *inst;
+  if (!options_->low_memory) {
+    stored.words = CopyToArena(inst->words, inst->num_words, &word_arena_);
+    stored.operands =
+        CopyToArena(inst->operands, inst->num_operands, &operand_arena_);
+  } else {
+    // The words of a host-endian module are parsed in place, and the module
+    // outlives validation, so only those of other modules are copied.
+    const std::less<const uint32_t*> before;
+    if (before(inst->words, words_) ||
+        before(words_ + num_words_, inst->words + inst->num_words)) {
+      stored.words = CopyToArena(inst->words, inst->num_words, &word_arena_);
+    }
+    const ArrayView<spv_parsed_operand_t> operands(inst->operands,
+                                                   inst->num_operands);
+    auto shared = shared_operands_.find(operands);
+    if (shared == shared_operands_.end()) {
+      shared = shared_operands_
+                   .insert(ArrayView<spv_parsed_operand_t>(
+                       CopyToArena(inst->operands, inst->num_operands,
+                                   &operand_arena_),
+                       inst->num_operands))
+                   .first;
+    }
+    stored.operands = shared->data();
+  }
+  ordered_instructions_.emplace_back(&stored);
   ordered_instructions_.back().SetLineNum(ordered_instructions_.size());
   return &ordered_instructions_.back();
 }
 
+size_t ValidationState_t::MemoryUse() const {
+  size_t bytes = ordered_instructions_.capacity() * sizeof(Instruction) +
+                 uses_.capacity() * sizeof(uses_[0]);
+  for (const auto& block : word_arena_) {
+    bytes += block.capacity() * sizeof(uint32_t);
+  }
+  for (const auto& block : operand_arena_) {
+    bytes += block.capacity() * sizeof(spv_parsed_operand_t);
+  }
+  bytes += shared_operands_.size() * sizeof(ArrayView<spv_parsed_operand_t>);
+  bytes += id_definitions_.capacity() * sizeof(id_definitions_[0]) +
+           id_flags_.capacity() * sizeof(id_flags_[0]) +
+           id_decoration_lists_.capacity() * sizeof(id_decoration_lists_[0]);
+  for (const auto& function : module_functions_) {
+    bytes += function.ordered_blocks().capacity() * sizeof(BasicBlock*);
+    for (const auto* block : function.ordered_blocks()) {
+      bytes += sizeof(*block) +
+               (block->predecessors()->capacity() +
+                block->successors()->capacity()) *
+                   sizeof(BasicBlock*);
+    }
+  }
+  return bytes;
+}
+
+size_t ValidationState_t::OperandsHash::operator()(
+    const ArrayView<spv_parsed_operand_t>& operands) const {
+  size_t hash = operands.size();
+  for (const auto& operand : operands) {
+    hash = hash * 31 + operand.offset;
+    hash = hash * 31 + operand.num_words;
+    hash = hash * 31 + operand.type;
+    hash = hash * 31 + operand.number_kind;
+    hash = hash * 31 + operand.number_bit_width;
+  }
+  return hash;
+}
+
+bool ValidationState_t::OperandsEqual::operator()(
+    const ArrayView<spv_parsed_operand_t>& lhs,
+    const ArrayView<spv_parsed_operand_t>& rhs) const {
+  return lhs.size() == rhs.size() &&
+         std::equal(lhs.begin(), lhs.end(), rhs.begin(),
+                    [](const spv_parsed_operand_t& l,
+                       const spv_parsed_operand_t& r) {
+                      return l.offset == r.offset &&
+                             l.num_words == r.num_words &&
+                             l.type == r.type &&
+                             l.number_kind == r.number_kind &&
+                             l.number_bit_width == r.number_bit_width;
+                    });
+}
+
+void ValidationState_t::ReserveUses(const std::vector<uint32_t>& num_uses) {
+  assert(num_uses.size() == ordered_instructions_.size());
+  size_t total = 0;
+  for (uint32_t n : num_uses) total += n;
+  uses_.assign(total, std::make_pair(nullptr, 0u));
+  uses_.shrink_to_fit();
+  size_t begin = 0;
+  for (size_t i = 0; i < num_uses.size(); ++i) {
+    ordered_instructions_[i].SetUseStorage(uses_.data() + begin);
+    begin += num_uses[i];
+  }
+}
+
 // Improves diagnostic messages by collecting names of IDs
 void ValidationState_t::RegisterDebugInstruction(const Instruction* inst) {
   switch (inst->opcode()) {
@@ -516,7 +645,11 @@ void ValidationState_t::RegisterDebugInstruction(const Instruction* inst) {
 }
 
 void ValidationState_t::RegisterInstruction(Instruction* inst) {
-  if (inst->id()) all_definitions_.insert(std::make_pair(inst->id(), inst));
+  if (const uint32_t id = inst->id()) {
+    if (id >= id_definitions_.size()) id_definitions_.resize(id + 1, nullptr);
+    // Like insertion into a map, the first definition of an id is kept.
+    if (!id_definitions_[id]) id_definitions_[id] = inst;
+  }
 
   // If the instruction is using an OpTypeSampledImage as an operand, it should
   // be recorded. The validator will ensure that all usages of an
@@ -553,22 +686,53 @@ uint32_t ValidationState_t::getIdBound() const { return id_bound_; }
 void ValidationState_t::setIdBound(const uint32_t bound) { id_bound_ = bound; }
 
 bool ValidationState_t::RegisterUniqueTypeDeclaration(const Instruction* inst) {
-  std::vector<uint32_t> key;
-  key.push_back(static_cast<uint32_t>(inst->opcode()));
-  for (size_t index = 0; index < inst->operands().size(); ++index) {
-    const spv_parsed_operand_t& operand = inst->operand(index);
+  return unique_type_declarations_.insert(inst).second;
+}
 
-    if (operand.type == SPV_OPERAND_TYPE_RESULT_ID) continue;
+namespace {
 
-    const int words_begin = operand.offset;
-    const int words_end = words_begin + operand.num_words;
-    assert(words_end <= static_cast<int>(inst->words().size()));
+// Returns the index of the result id word of the type declaration |inst|, or
+// its number of words if it has none, like OpTypeForwardPointer, in which case
+// all its words are significant.
+size_t ResultIdWordIndex(const Instruction* inst) {
+  for (const auto& operand : inst->operands()) {
+    if (operand.type == SPV_OPERAND_TYPE_RESULT_ID) return operand.offset;
+  }
+  return inst->words().size();
+}
 
-    key.insert(key.end(), inst->words().begin() + words_begin,
-               inst->words().begin() + words_end);
+}  // namespace
+
+size_t ValidationState_t::TypeDeclarationHash::operator()(
+    const Instruction* inst) const {
+  // The first word holds the opcode, and the word count which is implied by
+  // the number of words hashed.
+  const auto words = inst->words();
+  const size_t result_index = ResultIdWordIndex(inst);
+  size_t hash = 0;
+  for (size_t index = 0; index < words.size(); ++index) {
+    if (index == result_index) continue;
+    hash = hash * 31 + words[index];
   }
+  return hash;
+}
 
-  return unique_type_declarations_.insert(std::move(key)).second;
+bool ValidationState_t::TypeDeclarationEqual::operator()(
+    const Instruction* lhs, const Instruction* rhs) const {
+  // Declarations with the same opcode and word count have their operands,
+  // and so their result ids, in the same places.
+  const auto lhs_words = lhs->words();
+  const auto rhs_words = rhs->words();
+  if (lhs_words.size() != rhs_words.size() || lhs_words[0] != rhs_words[0]) {
+    return false;
+  }
+  const size_t result_index = ResultIdWordIndex(lhs);
+  for (size_t index = 1; index < lhs_words.size(); ++index) {
+    if (index != result_index && lhs_words[index] != rhs_words[index]) {
+      return false;
+    }
+  }
+  return true;
 }
 
 uint32_t ValidationState_t::GetTypeId(uint32_t id) const {
@@ -1110,8 +1274,8 @@ bool ValidationState_t::LogicallyMatch(const Instruction* lhs,
   }
 
   if (check_decorations) {
-    const auto& dec_a = id_decorations(lhs->id());
-    const auto& dec_b = id_decorations(rhs->id());
+    const auto& dec_a = FindDecorations(lhs->id());
+    const auto& dec_b = FindDecorations(rhs->id());
 
     for (const auto& dec : dec_b) {
       if (std::find(dec_a.begin(), dec_a.end(), dec) == dec_a.end()) {
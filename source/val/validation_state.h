@@ -16,6 +16,7 @@
 #define SOURCE_VAL_VALIDATION_STATE_H_
 
 #include <algorithm>
+#include <deque>
 #include <map>
 #include <set>
 #include <string>
@@ -181,11 +182,15 @@ class ValidationState_t {
   /// Increments the total number of instructions in the file.
   void increment_total_instructions() { total_instructions_++; }
 
+  /// Adds |count| to the total number of operands in the file.
+  void add_total_operands(size_t count) { total_operands_ += count; }
+
   /// Increments the total number of functions in the file.
   void increment_total_functions() { total_functions_++; }
 
   /// Allocates internal storage. Note, calling this will invalidate any
-  /// pointers to |ordered_instructions_| or |module_functions_| and, hence,
+  /// pointers to |ordered_instructions_|, |module_functions_| or the
+  /// instruction arenas and, hence,
   /// should only be called at the beginning of validation.
   void preallocateStorage();
 
@@ -203,6 +208,12 @@ class ValidationState_t {
 
   DiagnosticStream diag(spv_result_t error_code, const Instruction* inst);
 
+  /// Sends the diagnostics that diag() emits on the calling thread to
+  /// |consumer| instead of the context's message consumer, until this is
+  /// called again with nullptr.  Used to collect the diagnostics of checks
+  /// that run on several threads at once.
+  static void DivertDiagnostics(const MessageConsumer* consumer);
+
   /// Returns the function states
   std::vector<Function>& functions();
 
@@ -298,13 +309,13 @@ class ValidationState_t {
 
   /// Inserts an <id> to the set of functions that are target of OpFunctionCall.
   void AddFunctionCallTarget(const uint32_t id) {
-    function_call_targets_.insert(id);
+    SetIdFlag(id, kFunctionCallTarget);
     current_function().AddFunctionCallTarget(id);
   }
 
   /// Returns whether or not a function<id> is the target of OpFunctionCall.
-  bool IsFunctionCallTarget(const uint32_t id) {
-    return (function_call_targets_.find(id) != function_call_targets_.end());
+  bool IsFunctionCallTarget(const uint32_t id) const {
+    return HasIdFlag(id, kFunctionCallTarget);
   }
 
   bool IsFunctionCallDefined(const uint32_t id) {
@@ -377,6 +388,18 @@ class ValidationState_t {
   /// Inserts the instruction into the list of ordered instructions in the file.
   Instruction* AddOrderedInstruction(const spv_parsed_instruction_t* inst);
 
+  /// Returns a partial estimate of the bytes held by the validation state: for
+  /// the instructions of the module, with their words, operands and uses, for
+  /// each id, and for the blocks of each function.  It leaves out the rest of
+  /// the state, such as the per-function maps and the constructs, and so
+  /// falls short of the memory the validator actually uses.
+  size_t MemoryUse() const;
+
+  /// Gives the uses of each instruction room in a single buffer, for
+  /// |num_uses[i]| uses of the i-th ordered instruction.  Any uses registered
+  /// before are forgotten.
+  void ReserveUses(const std::vector<uint32_t>& num_uses);
+
   /// Registers the instruction. This will add the instruction to the list of
   /// definitions and register sampled image consumers.
   void RegisterInstruction(Instruction* inst);
@@ -386,7 +409,7 @@ class ValidationState_t {
 
   /// Registers the decoration for the given <id>
   void RegisterDecorationForId(uint32_t id, const Decoration& dec) {
-    auto& dec_list = id_decorations_[id];
+    auto& dec_list = id_decorations(id);
     auto lb = std::find(dec_list.begin(), dec_list.end(), dec);
     if (lb == dec_list.end()) {
       dec_list.push_back(dec);
@@ -396,7 +419,7 @@ class ValidationState_t {
   /// Registers the list of decorations for the given <id>
   template <class InputIt>
   void RegisterDecorationsForId(uint32_t id, InputIt begin, InputIt end) {
-    std::vector<Decoration>& cur_decs = id_decorations_[id];
+    std::vector<Decoration>& cur_decs = id_decorations(id);
     cur_decs.insert(cur_decs.end(), begin, end);
   }
 
@@ -407,31 +430,47 @@ class ValidationState_t {
                                           uint32_t member_index, InputIt begin,
                                           InputIt end) {
     RegisterDecorationsForId(struct_id, begin, end);
-    for (auto& decoration : id_decorations_[struct_id]) {
+    for (auto& decoration : id_decorations(struct_id)) {
       decoration.set_struct_member_index(member_index);
     }
   }
 
   /// Returns all the decorations for the given <id>. If no decorations exist
-  /// for the <id>, it registers an empty vector for it in the map and
-  /// returns the empty vector.
+  /// for the <id>, it registers an empty vector for it and returns the empty
+  /// vector.
   std::vector<Decoration>& id_decorations(uint32_t id) {
-    return id_decorations_[id];
+    if (id >= id_decoration_lists_.size()) id_decoration_lists_.resize(id + 1);
+    uint32_t& list = id_decoration_lists_[id];
+    if (!list) {
+      decoration_lists_.emplace_back();
+      list = static_cast<uint32_t>(decoration_lists_.size());
+    }
+    return decoration_lists_[list - 1];
   }
 
-  // Returns const pointer to the internal decoration container.
-  const std::map<uint32_t, std::vector<Decoration>>& id_decorations() const {
-    return id_decorations_;
+  /// Returns all the decorations for the given <id>, or an empty vector if
+  /// there are none.  Unlike id_decorations(), it never modifies the
+  /// decoration lists, so it may be called from several threads at once.
+  const std::vector<Decoration>& FindDecorations(uint32_t id) const {
+    static const std::vector<Decoration> kNoDecorations;
+    const uint32_t list =
+        id < id_decoration_lists_.size() ? id_decoration_lists_[id] : 0;
+    return list ? decoration_lists_[list - 1] : kNoDecorations;
+  }
+
+  /// Returns a bound on the ids that have decorations.  Unlike the id bound in
+  /// the header, it only covers ids that have been decorated, so looping up to
+  /// it does not depend on a bogus header bound.
+  uint32_t decorated_id_bound() const {
+    return static_cast<uint32_t>(id_decoration_lists_.size());
   }
 
   /// Returns true if the given id <id> has the given decoration <dec>,
   /// otherwise returns false.
-  bool HasDecoration(uint32_t id, SpvDecoration dec) {
-    const auto& decorations = id_decorations_.find(id);
-    if (decorations == id_decorations_.end()) return false;
-
+  bool HasDecoration(uint32_t id, SpvDecoration dec) const {
+    const auto& decorations = FindDecorations(id);
     return std::any_of(
-        decorations->second.begin(), decorations->second.end(),
+        decorations.begin(), decorations.end(),
         [dec](const Decoration& d) { return dec == d.dec_type(); });
   }
 
@@ -448,9 +487,10 @@ class ValidationState_t {
     return ordered_instructions_;
   }
 
-  /// Returns a map of instructions mapped by their result id
-  const std::unordered_map<uint32_t, Instruction*>& all_definitions() const {
-    return all_definitions_;
+  /// Returns the definition of each id, indexed by id.  Ids without a
+  /// definition, and those past the end, have none.
+  const std::vector<Instruction*>& id_definitions() const {
+    return id_definitions_;
   }
 
   /// Returns a vector containing the instructions that consume the given
@@ -461,23 +501,20 @@ class ValidationState_t {
   void RegisterSampledImageConsumer(uint32_t sampled_image_id,
                                     Instruction* consumer);
 
-  /// Returns the set of Global Variables.
-  std::unordered_set<uint32_t>& global_vars() { return global_vars_; }
-
-  /// Returns the set of Local Variables.
-  std::unordered_set<uint32_t>& local_vars() { return local_vars_; }
+  /// Returns the Global Variables, in the order they were registered.
+  const std::vector<uint32_t>& global_vars() const { return global_vars_; }
 
   /// Returns the number of Global Variables.
-  size_t num_global_vars() { return global_vars_.size(); }
+  size_t num_global_vars() const { return global_vars_.size(); }
 
   /// Returns the number of Local Variables.
-  size_t num_local_vars() { return local_vars_.size(); }
+  size_t num_local_vars() const { return num_local_vars_; }
 
-  /// Inserts a new <id> to the set of Global Variables.
-  void registerGlobalVariable(const uint32_t id) { global_vars_.insert(id); }
+  /// Adds a new <id> to the Global Variables.  Each <id> is registered once.
+  void registerGlobalVariable(const uint32_t id) { global_vars_.push_back(id); }
 
-  /// Inserts a new <id> to the set of Local Variables.
-  void registerLocalVariable(const uint32_t id) { local_vars_.insert(id); }
+  /// Counts a new <id> as a Local Variable.  Each <id> is registered once.
+  void registerLocalVariable(const uint32_t /* id */) { ++num_local_vars_; }
 
   // Returns true if using relaxed block layout, equivalent to
   // VK_KHR_relaxed_block_layout.
@@ -498,23 +535,27 @@ class ValidationState_t {
   /// Records the has a nested block/bufferblock decorated struct for a given
   /// struct ID
   void SetHasNestedBlockOrBufferBlockStruct(uint32_t id, bool has) {
-    struct_has_nested_blockorbufferblock_struct_[id] = has;
+    if (has) {
+      SetIdFlag(id, kHasNestedBlockOrBufferBlockStruct);
+    } else if (id < id_flags_.size()) {
+      id_flags_[id] &= ~kHasNestedBlockOrBufferBlockStruct;
+    }
   }
 
   /// For a given struct ID returns true if it has a nested block/bufferblock
   /// decorated struct
-  bool GetHasNestedBlockOrBufferBlockStruct(uint32_t id) {
-    return struct_has_nested_blockorbufferblock_struct_[id];
+  bool GetHasNestedBlockOrBufferBlockStruct(uint32_t id) const {
+    return HasIdFlag(id, kHasNestedBlockOrBufferBlockStruct);
   }
 
   /// Records that the structure type has a member decorated with a built-in.
   void RegisterStructTypeWithBuiltInMember(uint32_t id) {
-    builtin_structs_.insert(id);
+    SetIdFlag(id, kStructWithBuiltInMember);
   }
 
   /// Returns true if the struct type with the given Id has a BuiltIn member.
   bool IsStructTypeWithBuiltInMember(uint32_t id) const {
-    return (builtin_structs_.find(id) != builtin_structs_.end());
+    return HasIdFlag(id, kStructWithBuiltInMember);
   }
 
   // Returns the state of optional features.
@@ -612,57 +653,52 @@ class ValidationState_t {
   // in uniform storage class? The result is only valid after internal method
   // CheckDecorationsOfBuffers has been called.
   bool IsPointerToUniformBlock(uint32_t type_id) const {
-    return pointer_to_uniform_block_.find(type_id) !=
-           pointer_to_uniform_block_.cend();
+    return HasIdFlag(type_id, kPointerToUniformBlock);
   }
   // Save the ID of a pointer to uniform block.
   void RegisterPointerToUniformBlock(uint32_t type_id) {
-    pointer_to_uniform_block_.insert(type_id);
+    SetIdFlag(type_id, kPointerToUniformBlock);
   }
   // Is the ID the type of a struct used as a uniform block?
   // The result is only valid after internal method CheckDecorationsOfBuffers
   // has been called.
   bool IsStructForUniformBlock(uint32_t type_id) const {
-    return struct_for_uniform_block_.find(type_id) !=
-           struct_for_uniform_block_.cend();
+    return HasIdFlag(type_id, kStructForUniformBlock);
   }
   // Save the ID of a struct of a uniform block.
   void RegisterStructForUniformBlock(uint32_t type_id) {
-    struct_for_uniform_block_.insert(type_id);
+    SetIdFlag(type_id, kStructForUniformBlock);
   }
   // Is the ID the type of a pointer to a storage buffer: BufferBlock-decorated
   // struct in uniform storage class, or Block-decorated struct in StorageBuffer
   // storage class? The result is only valid after internal method
   // CheckDecorationsOfBuffers has been called.
   bool IsPointerToStorageBuffer(uint32_t type_id) const {
-    return pointer_to_storage_buffer_.find(type_id) !=
-           pointer_to_storage_buffer_.cend();
+    return HasIdFlag(type_id, kPointerToStorageBuffer);
   }
   // Save the ID of a pointer to a storage buffer.
   void RegisterPointerToStorageBuffer(uint32_t type_id) {
-    pointer_to_storage_buffer_.insert(type_id);
+    SetIdFlag(type_id, kPointerToStorageBuffer);
   }
   // Is the ID the type of a struct for storage buffer?
   // The result is only valid after internal method CheckDecorationsOfBuffers
   // has been called.
   bool IsStructForStorageBuffer(uint32_t type_id) const {
-    return struct_for_storage_buffer_.find(type_id) !=
-           struct_for_storage_buffer_.cend();
+    return HasIdFlag(type_id, kStructForStorageBuffer);
   }
   // Save the ID of a struct of a storage buffer.
   void RegisterStructForStorageBuffer(uint32_t type_id) {
-    struct_for_storage_buffer_.insert(type_id);
+    SetIdFlag(type_id, kStructForStorageBuffer);
   }
 
   // Is the ID the type of a pointer to a storage image?  That is, the pointee
   // type is an image type which is known to not use a sampler.
   bool IsPointerToStorageImage(uint32_t type_id) const {
-    return pointer_to_storage_image_.find(type_id) !=
-           pointer_to_storage_image_.cend();
+    return HasIdFlag(type_id, kPointerToStorageImage);
   }
   // Save the ID of a pointer to a storage image.
   void RegisterPointerToStorageImage(uint32_t type_id) {
-    pointer_to_storage_image_.insert(type_id);
+    SetIdFlag(type_id, kPointerToStorageImage);
   }
 
   // Tries to evaluate a 32-bit signed or unsigned scalar integer constant.
@@ -729,6 +765,18 @@ class ValidationState_t {
  private:
   ValidationState_t(const ValidationState_t&);
 
+  /// Hashes a type declaration by its opcode and operand words, leaving out
+  /// its result id.
+  struct TypeDeclarationHash {
+    size_t operator()(const Instruction* inst) const;
+  };
+
+  /// Returns true if two type declarations have the same opcode and operand
+  /// words, leaving out their result ids.
+  struct TypeDeclarationEqual {
+    bool operator()(const Instruction* lhs, const Instruction* rhs) const;
+  };
+
   const spv_const_context context_;
 
   /// Stores the Validator command line options. Must be a valid options object.
@@ -748,13 +796,12 @@ class ValidationState_t {
   size_t total_instructions_ = 0;
   /// The total number of functions in the binary.
   size_t total_functions_ = 0;
+  /// The total number of operands of all instructions in the binary.
+  size_t total_operands_ = 0;
 
   /// IDs which have been forward declared but have not been defined
   std::unordered_set<uint32_t> unresolved_forward_ids_;
 
-  /// IDs that have been declared as forward pointers.
-  std::unordered_set<uint32_t> forward_pointer_ids_;
-
   /// Stores a vector of instructions that use the result of a given
   /// OpSampledImage instruction.
   std::unordered_map<uint32_t, std::vector<Instruction*>>
@@ -780,8 +827,74 @@ class ValidationState_t {
   /// List of all instructions in the order they appear in the binary
   std::vector<Instruction> ordered_instructions_;
 
-  /// Instructions that can be referenced by Ids
-  std::unordered_map<uint32_t, Instruction*> all_definitions_;
+  /// The words and operands of the instructions in |ordered_instructions_|,
+  /// which only refer to them.  Each arena is a list of blocks that are never
+  /// grown past their reserved capacity, so the copies never move.  The first
+  /// block is sized from the counting pass, so normally there is only one.
+  std::vector<std::vector<uint32_t>> word_arena_;
+  std::vector<std::vector<spv_parsed_operand_t>> operand_arena_;
+
+  /// Hashes and compares the operands of instructions by their contents.
+  struct OperandsHash {
+    size_t operator()(const ArrayView<spv_parsed_operand_t>& operands) const;
+  };
+  struct OperandsEqual {
+    bool operator()(const ArrayView<spv_parsed_operand_t>& lhs,
+                    const ArrayView<spv_parsed_operand_t>& rhs) const;
+  };
+
+  /// In low-memory mode, the copies in |operand_arena_|, which are shared by
+  /// all instructions whose operands are the same.  Instructions of the same
+  /// form have the same operands, so there are few copies.
+  std::unordered_set<ArrayView<spv_parsed_operand_t>, OperandsHash,
+                     OperandsEqual>
+      shared_operands_;
+
+  /// The uses of all the instructions in |ordered_instructions_|, those of
+  /// each instruction together.
+  std::vector<std::pair<const Instruction*, uint32_t>> uses_;
+
+  /// Ids are dense below the bound in the header, so what the validator keeps
+  /// for each id is held in arrays indexed by id.  The arrays grow as ids are
+  /// seen, rather than up front, so a bogus bound does not cost memory.
+
+  /// Facts about each id that are bits in id_flags_.
+  enum IdFlag : uint16_t {
+    kFunctionCallTarget = 1 << 0,
+    kForwardPointer = 1 << 1,
+    kStructWithBuiltInMember = 1 << 2,
+    kHasNestedBlockOrBufferBlockStruct = 1 << 3,
+    kPointerToUniformBlock = 1 << 4,
+    kStructForUniformBlock = 1 << 5,
+    kPointerToStorageBuffer = 1 << 6,
+    kStructForStorageBuffer = 1 << 7,
+    kPointerToStorageImage = 1 << 8,
+  };
+
+  /// Returns true if |id| has |flag| set.
+  bool HasIdFlag(uint32_t id, IdFlag flag) const {
+    return id < id_flags_.size() && (id_flags_[id] & flag);
+  }
+
+  /// Sets |flag| for |id|.
+  void SetIdFlag(uint32_t id, IdFlag flag) {
+    if (id >= id_flags_.size()) id_flags_.resize(id + 1);
+    id_flags_[id] |= flag;
+  }
+
+  /// The instruction that defines each id, or nullptr.
+  std::vector<Instruction*> id_definitions_;
+
+  /// The IdFlag bits of each id.
+  std::vector<uint16_t> id_flags_;
+
+  /// For each id, one more than the index of its decorations in
+  /// decoration_lists_, or zero if it has none.
+  std::vector<uint32_t> id_decoration_lists_;
+
+  /// The decorations of the ids that have any.  A deque, so that adding a list
+  /// does not move the others.
+  std::deque<std::vector<Decoration>> decoration_lists_;
 
   /// IDs that are entry points, ie, arguments to OpEntryPoint.
   std::vector<uint32_t> entry_points_;
@@ -794,36 +907,24 @@ class ValidationState_t {
   /// graph that recurses.
   std::set<uint32_t> recursive_entry_points_;
 
-  /// Functions IDs that are target of OpFunctionCall.
-  std::unordered_set<uint32_t> function_call_targets_;
-
   /// ID Bound from the Header
   uint32_t id_bound_;
 
-  /// Set of Global Variable IDs (Storage Class other than 'Function')
-  std::unordered_set<uint32_t> global_vars_;
+  /// Global Variable IDs (Storage Class other than 'Function')
+  std::vector<uint32_t> global_vars_;
 
-  /// Set of Local Variable IDs ('Function' Storage Class)
-  std::unordered_set<uint32_t> local_vars_;
-
-  /// Set of struct types that have members with a BuiltIn decoration.
-  std::unordered_set<uint32_t> builtin_structs_;
+  /// Number of Local Variables ('Function' Storage Class)
+  size_t num_local_vars_;
 
   /// Structure Nesting Depth
   std::unordered_map<uint32_t, uint32_t> struct_nesting_depth_;
 
-  /// Structure has nested blockorbufferblock struct
-  std::unordered_map<uint32_t, bool>
-      struct_has_nested_blockorbufferblock_struct_;
-
-  /// Stores the list of decorations for a given <id>
-  std::map<uint32_t, std::vector<Decoration>> id_decorations_;
-
-  /// Stores type declarations which need to be unique (i.e. non-aggregates),
-  /// in the form [opcode, operand words], result_id is not stored.
-  /// Using ordered set to avoid the need for a vector hash function.
-  /// The size of this container is expected not to exceed double-digits.
-  std::set<std::vector<uint32_t>> unique_type_declarations_;
+  /// Stores type declarations which need to be unique (i.e. non-aggregates).
+  /// The declarations are compared through their words in place, so nothing
+  /// is copied.
+  std::unordered_set<const Instruction*, TypeDeclarationHash,
+                     TypeDeclarationEqual>
+      unique_type_declarations_;
 
   AssemblyGrammar grammar_;
 
@@ -858,23 +959,6 @@ class ValidationState_t {
   std::unordered_map<uint32_t, std::vector<uint32_t>> function_to_entry_points_;
   const std::vector<uint32_t> empty_ids_;
 
-  // The IDs of types of pointers to Block-decorated structs in Uniform storage
-  // class. This is populated at the start of ValidateDecorations.
-  std::unordered_set<uint32_t> pointer_to_uniform_block_;
-  // The IDs of struct types for uniform blocks.
-  // This is populated at the start of ValidateDecorations.
-  std::unordered_set<uint32_t> struct_for_uniform_block_;
-  // The IDs of types of pointers to BufferBlock-decorated structs in Uniform
-  // storage class, or Block-decorated structs in StorageBuffer storage class.
-  // This is populated at the start of ValidateDecorations.
-  std::unordered_set<uint32_t> pointer_to_storage_buffer_;
-  // The IDs of struct types for storage buffers.
-  // This is populated at the start of ValidateDecorations.
-  std::unordered_set<uint32_t> struct_for_storage_buffer_;
-  // The IDs of types of pointers to storage images.  This is populated in the
-  // TypePass.
-  std::unordered_set<uint32_t> pointer_to_storage_image_;
-
   /// Maps ids to friendly names.
   std::unique_ptr<spvtools::FriendlyNameMapper> friendly_mapper_;
   spvtools::NameMapper name_mapper_;
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <set>
 #include <string>
 #include <vector>
 
@@ -73,5 +74,29 @@ INSTANTIATE_TEST_SUITE_P(
     }));
 // clang-format on
 
+TEST(AssemblyContextTest, NamedIdsAreAssignedOnceInOrder) {
+  AssemblyContext context(AutoText(""), nullptr);
+  // Enough names to grow the name table several times.
+  const uint32_t kNumNames = 1000;
+  for (uint32_t i = 0; i < kNumNames; ++i) {
+    const std::string name = "name" + std::to_string(i);
+    EXPECT_EQ(i + 1, context.spvNamedIdAssignOrGet(name.c_str()));
+  }
+  for (uint32_t i = 0; i < kNumNames; ++i) {
+    const std::string name = "name" + std::to_string(i);
+    EXPECT_EQ(i + 1, context.spvNamedIdAssignOrGet(name.c_str()));
+  }
+  EXPECT_EQ(kNumNames + 1, context.getBound());
+}
+
+TEST(AssemblyContextTest, GetNumericIdsSkipsNonNumericNames) {
+  AssemblyContext context(AutoText(""), nullptr);
+  context.spvNamedIdAssignOrGet("12");
+  context.spvNamedIdAssignOrGet("foo");
+  context.spvNamedIdAssignOrGet("3");
+  context.spvNamedIdAssignOrGet("4bar");
+  EXPECT_THAT(context.GetNumericIds(), Eq(std::set<uint32_t>{3, 12}));
+}
+
 }  // namespace
 }  // namespace spvtools
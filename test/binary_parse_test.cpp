@@ -45,6 +45,7 @@ using ::spvtest::ScopedContext;
 using ::testing::_;
 using ::testing::AnyOf;
 using ::testing::Eq;
+using ::testing::HasSubstr;
 using ::testing::InSequence;
 using ::testing::Return;
 
@@ -485,6 +486,382 @@ TEST_F(BinaryParseTest, EarlyReturnWithTwoPassingCallbacks) {
   }
 }
 
+// Parsing a module in host endianness must not copy instruction words: the
+// parsed instruction refers directly to the caller's buffer.
+TEST_F(BinaryParseTest, HostEndianInstructionWordsPointIntoInputBuffer) {
+  const auto words = CompileSuccessfully(
+      "%1 = OpTypeVoid "
+      "%2 = OpTypeInt 32 1 "
+      "%3 = OpTypeFloat 32");
+  std::vector<const uint32_t*> inst_words;
+  auto record_words = [](void* user_data,
+                         const spv_parsed_instruction_t* inst) {
+    static_cast<std::vector<const uint32_t*>*>(user_data)->push_back(
+        inst->words);
+    return SPV_SUCCESS;
+  };
+  EXPECT_EQ(SPV_SUCCESS,
+            spvBinaryParse(ScopedContext().context, &inst_words, words.data(),
+                           words.size(), nullptr, record_words, &diagnostic_));
+  EXPECT_EQ(nullptr, diagnostic_);
+  ASSERT_EQ(3u, inst_words.size());
+  EXPECT_EQ(words.data() + SPV_INDEX_INSTRUCTION, inst_words[0]);
+  EXPECT_EQ(words.data() + SPV_INDEX_INSTRUCTION + 2, inst_words[1]);
+  EXPECT_EQ(words.data() + SPV_INDEX_INSTRUCTION + 6, inst_words[2]);
+}
+
+// Feeds the bytes of the given words to a binary parser, piece_size bytes at
+// a time, then finishes the module.  Returns the result of the first call
+// that fails, or of spvBinaryParserFinish().
+spv_result_t FeedInPieces(spv_binary_parser parser,
+                          const std::vector<uint32_t>& words,
+                          size_t piece_size, spv_diagnostic* diagnostic) {
+  const auto* bytes = reinterpret_cast<const unsigned char*>(words.data());
+  const size_t num_bytes = words.size() * sizeof(uint32_t);
+  for (size_t offset = 0; offset < num_bytes; offset += piece_size) {
+    const size_t size = std::min(piece_size, num_bytes - offset);
+    const spv_result_t result =
+        spvBinaryParserFeed(parser, bytes + offset, size, diagnostic);
+    if (result != SPV_SUCCESS) return result;
+  }
+  return spvBinaryParserFinish(parser, diagnostic);
+}
+
+TEST_F(BinaryParseTest, StreamingParserMatchesWholeModuleParse) {
+  const size_t kPieceSizes[] = {1, 3, 4, 7, 4096};
+  for (bool endian_swap : kSwapEndians) {
+    for (size_t piece_size : kPieceSizes) {
+      auto words = CompileSuccessfully(
+          "%1 = OpTypeVoid "
+          "%2 = OpTypeInt 32 1");
+      if (endian_swap) {
+        spvFixWords(words.data(), words.size(),
+                    I32_ENDIAN_HOST == I32_ENDIAN_BIG ? SPV_ENDIANNESS_LITTLE
+                                                      : SPV_ENDIANNESS_BIG,
+                    words.data());
+      }
+      InSequence calls_expected_in_specific_order;
+      EXPECT_HEADER(3).WillOnce(Return(SPV_SUCCESS));
+      EXPECT_CALL(client_, Instruction(MakeParsedVoidTypeInstruction(1)))
+          .WillOnce(Return(SPV_SUCCESS));
+      EXPECT_CALL(client_, Instruction(MakeParsedInt32TypeInstruction(2)))
+          .WillOnce(Return(SPV_SUCCESS));
+      ScopedContext context;
+      spv_binary_parser parser = spvBinaryParserCreate(
+          context.context, &client_, invoke_header, invoke_instruction);
+      ASSERT_NE(nullptr, parser);
+      EXPECT_EQ(SPV_SUCCESS,
+                FeedInPieces(parser, words, piece_size, &diagnostic_));
+      EXPECT_EQ(nullptr, diagnostic_);
+      spvBinaryParserDestroy(parser);
+    }
+  }
+}
+
+TEST_F(BinaryParseTest, StreamingParserTracksIdsBeyondTheWordsSeen) {
+  // When %20 is defined, fewer than 20 words have been fed, so it is kept
+  // apart from the ids table until the table grows to cover it.
+  std::vector<std::vector<uint32_t>> pieces = {
+      CompileSuccessfully(""), MakeInstruction(SpvOpTypeInt, {20, 32, 0})};
+  pieces.insert(pieces.end(), 20, MakeInstruction(SpvOpNop, {}));
+  pieces.push_back(MakeInstruction(SpvOpConstant, {20, 21, 7}));
+  pieces.push_back(MakeInstruction(SpvOpConstant, {20, 22, 8}));
+  auto words = Concatenate(pieces);
+  words[SPV_INDEX_BOUND] = 23;
+  ScopedContext context;
+  spv_binary_parser parser =
+      spvBinaryParserCreate(context.context, nullptr, nullptr, nullptr);
+  EXPECT_EQ(SPV_SUCCESS, FeedInPieces(parser, words, 4, &diagnostic_));
+  EXPECT_EQ(nullptr, diagnostic_);
+
+  words = Concatenate({words, MakeInstruction(SpvOpTypeInt, {20, 32, 1})});
+  EXPECT_EQ(SPV_ERROR_INVALID_ID,
+            FeedInPieces(parser, words, 4, &diagnostic_));
+  ASSERT_NE(nullptr, diagnostic_);
+  EXPECT_EQ("Id 20 is defined more than once",
+            std::string(diagnostic_->error));
+  spvBinaryParserDestroy(parser);
+}
+
+TEST_F(BinaryParseTest, IdsBeyondABogusBound) {
+  auto words = Concatenate(
+      {CompileSuccessfully(""), MakeInstruction(SpvOpTypeInt, {1000, 32, 0}),
+       MakeInstruction(SpvOpConstant, {1000, 1001, 7}),
+       MakeInstruction(SpvOpExtInstImport, {1002}, MakeVector("OpenCL.std")),
+       MakeInstruction(SpvOpExtInst,
+                       {1000, 1003, 1002,
+                        uint32_t(OpenCLLIB::Entrypoints::Sqrt), 1001})});
+  words[SPV_INDEX_BOUND] = 0xffffffff;
+  EXPECT_EQ(SPV_SUCCESS,
+            spvBinaryParse(ScopedContext().context, nullptr, words.data(),
+                           words.size(), nullptr, nullptr, &diagnostic_));
+  EXPECT_EQ(nullptr, diagnostic_);
+}
+
+TEST_F(BinaryParseTest, IndexRecordsSectionsFunctionsAndLabels) {
+  const auto words = CompileSuccessfully(R"(
+    OpCapability Shader
+    OpMemoryModel Logical GLSL450
+    OpName %f "f"
+    %void = OpTypeVoid
+    %fnty = OpTypeFunction %void
+    %decl = OpFunction %void None %fnty
+    OpFunctionEnd
+    %f = OpFunction %void None %fnty
+    %entry = OpLabel
+    OpBranch %next
+    %next = OpLabel
+    OpReturn
+    OpFunctionEnd
+  )");
+  EXPECT_HEADER(7).WillOnce(Return(SPV_SUCCESS));
+  EXPECT_CALL(client_, Instruction(_))
+      .Times(13)
+      .WillRepeatedly(Return(SPV_SUCCESS));
+  spv_binary_index index = nullptr;
+  ASSERT_EQ(SPV_SUCCESS, spvBinaryParseWithIndex(
+                             ScopedContext().context, &client_, words.data(),
+                             words.size(), invoke_header, invoke_instruction,
+                             &index, &diagnostic_));
+  ASSERT_NE(nullptr, index);
+
+  std::vector<std::pair<size_t, size_t>> sections;
+  for (const auto& section : index->sections)
+    sections.emplace_back(section.word_offset, section.num_words);
+  std::vector<std::pair<size_t, size_t>> expected_sections(
+      SPV_BINARY_SECTION_COUNT);
+  expected_sections[SPV_BINARY_SECTION_CAPABILITIES] = {5, 2};
+  expected_sections[SPV_BINARY_SECTION_MEMORY_MODEL] = {7, 3};
+  expected_sections[SPV_BINARY_SECTION_DEBUG_NAMES] = {10, 3};
+  expected_sections[SPV_BINARY_SECTION_TYPES] = {13, 5};
+  expected_sections[SPV_BINARY_SECTION_FUNCTION_DECLARATIONS] = {18, 6};
+  expected_sections[SPV_BINARY_SECTION_FUNCTION_DEFINITIONS] = {24, 13};
+  EXPECT_THAT(sections, Eq(expected_sections));
+
+  ASSERT_EQ(2u, index->num_functions);
+  EXPECT_EQ(4u, index->functions[0].id);
+  EXPECT_EQ(18u, index->functions[0].word_offset);
+  EXPECT_EQ(6u, index->functions[0].num_words);
+  EXPECT_EQ(0u, index->functions[0].num_labels);
+  EXPECT_EQ(1u, index->functions[1].id);
+  EXPECT_EQ(24u, index->functions[1].word_offset);
+  EXPECT_EQ(13u, index->functions[1].num_words);
+  EXPECT_EQ(0u, index->functions[1].first_label);
+  EXPECT_EQ(2u, index->functions[1].num_labels);
+
+  ASSERT_EQ(2u, index->num_labels);
+  EXPECT_EQ(5u, index->labels[0].id);
+  EXPECT_EQ(29u, index->labels[0].word_offset);
+  EXPECT_EQ(6u, index->labels[1].id);
+  EXPECT_EQ(33u, index->labels[1].word_offset);
+  spvBinaryIndexDestroy(index);
+}
+
+TEST_F(BinaryParseTest, NoIndexForBadParse) {
+  auto words = CompileSuccessfully("%1 = OpTypeVoid");
+  words.push_back(0xffffffff);  // Certainly invalid instruction header.
+  spv_binary_index index = nullptr;
+  EXPECT_EQ(SPV_ERROR_INVALID_BINARY,
+            spvBinaryParseWithIndex(ScopedContext().context, nullptr,
+                                    words.data(), words.size(), nullptr,
+                                    nullptr, &index, &diagnostic_));
+  EXPECT_EQ(nullptr, index);
+  EXPECT_EQ(SPV_ERROR_INVALID_POINTER,
+            spvBinaryParseWithIndex(ScopedContext().context, nullptr,
+                                    words.data(), words.size(), nullptr,
+                                    nullptr, nullptr, &diagnostic_));
+}
+
+TEST_F(BinaryParseTest, ProbeSummarizesLeadingSections) {
+  auto words = CompileSuccessfully(R"(
+    OpCapability Shader
+    OpCapability Float64
+    OpExtension "SPV_KHR_storage_buffer_storage_class"
+    %glsl = OpExtInstImport "GLSL.std.450"
+    OpMemoryModel Logical GLSL450
+    OpEntryPoint Fragment %frag "frag"
+    OpEntryPoint GLCompute %comp "comp"
+    OpExecutionMode %frag OriginUpperLeft
+  )");
+  // Nothing after the entry points is parsed.
+  words.push_back(0xffffffff);
+  spv_module_summary summary = nullptr;
+  ASSERT_EQ(SPV_SUCCESS,
+            spvBinaryProbe(ScopedContext().context, words.data(), words.size(),
+                           &summary, &diagnostic_));
+  ASSERT_NE(nullptr, summary);
+  EXPECT_EQ(0x10000u, summary->version);
+  EXPECT_EQ(SPV_GENERATOR_WORD(SPV_GENERATOR_KHRONOS_ASSEMBLER, 0),
+            summary->generator);
+  EXPECT_EQ(4u, summary->id_bound);
+  ASSERT_EQ(2u, summary->num_capabilities);
+  EXPECT_EQ(uint32_t(SpvCapabilityShader), summary->capabilities[0]);
+  EXPECT_EQ(uint32_t(SpvCapabilityFloat64), summary->capabilities[1]);
+  ASSERT_EQ(1u, summary->num_extensions);
+  EXPECT_STREQ("SPV_KHR_storage_buffer_storage_class", summary->extensions[0]);
+  EXPECT_TRUE(summary->has_memory_model);
+  EXPECT_EQ(uint32_t(SpvAddressingModelLogical), summary->addressing_model);
+  EXPECT_EQ(uint32_t(SpvMemoryModelGLSL450), summary->memory_model);
+  ASSERT_EQ(2u, summary->num_entry_points);
+  EXPECT_EQ(uint32_t(SpvExecutionModelFragment),
+            summary->entry_points[0].execution_model);
+  EXPECT_EQ(2u, summary->entry_points[0].id);
+  EXPECT_STREQ("frag", summary->entry_points[0].name);
+  EXPECT_EQ(uint32_t(SpvExecutionModelGLCompute),
+            summary->entry_points[1].execution_model);
+  EXPECT_EQ(3u, summary->entry_points[1].id);
+  EXPECT_STREQ("comp", summary->entry_points[1].name);
+  spvModuleSummaryDestroy(summary);
+}
+
+TEST_F(BinaryParseTest, ProbeStopsAtFirstOtherInstruction) {
+  for (bool endian_swap : kSwapEndians) {
+    auto words = CompileSuccessfully(R"(
+      OpCapability Shader
+      OpMemoryModel Logical GLSL450
+      %void = OpTypeVoid
+    )");
+    words.push_back(0xffffffff);  // Certainly invalid instruction header.
+    if (endian_swap) {
+      for (auto& word : words) {
+        word = spvFixWord(word, I32_ENDIAN_HOST == I32_ENDIAN_BIG
+                                    ? SPV_ENDIANNESS_LITTLE
+                                    : SPV_ENDIANNESS_BIG);
+      }
+    }
+    spv_module_summary summary = nullptr;
+    ASSERT_EQ(SPV_SUCCESS,
+              spvBinaryProbe(ScopedContext().context, words.data(),
+                             words.size(), &summary, &diagnostic_));
+    ASSERT_EQ(1u, summary->num_capabilities);
+    EXPECT_EQ(uint32_t(SpvCapabilityShader), summary->capabilities[0]);
+    EXPECT_TRUE(summary->has_memory_model);
+    EXPECT_EQ(0u, summary->num_extensions);
+    EXPECT_EQ(0u, summary->num_entry_points);
+    spvModuleSummaryDestroy(summary);
+  }
+}
+
+TEST_F(BinaryParseTest, ProbeDiagnosesBadLeadingSections) {
+  auto words = CompileSuccessfully("OpCapability Shader");
+  words.push_back(spvOpcodeMake(3, SpvOpMemoryModel));
+  words.push_back(SpvAddressingModelLogical);
+  spv_module_summary summary = nullptr;
+  EXPECT_EQ(SPV_ERROR_INVALID_BINARY,
+            spvBinaryProbe(ScopedContext().context, words.data(),
+                           words.size(), &summary, &diagnostic_));
+  EXPECT_EQ(nullptr, summary);
+  ASSERT_NE(nullptr, diagnostic_);
+  EXPECT_THAT(diagnostic_->error, HasSubstr("OpMemoryModel"));
+}
+
+TEST_F(BinaryParseTest, StreamingParserAcceptsSecondModuleAfterFinish) {
+  const auto words = CompileSuccessfully("%1 = OpTypeVoid");
+  EXPECT_HEADER(2).Times(2).WillRepeatedly(Return(SPV_SUCCESS));
+  EXPECT_CALL(client_, Instruction(MakeParsedVoidTypeInstruction(1)))
+      .Times(2)
+      .WillRepeatedly(Return(SPV_SUCCESS));
+  ScopedContext context;
+  spv_binary_parser parser = spvBinaryParserCreate(
+      context.context, &client_, invoke_header, invoke_instruction);
+  EXPECT_EQ(SPV_SUCCESS, FeedInPieces(parser, words, 5, &diagnostic_));
+  EXPECT_EQ(SPV_SUCCESS, FeedInPieces(parser, words, 5, &diagnostic_));
+  EXPECT_EQ(nullptr, diagnostic_);
+  spvBinaryParserDestroy(parser);
+}
+
+TEST_F(BinaryParseTest, StreamingParserDiagnosesTruncatedInstruction) {
+  auto words = CompileSuccessfully("%1 = OpTypeInt 32 1");
+  words.pop_back();
+  EXPECT_HEADER(2).WillOnce(Return(SPV_SUCCESS));
+  EXPECT_CALL(client_, Instruction(_)).Times(0);
+  ScopedContext context;
+  spv_binary_parser parser = spvBinaryParserCreate(
+      context.context, &client_, invoke_header, invoke_instruction);
+  EXPECT_EQ(SPV_ERROR_INVALID_BINARY,
+            FeedInPieces(parser, words, 1, &diagnostic_));
+  ASSERT_NE(nullptr, diagnostic_);
+  EXPECT_EQ(
+      "End of input reached while decoding OpTypeInt starting at word 5: "
+      "missing literal number operand at word offset 3.",
+      std::string(diagnostic_->error));
+  spvBinaryParserDestroy(parser);
+}
+
+TEST_F(BinaryParseTest, StreamingParserRepeatsFailureUntilFinish) {
+  auto words = CompileSuccessfully("%1 = OpTypeVoid");
+  words.push_back(spvOpcodeMake(0, SpvOpNop));
+  ScopedContext context;
+  spv_binary_parser parser =
+      spvBinaryParserCreate(context.context, nullptr, nullptr, nullptr);
+  EXPECT_EQ(SPV_ERROR_INVALID_BINARY,
+            spvBinaryParserFeed(parser, words.data(),
+                                words.size() * sizeof(uint32_t), &diagnostic_));
+  ASSERT_NE(nullptr, diagnostic_);
+  const std::string error = diagnostic_->error;
+  spvDiagnosticDestroy(diagnostic_);
+  diagnostic_ = nullptr;
+
+  // Later calls for the same module return the same failure and diagnostic.
+  EXPECT_EQ(SPV_ERROR_INVALID_BINARY,
+            spvBinaryParserFeed(parser, words.data(), 4, &diagnostic_));
+  ASSERT_NE(nullptr, diagnostic_);
+  EXPECT_EQ(error, diagnostic_->error);
+  spvDiagnosticDestroy(diagnostic_);
+  diagnostic_ = nullptr;
+  EXPECT_EQ(SPV_ERROR_INVALID_BINARY,
+            spvBinaryParserFinish(parser, &diagnostic_));
+  ASSERT_NE(nullptr, diagnostic_);
+  EXPECT_EQ(error, diagnostic_->error);
+  spvDiagnosticDestroy(diagnostic_);
+  diagnostic_ = nullptr;
+
+  // The next module starts afresh.
+  words.pop_back();
+  EXPECT_EQ(SPV_SUCCESS, FeedInPieces(parser, words, 4, &diagnostic_));
+  EXPECT_EQ(nullptr, diagnostic_);
+  spvBinaryParserDestroy(parser);
+}
+
+TEST_F(BinaryParseTest, StreamingParserDiagnosesTrailingBytes) {
+  const auto words = CompileSuccessfully("%1 = OpTypeVoid");
+  EXPECT_HEADER(2).WillOnce(Return(SPV_SUCCESS));
+  EXPECT_CALL(client_, Instruction(MakeParsedVoidTypeInstruction(1)))
+      .WillOnce(Return(SPV_SUCCESS));
+  ScopedContext context;
+  spv_binary_parser parser = spvBinaryParserCreate(
+      context.context, &client_, invoke_header, invoke_instruction);
+  const unsigned char extra[] = {0, 0};
+  EXPECT_EQ(SPV_SUCCESS,
+            spvBinaryParserFeed(parser, words.data(),
+                                words.size() * sizeof(uint32_t), &diagnostic_));
+  EXPECT_EQ(SPV_SUCCESS,
+            spvBinaryParserFeed(parser, extra, sizeof(extra), &diagnostic_));
+  EXPECT_EQ(SPV_ERROR_INVALID_BINARY,
+            spvBinaryParserFinish(parser, &diagnostic_));
+  ASSERT_NE(nullptr, diagnostic_);
+  EXPECT_EQ(
+      "Module size is not a multiple of 4 bytes: 2 trailing bytes after "
+      "word 7",
+      std::string(diagnostic_->error));
+  spvBinaryParserDestroy(parser);
+}
+
+TEST_F(BinaryParseTest, StreamingParserNullArguments) {
+  EXPECT_EQ(nullptr, spvBinaryParserCreate(nullptr, nullptr, nullptr,
+                                           nullptr));
+  EXPECT_EQ(SPV_ERROR_INVALID_POINTER,
+            spvBinaryParserFeed(nullptr, nullptr, 0, nullptr));
+  EXPECT_EQ(SPV_ERROR_INVALID_POINTER, spvBinaryParserFinish(nullptr, nullptr));
+  ScopedContext context;
+  spv_binary_parser parser =
+      spvBinaryParserCreate(context.context, nullptr, nullptr, nullptr);
+  EXPECT_EQ(SPV_ERROR_INVALID_POINTER,
+            spvBinaryParserFeed(parser, nullptr, 4, nullptr));
+  EXPECT_EQ(SPV_SUCCESS, spvBinaryParserFeed(parser, nullptr, 0, nullptr));
+  spvBinaryParserDestroy(parser);
+}
+
 TEST_F(BinaryParseTest, InstructionWithStringOperand) {
   const std::string str =
       "the future is already here, it's just not evenly distributed";
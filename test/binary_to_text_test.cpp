@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <iostream>
 #include <sstream>
 #include <string>
 #include <tuple>
@@ -475,6 +476,35 @@ OpMemoryModel Logical GLSL450
               expected);
 }
 
+TEST_F(FriendlyNameDisassemblyTest, IdsBeyondTheBound) {
+  // Ids at or beyond the bound in the header are not valid, but are still
+  // printed with their names.
+  const std::string input = R"(OpCapability Shader
+OpMemoryModel Logical GLSL450
+%1 = OpTypeInt 32 0
+%2 = OpConstant %1 42
+%3 = OpConstant %1 42
+OpDecorate %3 RelaxedPrecision
+)";
+  const std::string expected = R"(OpCapability Shader
+OpMemoryModel Logical GLSL450
+%uint = OpTypeInt 32 0
+%uint_42 = OpConstant %uint 42
+%uint_42_0 = OpConstant %uint 42
+OpDecorate %uint_42_0 RelaxedPrecision
+)";
+  SpirvVector words = CompileSuccessfully(input);
+  words[SPV_INDEX_BOUND] = 2;
+  spv_text decoded_text = nullptr;
+  ASSERT_EQ(SPV_SUCCESS,
+            spvBinaryToText(ScopedContext().context, words.data(), words.size(),
+                            SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES |
+                                SPV_BINARY_TO_TEXT_OPTION_NO_HEADER,
+                            &decoded_text, &diagnostic));
+  EXPECT_EQ(expected, std::string(decoded_text->str, decoded_text->length));
+  spvTextDestroy(decoded_text);
+}
+
 TEST_F(TextToBinaryTest, ShowByteOffsetsWhenRequested) {
   const std::string input = R"(
 OpCapability Shader
@@ -493,6 +523,88 @@ OpMemoryModel Logical GLSL450 ; 0x0000001c
               expected);
 }
 
+TEST_F(TextToBinaryTest, ParallelMatchesSerialDisassembly) {
+  // Large enough to be split into several chunks.  The OpLine instructions
+  // in the function bodies start the debug information comment section.
+  std::string input = R"(OpCapability Shader
+OpMemoryModel Logical GLSL450
+%file = OpString "a.comp"
+%void = OpTypeVoid
+%fnty = OpTypeFunction %void
+%uint = OpTypeInt 32 0
+%float = OpTypeFloat 32
+%c1 = OpConstant %uint 1
+%half = OpConstant %float 0.5
+)";
+  for (int i = 0; i < 2000; ++i) {
+    const std::string n = std::to_string(i);
+    input += "%f" + n + " = OpFunction %void None %fnty\n%entry" + n +
+             " = OpLabel\nOpLine %file " + n + " 1\n%x" + n +
+             " = OpIAdd %uint %c1 %c1\n%y" + n +
+             " = OpFMul %float %half %half\nOpSelectionMerge %merge" + n +
+             " None\nOpSwitch %x" + n + " %merge" + n + " 1 %merge" + n +
+             "\n%merge" + n + " = OpLabel\nOpReturn\nOpFunctionEnd\n";
+  }
+  const SpirvVector words = CompileSuccessfully(input);
+  const uint32_t option_sets[] = {
+      SPV_BINARY_TO_TEXT_OPTION_NONE,
+      SPV_BINARY_TO_TEXT_OPTION_INDENT |
+          SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES |
+          SPV_BINARY_TO_TEXT_OPTION_COMMENT,
+      SPV_BINARY_TO_TEXT_OPTION_SHOW_BYTE_OFFSET |
+          SPV_BINARY_TO_TEXT_OPTION_COLOR};
+  for (uint32_t options : option_sets) {
+    spv_text serial = nullptr;
+    spv_text parallel = nullptr;
+    ASSERT_EQ(SPV_SUCCESS,
+              spvBinaryToText(ScopedContext().context, words.data(),
+                              words.size(), options, &serial, &diagnostic));
+    ASSERT_EQ(SPV_SUCCESS,
+              spvBinaryToText(ScopedContext().context, words.data(),
+                              words.size(),
+                              options | SPV_BINARY_TO_TEXT_OPTION_PARALLEL,
+                              &parallel, &diagnostic));
+    // Not EXPECT_EQ, whose message would diff the whole text.
+    EXPECT_TRUE(std::string(serial->str, serial->length) ==
+                std::string(parallel->str, parallel->length))
+        << "options: " << options;
+    spvTextDestroy(serial);
+    spvTextDestroy(parallel);
+  }
+}
+
+TEST_F(TextToBinaryTest, ParallelPrintsLikeSerialDisassemblyBeforeError) {
+  const std::string input = R"(OpCapability Shader
+OpMemoryModel Logical GLSL450
+%void = OpTypeVoid
+%fnty = OpTypeFunction %void
+%f = OpFunction %void None %fnty
+%entry = OpLabel
+OpReturn
+OpFunctionEnd
+%g = OpFunction %void None %fnty
+)";
+  SpirvVector words = CompileSuccessfully(input);
+  // Cut the last OpFunction short, so that parsing fails on it.
+  words.pop_back();
+  std::string printed[2];
+  for (int parallel = 0; parallel < 2; ++parallel) {
+    const uint32_t options =
+        SPV_BINARY_TO_TEXT_OPTION_PRINT |
+        (parallel ? SPV_BINARY_TO_TEXT_OPTION_PARALLEL : 0);
+    testing::internal::CaptureStdout();
+    EXPECT_EQ(SPV_ERROR_INVALID_BINARY,
+              spvBinaryToText(ScopedContext().context, words.data(),
+                              words.size(), options, nullptr, &diagnostic));
+    std::cout.flush();
+    printed[parallel] = testing::internal::GetCapturedStdout();
+    spvDiagnosticDestroy(diagnostic);
+    diagnostic = nullptr;
+  }
+  EXPECT_THAT(printed[0], HasSubstr("OpFunctionEnd\n"));
+  EXPECT_EQ(printed[0], printed[1]);
+}
+
 // Test version string.
 TEST_F(TextToBinaryTest, VersionString) {
   auto words = CompileSuccessfully("");
@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "source/table.h"
 #include "spirv-tools/libspirv.h"
@@ -295,5 +297,132 @@ TEST(CInterface, SpecifyConsumerSpecifyDiagnosticForValidating) {
   spvContextDestroy(context);
 }
 
+TEST(CInterface, ValidateBinariesWritesPerModuleDiagnostics) {
+  const char valid_text[] =
+      "OpCapability Shader\nOpCapability Linkage\n"
+      "OpMemoryModel Logical GLSL450";
+  const char invalid_text[] = "OpNop";
+
+  auto context = spvContextCreate(SPV_ENV_UNIVERSAL_1_1);
+  int invocation = 0;
+  SetContextMessageConsumer(
+      context,
+      [&invocation](spv_message_level_t, const char*, const spv_position_t&,
+                    const char*) { ++invocation; });
+
+  spv_binary valid = nullptr;
+  spv_binary invalid = nullptr;
+  ASSERT_EQ(SPV_SUCCESS, spvTextToBinary(context, valid_text,
+                                         sizeof(valid_text), &valid, nullptr));
+  ASSERT_EQ(SPV_SUCCESS,
+            spvTextToBinary(context, invalid_text, sizeof(invalid_text),
+                            &invalid, nullptr));
+
+  const size_t kNumBinaries = 9;
+  std::vector<spv_const_binary_t> binaries;
+  for (size_t i = 0; i < kNumBinaries; ++i) {
+    spv_binary binary = (i % 3 == 1) ? invalid : valid;
+    binaries.push_back({binary->code, binary->wordCount});
+  }
+  for (size_t num_threads : {0, 1, 4}) {
+    std::vector<spv_result_t> results(kNumBinaries, SPV_UNSUPPORTED);
+    std::vector<spv_diagnostic> diagnostics(kNumBinaries, nullptr);
+    EXPECT_EQ(SPV_ERROR_INVALID_LAYOUT,
+              spvValidateBinaries(context, nullptr, binaries.data(),
+                                  binaries.size(), num_threads, results.data(),
+                                  diagnostics.data()));
+    for (size_t i = 0; i < kNumBinaries; ++i) {
+      if (i % 3 == 1) {
+        EXPECT_EQ(SPV_ERROR_INVALID_LAYOUT, results[i]);
+        ASSERT_NE(nullptr, diagnostics[i]);
+        EXPECT_STREQ(
+            "Nop cannot appear before the memory model instruction\n"
+            "  OpNop\n",
+            diagnostics[i]->error);
+      } else {
+        EXPECT_EQ(SPV_SUCCESS, results[i]);
+        EXPECT_EQ(nullptr, diagnostics[i]);
+      }
+      spvDiagnosticDestroy(diagnostics[i]);
+    }
+  }
+  EXPECT_EQ(0, invocation);  // Consumer should not be invoked at all.
+
+  spvBinaryDestroy(valid);
+  spvBinaryDestroy(invalid);
+  spvContextDestroy(context);
+}
+
+TEST(CInterface, ValidateBinariesSendsLowMemoryReportsToConsumer) {
+  const char input_text[] =
+      "OpCapability Shader\nOpCapability Linkage\n"
+      "OpMemoryModel Logical GLSL450";
+
+  auto context = spvContextCreate(SPV_ENV_UNIVERSAL_1_1);
+  int invocation = 0;
+  SetContextMessageConsumer(
+      context, [&invocation](spv_message_level_t level, const char*,
+                             const spv_position_t&, const char*) {
+        EXPECT_EQ(SPV_MSG_INFO, level);
+        ++invocation;
+      });
+
+  spv_binary binary = nullptr;
+  ASSERT_EQ(SPV_SUCCESS, spvTextToBinary(context, input_text,
+                                         sizeof(input_text), &binary, nullptr));
+
+  const std::vector<spv_const_binary_t> binaries(
+      4, spv_const_binary_t{binary->code, binary->wordCount});
+  std::vector<spv_result_t> results(binaries.size());
+  std::vector<spv_diagnostic> diagnostics(binaries.size(), nullptr);
+  spv_validator_options options = spvValidatorOptionsCreate();
+  spvValidatorOptionsSetLowMemory(options, true);
+  EXPECT_EQ(SPV_SUCCESS,
+            spvValidateBinaries(context, options, binaries.data(),
+                                binaries.size(), 2, results.data(),
+                                diagnostics.data()));
+  // The memory estimates are not issues, so the diagnostics of the valid
+  // modules stay empty.
+  for (spv_diagnostic diagnostic : diagnostics) {
+    EXPECT_EQ(nullptr, diagnostic);
+    spvDiagnosticDestroy(diagnostic);
+  }
+#ifndef SPIRV_TOOLS_SHAREDLIB
+  EXPECT_EQ(4, invocation);
+#endif
+
+  spvValidatorOptionsDestroy(options);
+  spvBinaryDestroy(binary);
+  spvContextDestroy(context);
+}
+
+TEST(CInterface, ValidateBinariesWithoutDiagnosticsUsesConsumer) {
+  const char input_text[] = "OpNop";
+
+  auto context = spvContextCreate(SPV_ENV_UNIVERSAL_1_1);
+  int invocation = 0;
+  SetContextMessageConsumer(
+      context,
+      [&invocation](spv_message_level_t, const char*, const spv_position_t&,
+                    const char*) { ++invocation; });
+
+  spv_binary binary = nullptr;
+  ASSERT_EQ(SPV_SUCCESS, spvTextToBinary(context, input_text,
+                                         sizeof(input_text), &binary, nullptr));
+
+  const std::vector<spv_const_binary_t> binaries(
+      8, spv_const_binary_t{binary->code, binary->wordCount});
+  std::vector<spv_result_t> results(binaries.size());
+  EXPECT_EQ(SPV_ERROR_INVALID_LAYOUT,
+            spvValidateBinaries(context, nullptr, binaries.data(),
+                                binaries.size(), 4, results.data(), nullptr));
+#ifndef SPIRV_TOOLS_SHAREDLIB
+  EXPECT_EQ(8, invocation);
+#endif
+
+  spvBinaryDestroy(binary);
+  spvContextDestroy(context);
+}
+
 }  // namespace
 }  // namespace spvtools
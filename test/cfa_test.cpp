@@ -0,0 +1,141 @@
+// Copyright (c) 2026 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "source/cfa.h"
+
+namespace spvtools {
+namespace {
+
+struct Block {
+  explicit Block(uint32_t block_id) : id_(block_id) {}
+  uint32_t id() const { return id_; }
+
+  uint32_t id_;
+  std::vector<Block*> successors;
+  std::vector<Block*> predecessors;
+};
+
+using Edges = std::vector<std::pair<Block*, Block*>>;
+
+// A graph of blocks, with block 0 as the root.
+class Graph {
+ public:
+  explicit Graph(uint32_t num_blocks) {
+    for (uint32_t i = 0; i < num_blocks; ++i) {
+      blocks_.emplace_back(new Block(i));
+    }
+  }
+
+  Block* block(uint32_t id) { return blocks_[id].get(); }
+
+  void AddEdge(uint32_t from, uint32_t to) {
+    block(from)->successors.push_back(block(to));
+    block(to)->predecessors.push_back(block(from));
+  }
+
+  // Returns the blocks reachable from the root in postorder.
+  std::vector<const Block*> Postorder() {
+    std::vector<const Block*> postorder;
+    CFA<Block>::DepthFirstTraversal(
+        block(0), [](const Block* b) { return &b->successors; },
+        [](const Block*) {},
+        [&postorder](const Block* b) { postorder.push_back(b); },
+        [](const Block*, const Block*) {});
+    return postorder;
+  }
+
+ private:
+  std::vector<std::unique_ptr<Block>> blocks_;
+};
+
+const std::vector<Block*>* Predecessors(const Block* b) {
+  return &b->predecessors;
+}
+
+TEST(CFADominators, IrreducibleLoop) {
+  // 0 branches into both blocks of the loop 1 <-> 2, which both exit to 3.
+  Graph graph(4);
+  graph.AddEdge(0, 1);
+  graph.AddEdge(0, 2);
+  graph.AddEdge(1, 2);
+  graph.AddEdge(2, 1);
+  graph.AddEdge(1, 3);
+  graph.AddEdge(2, 3);
+  const std::vector<const Block*> postorder = graph.Postorder();
+
+  const Edges expected = {{graph.block(3), graph.block(0)},
+                          {graph.block(2), graph.block(0)},
+                          {graph.block(1), graph.block(0)},
+                          {graph.block(0), graph.block(0)}};
+  EXPECT_EQ(expected, CFA<Block>::CalculateDominatorsIteratively(
+                          postorder, Predecessors));
+  EXPECT_EQ(expected,
+            CFA<Block>::CalculateDominatorsSemiNCA(postorder, Predecessors));
+}
+
+TEST(CFADominators, DeeplyNestedLoops) {
+  // Each block i enters block i + 1 and is the continue target of the loop
+  // in block 2 * n - 1 - i, so block i dominates every later block.
+  const uint32_t n = 2 * CFA<Block>::kMinBlocksForSemiNCA;
+  Graph graph(2 * n);
+  for (uint32_t i = 0; i + 1 < 2 * n; ++i) graph.AddEdge(i, i + 1);
+  for (uint32_t i = 0; i < n; ++i) graph.AddEdge(2 * n - 1 - i, i);
+  const std::vector<const Block*> postorder = graph.Postorder();
+
+  const Edges edges =
+      CFA<Block>::CalculateDominators(postorder, Predecessors);
+  ASSERT_EQ(2 * n, edges.size());
+  for (const auto& edge : edges) {
+    const uint32_t id = edge.first->id();
+    EXPECT_EQ(id == 0 ? 0 : id - 1, edge.second->id());
+  }
+  EXPECT_EQ(edges, CFA<Block>::CalculateDominatorsIteratively(postorder,
+                                                              Predecessors));
+}
+
+TEST(CFADominators, AlgorithmsAgreeOnRandomGraphs) {
+  std::mt19937 random(5489u);
+  for (uint32_t num_blocks = 1; num_blocks < 300; num_blocks += 7) {
+    for (uint32_t edges_per_block = 1; edges_per_block <= 3;
+         ++edges_per_block) {
+      // Blocks mostly branch forward, with some edges to anywhere to make
+      // loops, irreducible ones included.
+      Graph graph(num_blocks);
+      for (uint32_t from = 0; from < num_blocks; ++from) {
+        for (uint32_t e = 0; e < edges_per_block; ++e) {
+          uint32_t to = from + 1 + static_cast<uint32_t>(random() % 4);
+          if (random() % 4 == 0) {
+            to = static_cast<uint32_t>(random() % num_blocks);
+          }
+          if (to < num_blocks) graph.AddEdge(from, to);
+        }
+      }
+      const std::vector<const Block*> postorder = graph.Postorder();
+      EXPECT_EQ(
+          CFA<Block>::CalculateDominatorsIteratively(postorder, Predecessors),
+          CFA<Block>::CalculateDominatorsSemiNCA(postorder, Predecessors))
+          << num_blocks << " blocks with up to " << edges_per_block
+          << " edges each";
+    }
+  }
+}
+
+}  // namespace
+}  // namespace spvtools
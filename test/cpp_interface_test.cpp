@@ -25,6 +25,7 @@ namespace spvtools {
 namespace {
 
 using ::testing::ContainerEq;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 
 // Return a string that contains the minimum instructions needed to form
@@ -166,6 +167,39 @@ TEST(CppInterface, ValidateOverloads) {
   { EXPECT_TRUE(t.Validate(binary.data(), binary.size())); }
 }
 
+TEST(CppInterface, IndexFindsFunctions) {
+  SpirvTools t(SPV_ENV_UNIVERSAL_1_1);
+  std::vector<uint32_t> binary;
+  EXPECT_TRUE(t.Assemble(Header() + R"(
+    %void = OpTypeVoid
+    %fnty = OpTypeFunction %void
+    %f = OpFunction %void None %fnty
+    %entry = OpLabel
+    OpReturn
+    OpFunctionEnd
+  )",
+                         &binary));
+
+  BinaryIndex index;
+  EXPECT_TRUE(t.Index(binary, &index));
+  ASSERT_EQ(1u, index.functions.size());
+  ASSERT_EQ(1u, index.labels.size());
+  const auto& function = index.functions[0];
+  EXPECT_EQ(SpvOpFunction, binary[function.word_offset] & SpvOpCodeMask);
+  EXPECT_EQ(SpvOpFunctionEnd,
+            binary[function.word_offset + function.num_words - 1] &
+                SpvOpCodeMask);
+  EXPECT_EQ(SpvOpLabel, binary[index.labels[0].word_offset] & SpvOpCodeMask);
+  const auto& definitions =
+      index.sections[SPV_BINARY_SECTION_FUNCTION_DEFINITIONS];
+  EXPECT_EQ(function.word_offset, definitions.word_offset);
+  EXPECT_EQ(binary.size(), definitions.word_offset + definitions.num_words);
+
+  binary.push_back(0xffffffff);  // Certainly invalid instruction header.
+  EXPECT_FALSE(t.Index(binary.data(), binary.size(), &index));
+  EXPECT_EQ(1u, index.functions.size());
+}
+
 TEST(CppInterface, ValidateEmptyModule) {
   SpirvTools t(SPV_ENV_UNIVERSAL_1_1);
   int invocation_count = 0;
@@ -222,6 +256,56 @@ TEST(CppInterface, ValidateWithOptionsFail) {
           "Number of OpTypeStruct members (10) has exceeded the limit (9)"));
 }
 
+TEST(CppInterface, ValidateWithLowMemoryReportsMemoryEstimate) {
+  SpirvTools t(SPV_ENV_UNIVERSAL_1_1);
+  std::vector<uint32_t> binary;
+  EXPECT_TRUE(t.Assemble(MakeModuleHavingStruct(10), &binary));
+  ValidatorOptions opts;
+  opts.SetLowMemory(true);
+  std::vector<spv_message_level_t> levels;
+  std::stringstream os;
+  t.SetMessageConsumer([&levels, &os](spv_message_level_t level, const char*,
+                                      const spv_position_t&,
+                                      const char* message) {
+    levels.push_back(level);
+    os << message;
+  });
+
+  EXPECT_TRUE(t.Validate(binary.data(), binary.size(), opts));
+  EXPECT_THAT(levels, ElementsAre(SPV_MSG_INFO));
+  EXPECT_THAT(os.str(), HasSubstr("Partial estimate of the memory of the "
+                                  "validation state: "));
+}
+
+TEST(CppInterface, ValidateManyBinaries) {
+  SpirvTools t(SPV_ENV_UNIVERSAL_1_1);
+  std::vector<uint32_t> valid;
+  std::vector<uint32_t> invalid;
+  EXPECT_TRUE(t.Assemble(MakeModuleHavingStruct(10), &valid));
+  EXPECT_TRUE(t.Assemble(MakeModuleHavingStruct(20), &invalid));
+  ValidatorOptions opts;
+  opts.SetUniversalLimit(spv_validator_limit_max_struct_members, 15);
+  std::vector<std::string> consumed;
+  t.SetMessageConsumer(
+      [&consumed](spv_message_level_t, const char*, const spv_position_t&,
+                  const char* message) { consumed.push_back(message); });
+
+  const std::vector<std::vector<uint32_t>> binaries = {valid, invalid, valid,
+                                                       invalid};
+  std::vector<std::string> messages;
+  EXPECT_FALSE(t.Validate(binaries, opts, 3, &messages));
+  ASSERT_EQ(4u, messages.size());
+  EXPECT_EQ("", messages[0]);
+  EXPECT_THAT(messages[1], HasSubstr("Number of OpTypeStruct members (20) "
+                                     "has exceeded the limit (15)"));
+  EXPECT_EQ("", messages[2]);
+  EXPECT_EQ(messages[1], messages[3]);
+  EXPECT_THAT(consumed, ContainerEq(std::vector<std::string>{messages[1],
+                                                             messages[3]}));
+
+  EXPECT_TRUE(t.Validate({valid, valid}, opts, 0));
+}
+
 // Checks that after running the given optimizer |opt| on the given |original|
 // source code, we can get the given |optimized| source code.
 void CheckOptimization(const std::string& original,
@@ -40,6 +40,40 @@ TEST(FixWord, Reorder) {
   ASSERT_EQ(result, spvFixWord(word, endian));
 }
 
+TEST(FixWords, Default) {
+  spv_endianness_t endian =
+      (I32_ENDIAN_HOST == I32_ENDIAN_LITTLE ? SPV_ENDIANNESS_LITTLE
+                                            : SPV_ENDIANNESS_BIG);
+  const uint32_t words[] = {0x53780921, 0xdeadbeef, 0x00000001};
+  uint32_t result[3] = {};
+  spvFixWords(words, 3, endian, result);
+  ASSERT_EQ(words[0], result[0]);
+  ASSERT_EQ(words[1], result[1]);
+  ASSERT_EQ(words[2], result[2]);
+}
+
+TEST(FixWords, Reorder) {
+  spv_endianness_t endian =
+      (I32_ENDIAN_HOST == I32_ENDIAN_LITTLE ? SPV_ENDIANNESS_BIG
+                                            : SPV_ENDIANNESS_LITTLE);
+  const uint32_t words[] = {0x53780921, 0xdeadbeef, 0x00000001};
+  uint32_t result[3] = {};
+  spvFixWords(words, 3, endian, result);
+  ASSERT_EQ(0x21097853u, result[0]);
+  ASSERT_EQ(0xefbeaddeu, result[1]);
+  ASSERT_EQ(0x01000000u, result[2]);
+}
+
+TEST(FixWords, ReorderInPlace) {
+  spv_endianness_t endian =
+      (I32_ENDIAN_HOST == I32_ENDIAN_LITTLE ? SPV_ENDIANNESS_BIG
+                                            : SPV_ENDIANNESS_LITTLE);
+  uint32_t words[] = {0x53780921, 0xdeadbeef};
+  spvFixWords(words, 2, endian, words);
+  ASSERT_EQ(0x21097853u, words[0]);
+  ASSERT_EQ(0xefbeaddeu, words[1]);
+}
+
 TEST(FixDoubleWord, Default) {
   spv_endianness_t endian =
       (I32_ENDIAN_HOST == I32_ENDIAN_LITTLE ? SPV_ENDIANNESS_LITTLE
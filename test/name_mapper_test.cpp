@@ -344,5 +344,23 @@ INSTANTIATE_TEST_SUITE_P(
         {"%1 = OpTypeBool\n%2 = OpConstantFalse %1", 2, "false"},
     }));
 
+INSTANTIATE_TEST_SUITE_P(
+    NumberedIds, FriendlyNameTest,
+    ::testing::ValuesIn(std::vector<NameIdCase>{
+        {"OpName %1 \"foo\" %1 = OpTypeVoid %2 = OpTypeFunction %1", 2, "2"},
+        {"OpName %2 \"3\" %1 = OpTypeVoid %2 = OpTypeFunction %1", 2, "3"},
+        // A debug name can't take the number of an id defined before it.
+        {"%1 = OpExtInstImport \"GLSL.std.450\" OpName %2 \"1\" "
+         "%2 = OpTypeVoid",
+         2, "1_0"},
+        // Nor can an id's number be taken by a debug name.
+        {"OpName %2 \"1\" %1 = OpTypeVoid %2 = OpTypeFunction %1 "
+         "%3 = OpTypeFunction %1 %1",
+         3, "3"},
+        {"OpName %2 \"3\" %1 = OpTypeVoid %2 = OpTypeFunction %1 "
+         "%3 = OpTypeFunction %1 %1",
+         3, "3_0"},
+    }));
+
 }  // namespace
 }  // namespace spvtools
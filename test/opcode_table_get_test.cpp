@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstring>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "test/unit_spirv.h"
 
@@ -28,6 +31,26 @@ TEST_P(GetTargetOpcodeTableGetTest, IntegrityCheck) {
   ASSERT_NE(nullptr, table->entries);
 }
 
+TEST_P(GetTargetOpcodeTableGetTest, NameIndexIsOrderedByName) {
+  spv_opcode_table table;
+  ASSERT_EQ(SPV_SUCCESS, spvOpcodeTableGet(&table, GetParam()));
+  ASSERT_NE(nullptr, table->name_index);
+  std::vector<bool> seen(table->count, false);
+  for (uint32_t i = 0; i < table->count; ++i) {
+    const uint16_t index = table->name_index[i];
+    ASSERT_LT(index, table->count);
+    EXPECT_FALSE(seen[index]) << "index " << index << " listed twice";
+    seen[index] = true;
+    if (i > 0) {
+      const uint16_t prev = table->name_index[i - 1];
+      const int order =
+          strcmp(table->entries[prev].name, table->entries[index].name);
+      EXPECT_TRUE(order < 0 || (order == 0 && prev < index))
+          << table->entries[prev].name << " " << table->entries[index].name;
+    }
+  }
+}
+
 TEST_P(GetTargetOpcodeTableGetTest, InvalidPointerTable) {
   ASSERT_EQ(SPV_ERROR_INVALID_POINTER, spvOpcodeTableGet(nullptr, GetParam()));
 }
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstring>
 #include <vector>
 
 #include "test/unit_spirv.h"
@@ -29,6 +30,29 @@ TEST_P(GetTargetTest, Default) {
   ASSERT_NE(nullptr, table->types);
 }
 
+TEST_P(GetTargetTest, NameIndexIsOrderedByName) {
+  spv_operand_table table;
+  ASSERT_EQ(SPV_SUCCESS, spvOperandTableGet(&table, GetParam()));
+  for (uint32_t typeIndex = 0; typeIndex < table->count; ++typeIndex) {
+    const auto& group = table->types[typeIndex];
+    ASSERT_NE(nullptr, group.name_index);
+    std::vector<bool> seen(group.count, false);
+    for (uint32_t i = 0; i < group.count; ++i) {
+      const uint16_t index = group.name_index[i];
+      ASSERT_LT(index, group.count);
+      EXPECT_FALSE(seen[index]) << "index " << index << " listed twice";
+      seen[index] = true;
+      if (i > 0) {
+        const uint16_t prev = group.name_index[i - 1];
+        const int order =
+            strcmp(group.entries[prev].name, group.entries[index].name);
+        EXPECT_TRUE(order < 0 || (order == 0 && prev < index))
+            << group.entries[prev].name << " " << group.entries[index].name;
+      }
+    }
+  }
+}
+
 TEST_P(GetTargetTest, InvalidPointerTable) {
   ASSERT_EQ(SPV_ERROR_INVALID_POINTER, spvOperandTableGet(nullptr, GetParam()));
 }
@@ -19,6 +19,7 @@
 #include <vector>
 
 #include "gmock/gmock.h"
+#include "source/opt/build_module.h"
 #include "source/util/make_unique.h"
 #include "test/opt/module_utils.h"
 #include "test/opt/pass_fixture.h"
@@ -186,6 +187,93 @@ TEST(PassManager, RecomputeIdBoundAutomatically) {
   EXPECT_THAT(GetIdBound(*context.module()), Eq(201u));
 }
 
+// A pass that appends an OpTypeInt, which keeps the module valid.
+class AppendTypeIntPass : public Pass {
+ public:
+  const char* name() const override { return "AppendTypeIntPass"; }
+  Status Process() override {
+    auto inst = MakeUnique<Instruction>(
+        context(), SpvOpTypeInt, 0, context()->TakeNextId(),
+        std::vector<Operand>{{SPV_OPERAND_TYPE_LITERAL_INTEGER, {32}},
+                             {SPV_OPERAND_TYPE_LITERAL_INTEGER, {0}}});
+    context()->AddType(std::move(inst));
+    return Status::SuccessWithChange;
+  }
+};
+
+// A pass that makes the module invalid by appending a second OpTypeVoid, but
+// reports that it made no change.
+class UnreportedDuplicateTypePass : public Pass {
+ public:
+  const char* name() const override { return "UnreportedDuplicateTypePass"; }
+  Status Process() override {
+    auto inst = MakeUnique<Instruction>(context(), SpvOpTypeVoid, 0,
+                                        context()->TakeNextId(),
+                                        std::vector<Operand>{});
+    context()->AddType(std::move(inst));
+    return Status::SuccessWithoutChange;
+  }
+};
+
+const char kValidModule[] = R"(OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+%void = OpTypeVoid
+)";
+
+TEST(PassManager, ValidateAfterAllCatchesUnreportedChange) {
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, kValidModule);
+  ASSERT_NE(nullptr, context);
+  std::vector<std::string> errors;
+  PassManager manager;
+  manager.SetMessageConsumer(
+      [&errors](spv_message_level_t level, const char*, const spv_position_t&,
+                const char* message) {
+        if (level == SPV_MSG_INTERNAL_ERROR) errors.push_back(message);
+      });
+  ValidatorOptions options;
+  manager.SetValidateAfterAll(true);
+  manager.SetValidatorOptions(options);
+  manager.AddPass<AppendTypeIntPass>();
+  manager.AddPass(MakeUnique<UnreportedDuplicateTypePass>());
+  EXPECT_EQ(Pass::Status::Failure, manager.Run(context.get()));
+  EXPECT_THAT(errors, ::testing::ElementsAre(
+                          "Validation failed after pass "
+                          "UnreportedDuplicateTypePass"));
+}
+
+TEST(PassManager, ValidateAfterAllSkipsIdenticalModules) {
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, kValidModule);
+  ASSERT_NE(nullptr, context);
+  // In low-memory mode, each successful validation sends an info message.
+  int validations = 0;
+  PassManager manager;
+  manager.SetMessageConsumer(
+      [&validations](spv_message_level_t level, const char*,
+                     const spv_position_t&, const char*) {
+        if (level == SPV_MSG_INFO) ++validations;
+      });
+  ValidatorOptions options;
+  options.SetLowMemory(true);
+  manager.SetValidateAfterAll(true);
+  manager.SetValidatorOptions(options);
+  manager.AddPass<NullPass>();
+  manager.AddPass<NullPass>();
+  manager.AddPass<NullPass>();
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, manager.Run(context.get()));
+  EXPECT_EQ(1, validations);
+
+  // Each run starts without a validated module.
+  validations = 0;
+  manager.AddPass<NullPass>();
+  manager.AddPass<AppendTypeIntPass>();
+  manager.AddPass<NullPass>();
+  EXPECT_EQ(Pass::Status::SuccessWithChange, manager.Run(context.get()));
+  EXPECT_EQ(2, validations);
+}
+
 }  // anonymous namespace
 }  // namespace opt
 }  // namespace spvtools
@@ -14,11 +14,13 @@
 
 #include <algorithm>
 #include <cstring>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
+#include "source/assembly_grammar.h"
 #include "source/spirv_constant.h"
 #include "source/util/bitutils.h"
 #include "source/util/hex_float.h"
@@ -247,6 +249,139 @@ INSTANTIATE_TEST_SUITE_P(
         {"0x1.804p4", 0x00004e01},
     }));
 
+// Returns the text of a module with the given number of functions.  Each
+// function switches on a value it defines, and calls the next function, so
+// that some of its IDs are used before they are defined.
+std::string ModuleWithFunctions(int num_functions) {
+  std::string text = R"(OpCapability Shader
+OpMemoryModel Logical GLSL450
+%void = OpTypeVoid
+%fnty = OpTypeFunction %void
+%uint = OpTypeInt 32 0
+%c1 = OpConstant %uint 1
+%10 = OpConstant %uint 2
+)";
+  for (int i = 0; i < num_functions; ++i) {
+    const std::string n = std::to_string(i);
+    text += "%f" + n + " = OpFunction %void None %fnty\n%entry" + n +
+            " = OpLabel\n%x" + n + " = OpIAdd %uint %c1 %10\n" +
+            "OpSelectionMerge %merge" + n + " None\nOpSwitch %x" + n +
+            " %merge" + n + " 1 %case" + n + " 4294967295 %merge" + n +
+            "\n%case" + n + " = OpLabel\nOpBranch %merge" + n + "\n%merge" +
+            n + " = OpLabel\n";
+    if (i + 1 < num_functions) {
+      text += "%call" + n + " = OpFunctionCall %void %f" +
+              std::to_string(i + 1) + "\n";
+    }
+    text += "OpReturn\nOpFunctionEnd\n";
+  }
+  return text;
+}
+
+TEST(ParallelTextToBinary, MatchesSerialAssembly) {
+  ScopedContext context;
+  // Large enough to be split into several chunks.
+  const std::string text = ModuleWithFunctions(2000);
+  for (uint32_t options : {SPV_TEXT_TO_BINARY_OPTION_NONE,
+                           SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS}) {
+    spv_binary serial = nullptr;
+    spv_binary parallel = nullptr;
+    ASSERT_EQ(SPV_SUCCESS,
+              spvTextToBinaryWithOptions(context.context, text.data(),
+                                         text.size(), options, &serial,
+                                         nullptr));
+    ASSERT_EQ(SPV_SUCCESS,
+              spvTextToBinaryWithOptions(
+                  context.context, text.data(), text.size(),
+                  options | SPV_TEXT_TO_BINARY_OPTION_PARALLEL, &parallel,
+                  nullptr));
+    EXPECT_THAT(std::vector<uint32_t>(parallel->code,
+                                      parallel->code + parallel->wordCount),
+                Eq(std::vector<uint32_t>(serial->code,
+                                         serial->code + serial->wordCount)));
+    spvBinaryDestroy(serial);
+    spvBinaryDestroy(parallel);
+  }
+}
+
+TEST(ParallelTextToBinary, EncodesFunctionBodiesWithoutFallingBack) {
+  ScopedContext context;
+  const std::string text = ModuleWithFunctions(2000);
+  spv_binary serial = nullptr;
+  ASSERT_EQ(SPV_SUCCESS, spvTextToBinary(context.context, text.data(),
+                                         text.size(), &serial, nullptr));
+
+  // The assembler falls back to serial assembly when the parallel encoder
+  // fails, so check that the encoder itself succeeds.
+  const spvtools::AssemblyGrammar grammar(context.context);
+  spv_text_t input = {text.data(), text.size()};
+  std::vector<uint32_t> words(SPV_INDEX_INSTRUCTION);
+  uint32_t bound = 0;
+  ASSERT_EQ(SPV_SUCCESS,
+            spvtools::EncodeInstructionsInParallel(
+                grammar, &input, std::set<uint32_t>(), &words, &bound));
+  EXPECT_EQ(serial->code[SPV_INDEX_BOUND], bound);
+  EXPECT_THAT(std::vector<uint32_t>(words.begin() + SPV_INDEX_INSTRUCTION,
+                                    words.end()),
+              Eq(std::vector<uint32_t>(serial->code + SPV_INDEX_INSTRUCTION,
+                                       serial->code + serial->wordCount)));
+  spvBinaryDestroy(serial);
+}
+
+// Assembles |text| with and without the parallel option, and checks that both
+// return |result| and emit the same diagnostic.  Returns the diagnostic's
+// message.
+std::string ExpectSameDiagnosticInParallel(const std::string& text,
+                                           spv_result_t result) {
+  ScopedContext context;
+  spv_binary binary = nullptr;
+  spv_diagnostic serial = nullptr;
+  spv_diagnostic parallel = nullptr;
+  EXPECT_EQ(result, spvTextToBinaryWithOptions(
+                        context.context, text.data(), text.size(),
+                        SPV_TEXT_TO_BINARY_OPTION_NONE, &binary, &serial));
+  spvBinaryDestroy(binary);
+  binary = nullptr;
+  EXPECT_EQ(result, spvTextToBinaryWithOptions(
+                        context.context, text.data(), text.size(),
+                        SPV_TEXT_TO_BINARY_OPTION_PARALLEL, &binary,
+                        &parallel));
+  spvBinaryDestroy(binary);
+  std::string message;
+  EXPECT_THAT(serial, NotNull());
+  EXPECT_THAT(parallel, NotNull());
+  if (serial && parallel) {
+    EXPECT_STREQ(serial->error, parallel->error);
+    EXPECT_EQ(serial->position.index, parallel->position.index);
+    message = serial->error;
+  }
+  spvDiagnosticDestroy(serial);
+  spvDiagnosticDestroy(parallel);
+  return message;
+}
+
+// The modules below are large enough to be split into several chunks, even
+// with a single hardware thread.
+
+TEST(ParallelTextToBinary, ReportsErrorsLikeSerialAssembly) {
+  ExpectSameDiagnosticInParallel(
+      ModuleWithFunctions(1000) +
+          "%g = OpFunction %void None %fnty\n%y = OpIAdd %uint %c1\n",
+      SPV_ERROR_INVALID_TEXT);
+}
+
+TEST(ParallelTextToBinary, ReportsValueDefinedInTwoChunksLikeSerialAssembly) {
+  // %x0 is defined in the first function and again in the last, which are
+  // encoded in different chunks.  The redefinition is diagnosed, though the
+  // module is still assembled.
+  EXPECT_EQ("Value is being defined a second time",
+            ExpectSameDiagnosticInParallel(
+                ModuleWithFunctions(2000) +
+                    "%g = OpFunction %void None %fnty\n%gentry = OpLabel\n"
+                    "%x0 = OpIAdd %uint %c1 %10\nOpReturn\nOpFunctionEnd\n",
+                SPV_SUCCESS));
+}
+
 TEST(CreateContext, InvalidEnvironment) {
   spv_target_env env;
   std::memset(&env, 99, sizeof(env));
@@ -3023,6 +3023,54 @@ OpStore %output_pos %pos
                         "for variables with Input storage class"));
 }
 
+TEST_F(ValidateBuiltIns, TwoBuiltInsFailSameOnManyThreads) {
+  CodeGenerator generator = CodeGenerator::GetDefaultShaderCodeGenerator();
+
+  generator.before_types_ = R"(
+OpMemberDecorate %input_type 0 BuiltIn FragCoord
+OpMemberDecorate %output_type 0 BuiltIn FragCoord
+)";
+
+  generator.after_types_ = R"(
+%input_type = OpTypeStruct %f32vec4
+%input_ptr = OpTypePointer Input %input_type
+%input = OpVariable %input_ptr Input
+%input_f32vec4_ptr = OpTypePointer Input %f32vec4
+%output_type = OpTypeStruct %f32vec4
+%output_ptr = OpTypePointer Output %output_type
+%output = OpVariable %output_ptr Output
+%output_f32vec4_ptr = OpTypePointer Output %f32vec4
+)";
+
+  EntryPoint entry_point;
+  entry_point.name = "main";
+  entry_point.execution_model = "Geometry";
+  entry_point.interfaces = "%input %output";
+  entry_point.body = R"(
+%input_pos = OpAccessChain %input_f32vec4_ptr %input %u32_0
+%output_pos = OpAccessChain %output_f32vec4_ptr %output %u32_0
+%pos = OpLoad %f32vec4 %input_pos
+OpStore %output_pos %pos
+)";
+  generator.entry_points_.push_back(std::move(entry_point));
+  generator.entry_points_[0].execution_modes =
+      "OpExecutionMode %main InputPoints\nOpExecutionMode %main OutputPoints\n";
+
+  // Both built-ins are invalid.  The output is reported, as its pointer type
+  // comes before the function using the input, however many threads
+  // validate them.
+  CompileSuccessfully(generator.Build(), SPV_ENV_VULKAN_1_0);
+  spvValidatorOptionsSetNumThreads(getValidatorOptions(), 1);
+  ASSERT_EQ(SPV_ERROR_INVALID_DATA, ValidateInstructions(SPV_ENV_VULKAN_1_0));
+  const std::string serial = getDiagnosticString();
+  EXPECT_THAT(serial,
+              HasSubstr("Vulkan spec allows BuiltIn FragCoord to be only used "
+                        "for variables with Input storage class"));
+  spvValidatorOptionsSetNumThreads(getValidatorOptions(), 4);
+  ASSERT_EQ(SPV_ERROR_INVALID_DATA, ValidateInstructions(SPV_ENV_VULKAN_1_0));
+  EXPECT_EQ(serial, getDiagnosticString());
+}
+
 TEST_F(ValidateBuiltIns, VertexPositionVariableSuccess) {
   CodeGenerator generator = CodeGenerator::GetDefaultShaderCodeGenerator();
   generator.before_types_ = R"(
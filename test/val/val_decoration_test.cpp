@@ -3714,6 +3714,48 @@ TEST_F(ValidateDecorations, BlockUniformBufferLayoutIncorrectArrayStrideBad) {
           "an array with stride 49 not satisfying alignment to 16"));
 }
 
+TEST_F(ValidateDecorations, SharedStructLayoutDependsOnBlockRules) {
+  // The same struct is laid out under storage buffer rules first and then
+  // under uniform buffer rules, which need the array stride to be rounded up.
+  std::string spirv = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint GLCompute %main "main"
+               OpExecutionMode %main LocalSize 1 1 1
+               OpDecorate %_arr_float_uint_2 ArrayStride 4
+               OpMemberDecorate %S 0 Offset 0
+               OpMemberDecorate %SSBO 0 Offset 0
+               OpDecorate %SSBO BufferBlock
+               OpMemberDecorate %UBO 0 Offset 0
+               OpDecorate %UBO Block
+       %void = OpTypeVoid
+          %3 = OpTypeFunction %void
+      %float = OpTypeFloat 32
+       %uint = OpTypeInt 32 0
+     %uint_2 = OpConstant %uint 2
+%_arr_float_uint_2 = OpTypeArray %float %uint_2
+          %S = OpTypeStruct %_arr_float_uint_2
+       %SSBO = OpTypeStruct %S
+        %UBO = OpTypeStruct %S
+%_ptr_Uniform_SSBO = OpTypePointer Uniform %SSBO
+%_ptr_Uniform_UBO = OpTypePointer Uniform %UBO
+     %buffer = OpVariable %_ptr_Uniform_SSBO Uniform
+    %uniform = OpVariable %_ptr_Uniform_UBO Uniform
+       %main = OpFunction %void None %3
+          %5 = OpLabel
+               OpReturn
+               OpFunctionEnd
+  )";
+
+  CompileSuccessfully(spirv);
+  EXPECT_EQ(SPV_ERROR_INVALID_ID, ValidateAndRetrieveValidationState());
+  EXPECT_THAT(getDiagnosticString(),
+              HasSubstr("decorated as Block for variable in Uniform storage "
+                        "class must follow standard uniform buffer layout "
+                        "rules: member 0 contains an array with stride 4 not "
+                        "satisfying alignment to 16"));
+}
+
 TEST_F(ValidateDecorations,
        BufferBlockStandardStorageBufferLayoutImproperStraddleBad) {
   std::string spirv = R"(
@@ -0,0 +1,131 @@
+// Copyright (c) 2026 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tests that the checks of individual instructions agree with the predicates
+// that choose which opcodes they run on.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "source/opcode.h"
+#include "source/spirv_validator_options.h"
+#include "source/table.h"
+#include "source/val/instruction.h"
+#include "source/val/validate.h"
+#include "source/val/validation_state.h"
+
+namespace spvtools {
+namespace val {
+namespace {
+
+struct CheckCase {
+  const char* name;
+  spv_result_t (*check)(ValidationState_t&, const Instruction*);
+  bool (*applies_to)(const spv_opcode_desc_t&);
+};
+
+#define CHECK_CASE(check, applies_to) \
+  { #check, check, applies_to }
+
+const CheckCase kChecks[] = {
+    CHECK_CASE(MiscPass, MiscPassAppliesTo),
+    CHECK_CASE(DebugPass, DebugPassAppliesTo),
+    CHECK_CASE(AnnotationPass, AnnotationPassAppliesTo),
+    CHECK_CASE(ExtensionPass, ExtensionPassAppliesTo),
+    CHECK_CASE(ModeSettingPass, ModeSettingPassAppliesTo),
+    CHECK_CASE(TypePass, TypePassAppliesTo),
+    CHECK_CASE(ConstantPass, ConstantPassAppliesTo),
+    CHECK_CASE(MemoryPass, MemoryPassAppliesTo),
+    CHECK_CASE(FunctionPass, FunctionPassAppliesTo),
+    CHECK_CASE(ImagePass, ImagePassAppliesTo),
+    CHECK_CASE(ConversionPass, ConversionPassAppliesTo),
+    CHECK_CASE(CompositesPass, CompositesPassAppliesTo),
+    CHECK_CASE(ArithmeticsPass, ArithmeticsPassAppliesTo),
+    CHECK_CASE(BitwisePass, BitwisePassAppliesTo),
+    CHECK_CASE(LogicalsPass, LogicalsPassAppliesTo),
+    CHECK_CASE(ControlFlowPass, ControlFlowPassAppliesTo),
+    CHECK_CASE(DerivativesPass, DerivativesPassAppliesTo),
+    CHECK_CASE(AtomicsPass, AtomicsPassAppliesTo),
+    CHECK_CASE(PrimitivesPass, PrimitivesPassAppliesTo),
+    CHECK_CASE(BarriersPass, BarriersPassAppliesTo),
+    CHECK_CASE(NonUniformPass, NonUniformPassAppliesTo),
+    CHECK_CASE(LiteralsPass, LiteralsPassAppliesTo),
+    CHECK_CASE(ValidateExecutionLimitations,
+               ValidateExecutionLimitationsAppliesTo),
+    CHECK_CASE(ValidateSmallTypeUses, ValidateSmallTypeUsesAppliesTo),
+};
+
+#undef CHECK_CASE
+
+// This is all we need for these tests.
+uint32_t kFakeBinary[] = {0};
+
+// The validator only runs a check on the opcodes its predicate accepts, so on
+// any other opcode the check must do nothing.  Each check is run on an
+// instruction of every such opcode in the grammar, with zero operand words and
+// no parsed operands, and must succeed without a message.  A check that does
+// handle the opcode usually fails on such an instruction, or trips an
+// assertion.
+TEST(InstructionChecks, ChecksIgnoreOpcodesTheirPredicatesReject) {
+  spv_opcode_table grammar = nullptr;
+  ASSERT_EQ(SPV_SUCCESS, spvOpcodeTableGet(&grammar, SPV_ENV_UNIVERSAL_1_0));
+  spv_context context = spvContextCreate(SPV_ENV_UNIVERSAL_1_0);
+  std::vector<std::string> messages;
+  SetContextMessageConsumer(
+      context, [&messages](spv_message_level_t, const char*,
+                           const spv_position_t&, const char* message) {
+        messages.push_back(message);
+      });
+  spv_validator_options options = spvValidatorOptionsCreate();
+
+  for (const auto& check : kChecks) {
+    // An opcode may have several grammar entries, and the check runs on the
+    // opcode if its predicate accepts any of them.
+    std::vector<uint32_t> accepted;
+    for (uint32_t i = 0; i < grammar->count; ++i) {
+      if (check.applies_to(grammar->entries[i]))
+        accepted.push_back(grammar->entries[i].opcode);
+    }
+    for (uint32_t i = 0; i < grammar->count; ++i) {
+      const uint32_t opcode = grammar->entries[i].opcode;
+      if (std::find(accepted.begin(), accepted.end(), opcode) !=
+          accepted.end())
+        continue;
+      ValidationState_t state(context, options, kFakeBinary, 0, 1);
+      std::vector<uint32_t> words(8, 0);
+      words[0] = spvOpcodeMake(static_cast<uint16_t>(words.size()),
+                               static_cast<SpvOp>(opcode));
+      spv_parsed_instruction_t parsed = {};
+      parsed.words = words.data();
+      parsed.num_words = static_cast<uint16_t>(words.size());
+      parsed.opcode = static_cast<uint16_t>(opcode);
+      parsed.ext_inst_type = SPV_EXT_INST_TYPE_NONE;
+      const Instruction inst(&parsed);
+      messages.clear();
+      EXPECT_EQ(SPV_SUCCESS, check.check(state, &inst))
+          << check.name << " checks Op" << grammar->entries[i].name;
+      EXPECT_TRUE(messages.empty())
+          << check.name << " diagnoses Op" << grammar->entries[i].name;
+    }
+  }
+
+  spvValidatorOptionsDestroy(options);
+  spvContextDestroy(context);
+}
+
+}  // namespace
+}  // namespace val
+}  // namespace spvtools
@@ -1131,6 +1131,60 @@ TEST_F(ValidateSSA, IdDoesNotDominateItsUseBad) {
                    "  %false_block = OpLabel\n"));
 }
 
+std::string NestedSelections(const std::string& then_use,
+                             const std::string& else_use) {
+  return R"(
+     OpCapability Shader
+     OpCapability Linkage
+     OpMemoryModel Logical GLSL450
+     OpName %def "def"
+     OpName %then "then"
+     OpName %else "else"
+%voidt       = OpTypeVoid
+%funct       = OpTypeFunction %voidt
+%boolt       = OpTypeBool
+%uintt       = OpTypeInt 32 0
+%true        = OpConstantTrue %boolt
+%one         = OpConstant %uintt 1
+%func        = OpFunction %voidt None %funct
+%entry       = OpLabel
+               OpSelectionMerge %merge None
+               OpBranchConditional %true %then %else
+%then        = OpLabel
+%def         = OpIAdd %uintt %one %one
+               OpSelectionMerge %inner_merge None
+               OpBranchConditional %true %inner_then %inner_merge
+%inner_then  = OpLabel
+%then_use    = OpIAdd %uintt )" +
+         then_use + R"( %one
+               OpBranch %inner_merge
+%inner_merge = OpLabel
+               OpBranch %merge
+%else        = OpLabel
+%else_use    = OpIAdd %uintt )" +
+         else_use + R"( %one
+               OpBranch %merge
+%merge       = OpLabel
+               OpReturn
+               OpFunctionEnd
+)";
+}
+
+TEST_F(ValidateSSA, IdDominatesUseInNestedBlockGood) {
+  CompileSuccessfully(NestedSelections("%def", "%one"));
+  ASSERT_EQ(SPV_SUCCESS, ValidateInstructions());
+}
+
+TEST_F(ValidateSSA, IdDoesNotDominateUseInSiblingBlockBad) {
+  CompileSuccessfully(NestedSelections("%def", "%def"));
+  ASSERT_EQ(SPV_ERROR_INVALID_ID, ValidateInstructions());
+  EXPECT_THAT(
+      getDiagnosticString(),
+      MatchesRegex("ID .\\[%def\\] defined in block .\\[%then\\] "
+                   "does not dominate its use in block .\\[%else\\]\n"
+                   "  %else = OpLabel\n"));
+}
+
 TEST_F(ValidateSSA, PhiUseDoesntDominateDefinitionGood) {
   std::string str = kHeader + kBasicTypes +
                     R"(
@@ -167,6 +167,26 @@ TEST_F(ValidateTypeUnique, duplicate_vfunc) {
               HasSubstr(GetErrorString(SpvOpTypeFunction)));
 }
 
+TEST_F(ValidateTypeUnique, function_types_differing_in_length) {
+  std::string str = GetHeader() + R"(
+%ffunct = OpTypeFunction %voidt %floatt
+%fffunct = OpTypeFunction %voidt %floatt %floatt
+)" + GetBody();
+  CompileSuccessfully(str.c_str());
+  ASSERT_EQ(SPV_SUCCESS, ValidateInstructions());
+}
+
+TEST_F(ValidateTypeUnique, duplicate_function_type_with_params) {
+  std::string str = GetHeader() + R"(
+%fffunct = OpTypeFunction %voidt %floatt %floatt
+%fffunct2 = OpTypeFunction %voidt %floatt %floatt
+)" + GetBody();
+  CompileSuccessfully(str.c_str());
+  ASSERT_EQ(kDuplicateTypeError, ValidateInstructions());
+  EXPECT_THAT(getDiagnosticString(),
+              HasSubstr(GetErrorString(SpvOpTypeFunction)));
+}
+
 TEST_F(ValidateTypeUnique, duplicate_pipe_storage) {
   std::string str = R"(
 OpCapability Addresses
@@ -220,6 +240,25 @@ OpTypeForwardPointer %ptr2 Generic
   ASSERT_EQ(SPV_SUCCESS, ValidateInstructions());
 }
 
+TEST_F(ValidateTypeUnique, same_forward_pointer_twice) {
+  std::string str = R"(
+OpCapability Addresses
+OpCapability Kernel
+OpCapability GenericPointer
+OpCapability Linkage
+OpMemoryModel Physical32 OpenCL
+OpTypeForwardPointer %ptr Generic
+OpTypeForwardPointer %ptr Generic
+%intt = OpTypeInt 32 0
+%int_struct = OpTypeStruct %intt
+%ptr = OpTypePointer Generic %int_struct
+)";
+  CompileSuccessfully(str.c_str());
+  ASSERT_EQ(kDuplicateTypeError, ValidateInstructions());
+  EXPECT_THAT(getDiagnosticString(),
+              HasSubstr(GetErrorString(SpvOpTypeForwardPointer)));
+}
+
 TEST_F(ValidateTypeUnique, duplicate_void_with_extension) {
   std::string str = R"(
 OpCapability Addresses
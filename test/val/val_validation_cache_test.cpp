@@ -0,0 +1,229 @@
+// Copyright (c) 2026 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tests for the cache of validation outcomes.
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "source/spirv_validator_options.h"
+#include "source/val/validation_cache.h"
+#include "spirv-tools/libspirv.hpp"
+
+namespace spvtools {
+namespace val {
+namespace {
+
+using Outcome = spv_validator_cache_t::Outcome;
+
+const char kValidText[] =
+    "OpCapability Shader\n"
+    "OpCapability Linkage\n"
+    "OpMemoryModel Logical GLSL450\n";
+
+const char kInvalidText[] = "OpNop\n";
+
+std::vector<uint32_t> Assemble(const char* text) {
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_0);
+  std::vector<uint32_t> binary;
+  EXPECT_TRUE(tools.Assemble(text, &binary));
+  return binary;
+}
+
+Outcome MakeOutcome(spv_result_t result, const std::string& text) {
+  Outcome outcome;
+  outcome.result = result;
+  outcome.messages.push_back({SPV_MSG_ERROR, "source", {1, 2, 3}, text});
+  return outcome;
+}
+
+uint64_t KeyFor(spv_target_env env, const ValidatorOptions& options,
+                const std::vector<uint32_t>& binary) {
+  return spv_validator_cache_t::Key(env, options, binary.data(),
+                                    binary.size());
+}
+
+TEST(ValidationCache, KeyDependsOnWordsEnvironmentAndOptions) {
+  const std::vector<uint32_t> valid = Assemble(kValidText);
+  const std::vector<uint32_t> invalid = Assemble(kInvalidText);
+  ValidatorOptions options;
+  const uint64_t key = KeyFor(SPV_ENV_UNIVERSAL_1_0, options, valid);
+
+  EXPECT_EQ(key, KeyFor(SPV_ENV_UNIVERSAL_1_0, options, valid));
+  EXPECT_NE(key, KeyFor(SPV_ENV_UNIVERSAL_1_0, options, invalid));
+  EXPECT_NE(key, KeyFor(SPV_ENV_VULKAN_1_0, options, valid));
+
+  ValidatorOptions relaxed;
+  relaxed.SetRelaxBlockLayout(true);
+  EXPECT_NE(key, KeyFor(SPV_ENV_UNIVERSAL_1_0, relaxed, valid));
+
+  ValidatorOptions limited;
+  limited.SetUniversalLimit(spv_validator_limit_max_struct_members, 10);
+  EXPECT_NE(key, KeyFor(SPV_ENV_UNIVERSAL_1_0, limited, valid));
+
+  // Neither the number of threads nor the cache changes the outcome.
+  ValidatorCache cache(1);
+  ValidatorOptions threaded;
+  threaded.SetNumThreads(4);
+  threaded.SetCache(cache);
+  EXPECT_EQ(key, KeyFor(SPV_ENV_UNIVERSAL_1_0, threaded, valid));
+}
+
+TEST(ValidationCache, KeyDependsOnWordOrder) {
+  std::vector<uint32_t> words(40);
+  for (size_t i = 0; i < words.size(); ++i) words[i] = uint32_t(i);
+  ValidatorOptions options;
+  const uint64_t key = KeyFor(SPV_ENV_UNIVERSAL_1_0, options, words);
+
+  // Swap two whole eight-word stripes, then two words in the tail.
+  std::vector<uint32_t> stripes_swapped(words);
+  std::swap_ranges(stripes_swapped.begin(), stripes_swapped.begin() + 8,
+                   stripes_swapped.begin() + 8);
+  EXPECT_NE(key, KeyFor(SPV_ENV_UNIVERSAL_1_0, options, stripes_swapped));
+
+  std::vector<uint32_t> tail_swapped(words);
+  tail_swapped.push_back(100);
+  tail_swapped.push_back(200);
+  const uint64_t tail_key =
+      KeyFor(SPV_ENV_UNIVERSAL_1_0, options, tail_swapped);
+  std::swap(tail_swapped[40], tail_swapped[41]);
+  EXPECT_NE(tail_key, KeyFor(SPV_ENV_UNIVERSAL_1_0, options, tail_swapped));
+}
+
+TEST(ValidationCache, LookupFindsStoredOutcome) {
+  spv_validator_cache_t cache(2, nullptr);
+  Outcome outcome;
+  EXPECT_FALSE(cache.Lookup(1, &outcome));
+
+  cache.Store(1, MakeOutcome(SPV_ERROR_INVALID_ID, "bad id"));
+  ASSERT_TRUE(cache.Lookup(1, &outcome));
+  EXPECT_EQ(SPV_ERROR_INVALID_ID, outcome.result);
+  ASSERT_EQ(1u, outcome.messages.size());
+  EXPECT_EQ(SPV_MSG_ERROR, outcome.messages[0].level);
+  EXPECT_EQ("source", outcome.messages[0].source);
+  EXPECT_EQ(1u, outcome.messages[0].position.line);
+  EXPECT_EQ(2u, outcome.messages[0].position.column);
+  EXPECT_EQ(3u, outcome.messages[0].position.index);
+  EXPECT_EQ("bad id", outcome.messages[0].text);
+}
+
+TEST(ValidationCache, ForgetsLeastRecentlyUsedOutcome) {
+  spv_validator_cache_t cache(2, nullptr);
+  Outcome outcome;
+  cache.Store(1, MakeOutcome(SPV_SUCCESS, "one"));
+  cache.Store(2, MakeOutcome(SPV_SUCCESS, "two"));
+  // Using the first outcome makes the second the least recently used.
+  EXPECT_TRUE(cache.Lookup(1, &outcome));
+  cache.Store(3, MakeOutcome(SPV_SUCCESS, "three"));
+
+  EXPECT_TRUE(cache.Lookup(1, &outcome));
+  EXPECT_FALSE(cache.Lookup(2, &outcome));
+  EXPECT_TRUE(cache.Lookup(3, &outcome));
+}
+
+TEST(ValidationCache, ZeroCapacityKeepsNothingInMemory) {
+  spv_validator_cache_t cache(0, nullptr);
+  Outcome outcome;
+  cache.Store(1, MakeOutcome(SPV_SUCCESS, "one"));
+  EXPECT_FALSE(cache.Lookup(1, &outcome));
+}
+
+TEST(ValidationCache, CachesShareOutcomesThroughDirectory) {
+  const std::string directory = ::testing::TempDir();
+  // Use a key no other test stores, and clean up after any earlier run.
+  const uint64_t key = 0x5350564354455354ull;
+  char name[32];
+  snprintf(name, sizeof(name), "/%016llx.spvval",
+           static_cast<unsigned long long>(key));
+  const std::string path = directory + name;
+  std::remove(path.c_str());
+
+  spv_validator_cache_t writer(0, directory.c_str());
+  spv_validator_cache_t reader(0, directory.c_str());
+  Outcome outcome;
+  EXPECT_FALSE(reader.Lookup(key, &outcome));
+
+  writer.Store(key, MakeOutcome(SPV_ERROR_INVALID_CFG, "bad cfg"));
+  ASSERT_TRUE(reader.Lookup(key, &outcome));
+  EXPECT_EQ(SPV_ERROR_INVALID_CFG, outcome.result);
+  ASSERT_EQ(1u, outcome.messages.size());
+  EXPECT_EQ("source", outcome.messages[0].source);
+  EXPECT_EQ("bad cfg", outcome.messages[0].text);
+
+  std::remove(path.c_str());
+}
+
+TEST(ValidationCache, ValidationReplaysCachedMessages) {
+  const std::vector<uint32_t> invalid = Assemble(kInvalidText);
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_0);
+  std::vector<std::string> messages;
+  tools.SetMessageConsumer([&messages](spv_message_level_t, const char*,
+                                       const spv_position_t&,
+                                       const char* message) {
+    messages.push_back(message);
+  });
+
+  ValidatorCache cache(4);
+  ValidatorOptions options;
+  options.SetCache(cache);
+  EXPECT_FALSE(tools.Validate(invalid.data(), invalid.size(), options));
+  ASSERT_EQ(1u, messages.size());
+
+  Outcome outcome;
+  ASSERT_TRUE(static_cast<spv_validator_cache>(cache)->Lookup(
+      KeyFor(SPV_ENV_UNIVERSAL_1_0, options, invalid), &outcome));
+  EXPECT_EQ(SPV_ERROR_INVALID_LAYOUT, outcome.result);
+  ASSERT_EQ(1u, outcome.messages.size());
+  EXPECT_EQ(messages[0], outcome.messages[0].text);
+
+  EXPECT_FALSE(tools.Validate(invalid.data(), invalid.size(), options));
+  ASSERT_EQ(2u, messages.size());
+  EXPECT_EQ(messages[0], messages[1]);
+}
+
+TEST(ValidationCache, ValidationUsesStoredOutcome) {
+  // A cached outcome is trusted as it is, which shows that validation is
+  // skipped.
+  const std::vector<uint32_t> valid = Assemble(kValidText);
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_0);
+  std::vector<std::string> messages;
+  tools.SetMessageConsumer([&messages](spv_message_level_t, const char*,
+                                       const spv_position_t&,
+                                       const char* message) {
+    messages.push_back(message);
+  });
+
+  ValidatorCache cache(4);
+  ValidatorOptions options;
+  options.SetCache(cache);
+  static_cast<spv_validator_cache>(cache)->Store(
+      KeyFor(SPV_ENV_UNIVERSAL_1_0, options, valid),
+      MakeOutcome(SPV_ERROR_INVALID_DATA, "stored"));
+
+  EXPECT_FALSE(tools.Validate(valid.data(), valid.size(), options));
+  EXPECT_THAT(messages, ::testing::ElementsAre("stored"));
+
+  ValidatorOptions uncached;
+  messages.clear();
+  EXPECT_TRUE(tools.Validate(valid.data(), valid.size(), uncached));
+  EXPECT_TRUE(messages.empty());
+}
+
+}  // namespace
+}  // namespace val
+}  // namespace spvtools
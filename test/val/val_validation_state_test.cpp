@@ -14,6 +14,7 @@
 
 // Basic tests for the ValidationState_t datastructure.
 
+#include <functional>
 #include <string>
 
 #include "gmock/gmock.h"
@@ -356,6 +357,126 @@ OpEntryPoint Vertex %func_1 "main"
                 "in WebGPU env.\n  %1 = OpFunction %void None %3\n"));
 }
 
+// Returns a module of |num_functions| void functions, where the body of
+// function |i| is |body(i)|.  The body may use %int, %float, %int_1 and
+// %float_1.
+std::string ManyFunctions(int num_functions,
+                          const std::function<std::string(int)>& body) {
+  std::string spirv = std::string(kHeader) + R"(
+%void    = OpTypeVoid
+%void_f  = OpTypeFunction %void
+%int     = OpTypeInt 32 0
+%float   = OpTypeFloat 32
+%int_1   = OpConstant %int 1
+%float_1 = OpConstant %float 1
+)";
+  for (int i = 0; i < num_functions; ++i) {
+    const std::string n = std::to_string(i);
+    spirv += "%func_" + n + " = OpFunction %void None %void_f\n";
+    spirv += body(i);
+    spirv += "OpFunctionEnd\n";
+  }
+  return spirv;
+}
+
+// Validates the stored binary on one thread and then on several, and checks
+// that both runs report |expected| with the same diagnostic.
+void ExpectSameResultOnManyThreads(ValidationStateTest* test,
+                                   spv_result_t expected) {
+  spvValidatorOptionsSetNumThreads(test->getValidatorOptions(), 1);
+  EXPECT_EQ(expected, test->ValidateInstructions());
+  const std::string serial = test->getDiagnosticString();
+  spvValidatorOptionsSetNumThreads(test->getValidatorOptions(), 4);
+  EXPECT_EQ(expected, test->ValidateInstructions());
+  EXPECT_EQ(serial, test->getDiagnosticString());
+}
+
+TEST_F(ValidationStateTest, ManyThreadsAcceptValidFunctions) {
+  CompileSuccessfully(ManyFunctions(3000, [](int i) {
+    const std::string n = std::to_string(i);
+    return "%label_" + n + " = OpLabel\n%sum_" + n +
+           " = OpIAdd %int %int_1 %int_1\nOpReturn\n";
+  }));
+  ExpectSameResultOnManyThreads(this, SPV_SUCCESS);
+}
+
+TEST_F(ValidationStateTest, ManyThreadsReportFirstInstructionError) {
+  // Enough functions for the instruction checks to be split into several
+  // shards, with an error in two of the later ones.
+  CompileSuccessfully(ManyFunctions(3000, [](int i) {
+    const std::string n = std::to_string(i);
+    const bool bad = i == 1500 || i == 2500;
+    const std::string operand = bad ? "%float_1" : "%int_1";
+    return "%label_" + n + " = OpLabel\n%sum_" + n +
+           " = OpIAdd %int %int_1 " + operand + "\nOpReturn\n";
+  }));
+  ExpectSameResultOnManyThreads(this, SPV_ERROR_INVALID_DATA);
+  // Ids are numbered in order of appearance, so %sum_1500 is %4509.
+  EXPECT_THAT(getDiagnosticString(),
+              HasSubstr("%4509 = OpIAdd %uint %uint_1 %float_1"));
+}
+
+TEST_F(ValidationStateTest, ManyThreadsReportFirstCfgError) {
+  CompileSuccessfully(ManyFunctions(8, [](int i) {
+    const std::string n = std::to_string(i);
+    if (i != 3 && i != 6) return "%label_" + n + " = OpLabel\nOpReturn\n";
+    // The return block appears before the block that dominates it.  In
+    // function 3 that is block %16, dominated by %15.
+    return "%entry_" + n + " = OpLabel\nOpBranch %middle_" + n +
+           "\n%exit_" + n + " = OpLabel\nOpReturn\n%middle_" + n +
+           " = OpLabel\nOpBranch %exit_" + n + "\n";
+  }));
+  ExpectSameResultOnManyThreads(this, SPV_ERROR_INVALID_CFG);
+  EXPECT_THAT(getDiagnosticString(),
+              HasSubstr("Block 16[%16] appears in the binary before its "
+                        "dominator 15[%15]"));
+}
+
+TEST_F(ValidationStateTest, LowMemorySharesOperands) {
+  CompileSuccessfully(ManyFunctions(3, [](int i) {
+    const std::string n = std::to_string(i);
+    return "%label_" + n + " = OpLabel\n%sum_" + n +
+           " = OpIAdd %int %int_1 %int_1\nOpReturn\n";
+  }));
+  spvValidatorOptionsSetLowMemory(getValidatorOptions(), true);
+  EXPECT_EQ(SPV_SUCCESS, ValidateAndRetrieveValidationState());
+  // The memory estimate is only sent to a message consumer.
+  EXPECT_EQ(nullptr, diagnostic_);
+
+  // Each function adds %int_1, which is %5, to itself.
+  const Instruction* int_1 = vstate_->FindDef(5);
+  ASSERT_NE(nullptr, int_1);
+  EXPECT_EQ(6u, int_1->uses().size());
+
+  // The sums in the first two functions, %9 and %12, share their operands,
+  // and their words are those of the module.
+  const Instruction* first_sum = vstate_->FindDef(9);
+  const Instruction* second_sum = vstate_->FindDef(12);
+  ASSERT_NE(nullptr, first_sum);
+  ASSERT_NE(nullptr, second_sum);
+  ASSERT_EQ(SpvOpIAdd, first_sum->opcode());
+  ASSERT_EQ(SpvOpIAdd, second_sum->opcode());
+  EXPECT_EQ(first_sum->operands().data(), second_sum->operands().data());
+  const uint32_t* module = get_const_binary()->code;
+  const size_t num_words = get_const_binary()->wordCount;
+  EXPECT_GE(first_sum->words().data(), module);
+  EXPECT_LT(first_sum->words().data(), module + num_words);
+}
+
+TEST_F(ValidationStateTest, LowMemoryReportsSameError) {
+  CompileSuccessfully(ManyFunctions(3, [](int i) {
+    const std::string n = std::to_string(i);
+    const std::string operand = i == 1 ? "%float_1" : "%int_1";
+    return "%label_" + n + " = OpLabel\n%sum_" + n +
+           " = OpIAdd %int %int_1 " + operand + "\nOpReturn\n";
+  }));
+  EXPECT_EQ(SPV_ERROR_INVALID_DATA, ValidateInstructions());
+  const std::string expected = getDiagnosticString();
+  spvValidatorOptionsSetLowMemory(getValidatorOptions(), true);
+  EXPECT_EQ(SPV_ERROR_INVALID_DATA, ValidateInstructions());
+  EXPECT_EQ(expected, getDiagnosticString());
+}
+
 }  // namespace
 }  // namespace val
 }  // namespace spvtools
@@ -38,6 +38,8 @@ Options:
 
   -o <filename>   Set the output filename. Use '-' to mean stdout.
   --version       Display assembler version information.
+  --parallel      Encode function bodies on multiple threads. The binary
+                  is the same as without this option.
   --preserve-numeric-ids
                   Numeric IDs in the binary will have the same values as in the
                   source. Non-numeric IDs are allocated by filling in the gaps,
@@ -91,6 +93,8 @@ int main(int argc, char** argv) {
             return 0;
           } else if (0 == strcmp(argv[argi], "--preserve-numeric-ids")) {
             options |= SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS;
+          } else if (0 == strcmp(argv[argi], "--parallel")) {
+            options |= SPV_TEXT_TO_BINARY_OPTION_PARALLEL;
           } else if (0 == strcmp(argv[argi], "--target-env")) {
             if (argi + 1 < argc) {
               const auto env_str = argv[++argi];
@@ -58,6 +58,9 @@ Options:
   --offsets       Show byte offsets for each instruction.
 
   --comment       Add comments to make reading easier
+
+  --parallel      Disassemble function bodies on multiple threads.  The text
+                  is the same as without this option.
 )",
       argv0, argv0);
 }
@@ -82,6 +85,7 @@ int main(int argc, char** argv) {
   bool no_header = false;
   bool friendly_names = true;
   bool comments = false;
+  bool parallel = false;
 
   for (int argi = 1; argi < argc; ++argi) {
     if ('-' == argv[argi][0]) {
@@ -107,6 +111,8 @@ int main(int argc, char** argv) {
             force_color = true;
           } else if (0 == strcmp(argv[argi], "--comment")) {
             comments = true;
+          } else if (0 == strcmp(argv[argi], "--parallel")) {
+            parallel = true;
           } else if (0 == strcmp(argv[argi], "--no-indent")) {
             allow_indent = false;
           } else if (0 == strcmp(argv[argi], "--offsets")) {
@@ -163,6 +169,8 @@ int main(int argc, char** argv) {
 
   if (comments) options |= SPV_BINARY_TO_TEXT_OPTION_COMMENT;
 
+  if (parallel) options |= SPV_BINARY_TO_TEXT_OPTION_PARALLEL;
+
   if (!outFile || (0 == strcmp("-", outFile))) {
     // Print to standard output.
     options |= SPV_BINARY_TO_TEXT_OPTION_PRINT;
@@ -65,6 +65,11 @@ Options:
                                    members.
   --before-hlsl-legalization       Allows code patterns that are intended to be
                                    fixed by spirv-opt's legalization passes.
+  --num-threads                    <number of threads to check functions on,
+                                   or 0 for one per hardware thread>
+  --low-memory                     Keep the representation of the module
+                                   smaller, at some cost in speed, and
+                                   report a partial estimate of its memory.
   --version                        Display validator version information.
   --target-env                     {%s}
                                    Use validation rules from the specified environment.
@@ -139,6 +144,17 @@ int main(int argc, char** argv) {
           continue_processing = false;
           return_code = 1;
         }
+      } else if (0 == strcmp(cur_arg, "--num-threads")) {
+        uint32_t num_threads = 0;
+        if (argi + 1 < argc && sscanf(argv[++argi], "%u", &num_threads)) {
+          options.SetNumThreads(num_threads);
+        } else {
+          fprintf(stderr, "error: Missing argument to --num-threads\n");
+          continue_processing = false;
+          return_code = 1;
+        }
+      } else if (0 == strcmp(cur_arg, "--low-memory")) {
+        options.SetLowMemory(true);
       } else if (0 == strcmp(cur_arg, "--before-hlsl-legalization")) {
         options.SetBeforeHlslLegalization(true);
       } else if (0 == strcmp(cur_arg, "--relax-logical-pointer")) {
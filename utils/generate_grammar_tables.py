@@ -335,6 +335,23 @@ def generate_instruction(inst, is_ext_inst):
         return str(InstInitializer(opname, caps, exts, operands, min_version, max_version))
 
 
+def generate_name_index(name, entry_names):
+    """Returns the C definition of an array of indices into a table, ordered
+    by the names of the table entries.
+
+    The lookup-by-name functions binary search this array instead of scanning
+    the table.  Entries with the same name keep their table order, so the
+    first match found is the same one a linear scan would have found.
+
+    Arguments:
+      - name: the name of the array to define.
+      - entry_names: the names of the table entries, in table order.
+    """
+    order = sorted(range(len(entry_names)), key=lambda i: entry_names[i])
+    return 'static const uint16_t {}[] = {{\n  {}\n}};'.format(
+        name, ', '.join([str(i) for i in order]))
+
+
 def generate_instruction_table(inst_table):
     """Returns the info table containing all SPIR-V instructions, sorted by
     opcode, and prefixed by capability arrays.
@@ -356,8 +373,12 @@ def generate_instruction_table(inst_table):
     insts = [generate_instruction(inst, False) for inst in inst_table]
     insts = ['static const spv_opcode_desc_t kOpcodeTableEntries[] = {{\n'
              '  {}\n}};'.format(',\n  '.join(insts))]
+    # The table entries are named without the 'Op' prefix.
+    name_index = generate_name_index(
+        'kOpcodeTableNameIndex', [inst['opname'][2:] for inst in inst_table])
 
-    return '{}\n\n{}\n\n{}'.format(caps_arrays, exts_arrays, '\n'.join(insts))
+    return '{}\n\n{}\n\n{}\n\n{}'.format(caps_arrays, exts_arrays,
+                                         '\n'.join(insts), name_index)
 
 
 def generate_extended_instruction_table(json_grammar, set_name, operand_kind_prefix=""):
@@ -382,8 +403,11 @@ def generate_extended_instruction_table(json_grammar, set_name, operand_kind_pre
     insts = [generate_instruction(inst, True) for inst in inst_table]
     insts = ['static const spv_ext_inst_desc_t {}_entries[] = {{\n'
              '  {}\n}};'.format(set_name, ',\n  '.join(insts))]
+    name_index = generate_name_index(
+        '{}_name_index'.format(set_name),
+        [inst['opname'] for inst in inst_table])
 
-    return '{}\n\n{}'.format(caps_arrays, '\n'.join(insts))
+    return '{}\n\n{}\n\n{}'.format(caps_arrays, '\n'.join(insts), name_index)
 
 
 class EnumerantInitializer(object):
@@ -460,7 +484,8 @@ def generate_enum_operand_kind_entry(entry, extension_map):
 
 def generate_enum_operand_kind(enum, synthetic_exts_list):
     """Returns the C definition for the given operand kind.
-    It's a static const named array of spv_operand_desc_t.
+    It's a static const named array of spv_operand_desc_t, followed by
+    the index of that array ordered by enumerant name.
 
     Also appends to |synthetic_exts_list| a list of extension lists
     used.
@@ -495,16 +520,20 @@ def generate_enum_operand_kind(enum, synthetic_exts_list):
     synthetic_exts_list.extend(extension_map.values())
 
     name = '{}_{}Entries'.format(PYGEN_VARIABLE_PREFIX, kind)
+    index_name = '{}_{}NameIndex'.format(PYGEN_VARIABLE_PREFIX, kind)
+    name_index = generate_name_index(
+        index_name, [e.get('enumerant') for e in entries])
     entries = ['  {}'.format(generate_enum_operand_kind_entry(e, extension_map))
                for e in entries]
 
     template = ['static const spv_operand_desc_t {name}[] = {{',
-                '{entries}', '}};']
+                '{entries}', '}};', '', '{name_index}']
     entries = '\n'.join(template).format(
         name=name,
-        entries=',\n'.join(entries))
+        entries=',\n'.join(entries),
+        name_index=name_index)
 
-    return kind, name, entries
+    return kind, name, index_name, entries
 
 
 def generate_operand_kind_table(enums):
@@ -529,15 +558,15 @@ def generate_operand_kind_table(enums):
     three_optional_enums = [e for e in enums if e[0] in three_optional_enums]
     enums.extend(three_optional_enums)
 
-    enum_kinds, enum_names, enum_entries = zip(*enums)
+    enum_kinds, enum_names, enum_index_names, enum_entries = zip(*enums)
     # Mark the last three as optional ones.
     enum_quantifiers = [''] * (len(enums) - 3) + ['?'] * 3
     # And we don't want redefinition of them.
     enum_entries = enum_entries[:-3]
     enum_kinds = [convert_operand_kind(e)
                   for e in zip(enum_kinds, enum_quantifiers)]
-    table_entries = zip(enum_kinds, enum_names, enum_names)
-    table_entries = ['  {{{}, ARRAY_SIZE({}), {}}}'.format(*e)
+    table_entries = zip(enum_kinds, enum_names, enum_names, enum_index_names)
+    table_entries = ['  {{{}, ARRAY_SIZE({}), {}, {}}}'.format(*e)
                      for e in table_entries]
 
     template = [